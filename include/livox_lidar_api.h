@@ -46,7 +46,8 @@ void GetLivoxLidarSdkVer(LivoxLidarSdkVer *version);
 bool LivoxLidarSdkInit(const char* path, const char* host_ip = "", const LivoxLidarLoggerCfgInfo* log_cfg_info = nullptr);
 
 /**
- * Start the device scanning routine which runs on a separate thread.
+ * Start the device scanning routine which runs on a separate thread. With "rt_mode" set in the config
+ * file it also locks the process memory if "rt_mlockall" is set and arms the allocation tripwire.
  * @return true if successfully started, otherwise false.
  */
 bool LivoxLidarSdkStart();
@@ -56,6 +57,127 @@ bool LivoxLidarSdkStart();
  */
 void LivoxLidarSdkUninit();
 
+/**
+ * Create an sdk context with its own threads, sockets, callbacks and lidars, isolated from
+ * the default context of LivoxLidarSdkInit and from the other contexts. The arguments are
+ * those of LivoxLidarSdkInit. Contexts of one process must not share host ports.
+ *
+ * The functions taking a context apply to that context, NULL stands for the default context.
+ * The functions without one apply to the default context, except the lidar commands, which
+ * go to the context that discovered the lidar handle.
+ * @return the context, NULL on failure.
+ */
+LivoxLidarSdkContext* LivoxLidarSdkCreateContext(const char* path, const char* host_ip,
+                                                 const LivoxLidarLoggerCfgInfo* log_cfg_info);
+
+/**
+ * Uninitialize and free a context of LivoxLidarSdkCreateContext. Do not call it from a callback
+ * of that context, nor while another thread calls into it.
+ */
+void LivoxLidarSdkDestroyContext(LivoxLidarSdkContext* context);
+
+/** LivoxLidarSdkStart for context. */
+bool LivoxLidarSdkContextStart(LivoxLidarSdkContext* context);
+
+/** LivoxLidarSdkGetPollFd for context. */
+int LivoxLidarSdkContextGetPollFd(LivoxLidarSdkContext* context);
+
+/** LivoxLidarSdkPoll for context. */
+int LivoxLidarSdkContextPoll(LivoxLidarSdkContext* context, uint32_t max_events, int timeout_ms);
+
+/** LivoxLidarSdkGetPollTimeout for context. */
+int LivoxLidarSdkContextGetPollTimeout(LivoxLidarSdkContext* context);
+
+/** SetLivoxLidarPointCloudCallBack for context. */
+void LivoxLidarSdkContextSetPointCloudCallBack(LivoxLidarSdkContext* context, LivoxLidarPointCloudCallBack cb,
+                                               void* client_data);
+
+/** SetLivoxLidarPointCloudCallBackEx for context. */
+void LivoxLidarSdkContextSetPointCloudCallBackEx(LivoxLidarSdkContext* context, LivoxLidarPointCloudCallBackEx cb,
+                                                 void* client_data);
+
+/** SetLivoxLidarImuDataCallback for context. */
+void LivoxLidarSdkContextSetImuDataCallback(LivoxLidarSdkContext* context, LivoxLidarImuDataCallback cb,
+                                            void* client_data);
+
+/** SetLivoxLidarImuDataCallbackEx for context. */
+void LivoxLidarSdkContextSetImuDataCallbackEx(LivoxLidarSdkContext* context, LivoxLidarImuDataCallbackEx cb,
+                                              void* client_data);
+
+/** SetLivoxLidarInfoCallback for context. */
+void LivoxLidarSdkContextSetInfoCallback(LivoxLidarSdkContext* context, LivoxLidarInfoCallback cb, void* client_data);
+
+/** SetLivoxLidarInfoChangeCallback for context. */
+void LivoxLidarSdkContextSetInfoChangeCallback(LivoxLidarSdkContext* context, LivoxLidarInfoChangeCallback cb,
+                                               void* client_data);
+
+/** LivoxLidarAddCmdObserver for context. */
+void LivoxLidarSdkContextAddCmdObserver(LivoxLidarSdkContext* context, LivoxLidarCmdObserverCallBack cb,
+                                        void* client_data);
+
+/** LivoxLidarRemoveCmdObserver for context. */
+void LivoxLidarSdkContextRemoveCmdObserver(LivoxLidarSdkContext* context);
+
+/** LivoxLidarAddPointCloudObserver for context. */
+uint16_t LivoxLidarSdkContextAddPointCloudObserver(LivoxLidarSdkContext* context, LivoxLidarPointCloudObserver cb,
+                                                   void* client_data);
+
+/** LivoxLidarRemovePointCloudObserver for context. */
+void LivoxLidarSdkContextRemovePointCloudObserver(LivoxLidarSdkContext* context, uint16_t id);
+
+/** LivoxLidarAddAsyncPointCloudConsumer for context. */
+uint16_t LivoxLidarSdkContextAddAsyncPointCloudConsumer(LivoxLidarSdkContext* context, LivoxLidarPointCloudObserver cb,
+                                                        void* client_data, uint32_t ring_size,
+                                                        LivoxLidarDeliveryPolicy policy);
+
+/** LivoxLidarRemoveAsyncPointCloudConsumer for context. */
+void LivoxLidarSdkContextRemoveAsyncPointCloudConsumer(LivoxLidarSdkContext* context, uint16_t id);
+
+/** GetLivoxLidarAsyncConsumerStats for context. */
+bool LivoxLidarSdkContextGetAsyncConsumerStats(LivoxLidarSdkContext* context, uint16_t id,
+                                               LivoxLidarConsumerStats* stats);
+
+/** GetLivoxLidarDataSocketStats for context. */
+uint32_t LivoxLidarSdkContextGetDataSocketStats(LivoxLidarSdkContext* context, LivoxLidarSocketStats* stats,
+                                                uint32_t max_num);
+
+/** SetLivoxLidarUpgradeFirmwarePath for context. */
+bool LivoxLidarSdkContextSetUpgradeFirmwarePath(LivoxLidarSdkContext* context, const char* firmware_path);
+
+/** SetLivoxLidarUpgradeProgressCallback for context. */
+void LivoxLidarSdkContextSetUpgradeProgressCallback(LivoxLidarSdkContext* context,
+                                                    OnLivoxLidarUpgradeProgressCallback cb, void* client_data);
+
+/**
+ * With "embedded_mode" set in the config file the sdk starts no io thread, the application runs its
+ * io through LivoxLidarSdkPoll and the callbacks are called on the polling thread.
+ * @return a descriptor readable when LivoxLidarSdkPoll has events to handle, -1 if the sdk is not in
+ * embedded mode or the platform has none, LivoxLidarSdkPoll then has to be called with a timeout.
+ */
+int LivoxLidarSdkGetPollFd();
+
+/**
+ * Run the io of an embedded mode sdk, always from the same thread, and stop it before uninitializing.
+ * @param max_events  stop waiting for more events once this many are handled.
+ * @param timeout_ms  wait up to timeout_ms for the first event, 0 does not block, -1 waits until one.
+ * @return the number of events handled, -1 if the sdk is not in embedded mode.
+ */
+int LivoxLidarSdkPoll(uint32_t max_events, int timeout_ms);
+
+/**
+ * @return the milliseconds within which LivoxLidarSdkPoll should be called even if its descriptor is
+ * not readable, so that the sdk timers run. -1 if the sdk is not in embedded mode.
+ */
+int LivoxLidarSdkGetPollTimeout();
+
+/**
+ * Test hook of rt mode. With "rt_alloc_tripwire" set in the config file and the sdk built with the
+ * LIVOX_RT_ALLOC_TRIPWIRE cmake option, the heap allocations made on the data path after "rt_warmup_ms"
+ * are counted, callbacks included.
+ * @return the allocations counted in the process, always 0 without the tripwire.
+ */
+uint64_t LivoxLidarSdkGetRtAllocationCount();
+
 /**
  * Set the callback to receive point cloud data.
  * @param handle                 device handle.
@@ -63,6 +185,14 @@ void LivoxLidarSdkUninit();
  */
 void SetLivoxLidarPointCloudCallBack(LivoxLidarPointCloudCallBack cb, void* client_data);
 
+/**
+ * Set the callback to receive point cloud data together with the kernel receive timestamp.
+ * It is invoked in addition to the callback set by SetLivoxLidarPointCloudCallBack.
+ * @param cb                     callback to receive point cloud data.
+ * @param client_data            user data associated with the command.
+ */
+void SetLivoxLidarPointCloudCallBackEx(LivoxLidarPointCloudCallBackEx cb, void* client_data);
+
 /**
  * Add the lidar command data observer.
  * @param handle                 device handle.
@@ -95,6 +225,51 @@ void LivoxLidarRemovePointCloudObserver(uint16_t id);
  */
 void SetLivoxLidarImuDataCallback(LivoxLidarImuDataCallback cb, void* client_data);
 
+/**
+ * Set the callback to receive IMU data together with the kernel receive timestamp.
+ * It is invoked in addition to the callback set by SetLivoxLidarImuDataCallback.
+ * @param cb                     callback to receive IMU data.
+ * @param client_data            user data associated with the command.
+ */
+void SetLivoxLidarImuDataCallbackEx(LivoxLidarImuDataCallbackEx cb, void* client_data);
+
+/**
+ * Get the receive statistics of the point cloud, imu and debug point cloud sockets.
+ * Kernel drops are counted on Linux only.
+ * @param stats                  array receiving the statistics.
+ * @param max_num                capacity of stats.
+ * @return the number of entries filled.
+ */
+uint32_t GetLivoxLidarDataSocketStats(LivoxLidarSocketStats* stats, uint32_t max_num);
+
+/**
+ * Add a point cloud observer served by a worker thread of its own, a slow callback never holds up the
+ * data io threads. Every data io thread copies the point cloud and imu packets into a ring of the consumer,
+ * all the rings are allocated by this call.
+ * @param cb                     callback receiving the packets on the worker thread.
+ * @param client_data            user data passed to cb.
+ * @param ring_size              packets queued per data io thread, rounded up to a power of two.
+ * @param policy                 what to do with a packet arriving while the ring is full.
+ * @return the consumer id, 0 on failure.
+ */
+uint16_t LivoxLidarAddAsyncPointCloudConsumer(LivoxLidarPointCloudObserver cb, void* client_data, uint32_t ring_size,
+                                              LivoxLidarDeliveryPolicy policy);
+
+/**
+ * Remove an asynchronous consumer and join its worker, the packets still queued are dropped.
+ * Do not call it from the callback of the consumer.
+ * @param id                     the consumer id.
+ */
+void LivoxLidarRemoveAsyncPointCloudConsumer(uint16_t id);
+
+/**
+ * Get the delivery statistics of an asynchronous consumer.
+ * @param id                     the consumer id.
+ * @param stats                  receives the statistics.
+ * @return false if id is not a consumer.
+ */
+bool GetLivoxLidarAsyncConsumerStats(uint16_t id, LivoxLidarConsumerStats* stats);
+
 /**
  * Set the callback to receive Status Info.
  * @param cb                     callback to receive Status Info.
@@ -568,6 +743,12 @@ bool SetLivoxLidarUpgradeFirmwarePath(const char* firmware_path);
 
 void SetLivoxLidarUpgradeProgressCallback(OnLivoxLidarUpgradeProgressCallback cb, void* client_data);
 
+/**
+ * Upgrade the lidars with the firmware and progress callback of the context that discovered them.
+ * The lidars of one call must belong to the same context, otherwise nothing is upgraded.
+ * @param handle                 handles of the lidars.
+ * @param lidar_num              number of handles.
+ */
 void UpgradeLivoxLidars(const uint32_t* handle, const uint8_t lidar_num);
 
 #ifdef __cplusplus
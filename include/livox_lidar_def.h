@@ -575,6 +575,48 @@ typedef struct {
 
 #pragma pack()
 
+/**
+ * Handle of an sdk context created by LivoxLidarSdkCreateContext.
+ */
+typedef struct LivoxLidarSdkContext LivoxLidarSdkContext;
+
+/**
+ * Receive statistics of a point cloud, imu or debug point cloud socket.
+ */
+typedef struct {
+  uint16_t host_port;         /**< local port the socket is bound to. */
+  uint32_t lidar_handle;      /**< lidar a connected socket receives from, 0 for a socket shared by lidars. */
+  uint32_t recv_buffer_size;  /**< receive buffer granted by the kernel in bytes. */
+  uint32_t kernel_drops;      /**< datagrams the kernel dropped because the receive buffer was full. */
+} LivoxLidarSocketStats;
+
+/**
+ * What an asynchronous point cloud consumer does with a packet arriving while its ring is full.
+ */
+typedef enum {
+  kLivoxLidarDeliveryDropNewest = 0,  /**< drop the arriving packet. */
+  kLivoxLidarDeliveryDropOldest = 1,  /**< drop the oldest queued packet to make room. */
+  kLivoxLidarDeliveryBlock = 2        /**< wait for room, the data io thread stalls with the consumer. */
+} LivoxLidarDeliveryPolicy;
+
+/**
+ * Delivery statistics of an asynchronous point cloud consumer.
+ */
+typedef struct {
+  uint64_t delivered;         /**< packets passed to the callback. */
+  uint64_t dropped;           /**< packets dropped by the overflow policy, too large for a ring slot or from
+                                   a data thread left without a ring. */
+  uint32_t queued;            /**< packets waiting in the rings. */
+} LivoxLidarConsumerStats;
+
+/**
+ * Host side timing of a received data packet, both in ns since epoch (CLOCK_REALTIME).
+ */
+typedef struct {
+  uint64_t kernel_rx_ns;      /**< time the kernel received the packet, 0 if the socket has no timestamp. */
+  uint64_t dispatch_ns;       /**< time the sdk started delivering the packet to the callbacks. */
+} LivoxLidarRxInfo;
+
 /**
  * Callback function for receiving point cloud data.
  * @param handle                 device handle.
@@ -584,6 +626,16 @@ typedef struct {
  */
 typedef void (*LivoxLidarPointCloudCallBack)(const uint32_t handle, const uint8_t dev_type, LivoxLidarEthernetPacket* data, void* client_data);
 
+/**
+ * Callback function for receiving point cloud data with the host receive timing.
+ * @param handle                 device handle.
+ * @param data                   device's data.
+ * @param rx_info                kernel receive and sdk dispatch time of the packet.
+ * @param client_data            user data associated with the command.
+ */
+typedef void (*LivoxLidarPointCloudCallBackEx)(const uint32_t handle, const uint8_t dev_type, LivoxLidarEthernetPacket* data,
+                                               const LivoxLidarRxInfo* rx_info, void* client_data);
+
 /**
  * Callback function for receiving point cloud data.
  * @param handle                 device handle.
@@ -609,6 +661,15 @@ typedef void (*LivoxLidarPointCloudObserver) (uint32_t handle, const uint8_t dev
  */
 typedef void (*LivoxLidarImuDataCallback)(const uint32_t handle, const uint8_t dev_type, LivoxLidarEthernetPacket* data, void* client_data);
 
+/**
+ * Callback function for receiving IMU data with the host receive timing.
+ * @param data                   device's data.
+ * @param rx_info                kernel receive and sdk dispatch time of the packet.
+ * @param client_data            user data associated with the command.
+ */
+typedef void (*LivoxLidarImuDataCallbackEx)(const uint32_t handle, const uint8_t dev_type, LivoxLidarEthernetPacket* data,
+                                            const LivoxLidarRxInfo* rx_info, void* client_data);
+
 /**
  * Callback function for receiving Status Info.
  * @param status_info            status info.
@@ -0,0 +1,205 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2022 Livox. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+// Loopback check of the asynchronous point cloud consumer: a fake lidar on 127.0.0.2 sends point cloud
+// packets to the sdk, a consumer spends 200 us on each of them. The point cloud callback on the data io
+// thread must still get every packet at the send rate, the consumer gets what its ring holds and counts
+// the rest as dropped.
+
+#include "livox_lidar_def.h"
+#include "livox_lidar_api.h"
+
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+namespace {
+
+const char* kConfigPath = "async_consumer_test.json";
+// Apart from the host ip, whose own datagrams the sdk ignores.
+const char* kLidarIp = "127.0.0.2";
+// Ports of the command, push, point, imu and log streams are 100 apart, those of a Mid360 are fixed.
+const uint16_t kLidarPort = 56100;
+const uint16_t kHostPort = 57101;
+const uint32_t kPacketSize = 1380;
+const int kConsumerCostUs = 200;
+const uint32_t kRingSize = 64;
+
+std::atomic<int> direct_packets(0);
+std::atomic<int64_t> last_direct_ns(0);
+
+int64_t NowNs() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+bool WriteConfig() {
+  FILE* file = fopen(kConfigPath, "w");
+  if (file == nullptr) {
+    return false;
+  }
+  fprintf(file,
+      "{\n"
+      "  \"MID360\": {\n"
+      "    \"lidar_net_info\": { \"cmd_data_port\": %u, \"push_msg_port\": %u, \"point_data_port\": %u,\n"
+      "                        \"imu_data_port\": %u, \"log_data_port\": %u },\n"
+      "    \"host_net_info\": [ { \"lidar_ip\": [\"%s\"], \"host_ip\": \"127.0.0.1\", \"multicast_ip\": \"\",\n"
+      "                         \"cmd_data_port\": %u, \"push_msg_port\": %u, \"point_data_port\": %u,\n"
+      "                         \"imu_data_port\": %u, \"log_data_port\": %u } ]\n"
+      "  }\n"
+      "}\n",
+      kLidarPort, kLidarPort + 100, kLidarPort + 200, kLidarPort + 300, kLidarPort + 400, kLidarIp,
+      kHostPort, kHostPort + 100, kHostPort + 200, kHostPort + 300, kHostPort + 400);
+  fclose(file);
+  return true;
+}
+
+void PointCloudCallback(const uint32_t handle, const uint8_t dev_type, LivoxLidarEthernetPacket* data,
+                        void* client_data) {
+  direct_packets.fetch_add(1, std::memory_order_relaxed);
+  last_direct_ns.store(NowNs(), std::memory_order_relaxed);
+}
+
+void SlowConsumer(const uint32_t handle, const uint8_t dev_type, LivoxLidarEthernetPacket* data, void* client_data) {
+  std::this_thread::sleep_for(std::chrono::microseconds(kConsumerCostUs));
+}
+
+} // namespace
+
+int main(int argc, const char *argv[]) {
+  int packet_num = 2000;
+  if (argc > 1) {
+    packet_num = atoi(argv[1]);
+  }
+  if (packet_num <= 0) {
+    packet_num = 1;
+  }
+  if (!WriteConfig() || !LivoxLidarSdkInit(kConfigPath)) {
+    printf("Livox sdk init failed\n");
+    return -1;
+  }
+  SetLivoxLidarPointCloudCallBack(PointCloudCallback, nullptr);
+  uint16_t consumer_id = LivoxLidarAddAsyncPointCloudConsumer(SlowConsumer, nullptr, kRingSize,
+                                                              kLivoxLidarDeliveryDropNewest);
+  // Overruns too, the worker copies packets out while the producer takes the oldest back.
+  uint16_t oldest_id = LivoxLidarAddAsyncPointCloudConsumer(SlowConsumer, nullptr, kRingSize,
+                                                            kLivoxLidarDeliveryDropOldest);
+  if (consumer_id == 0 || oldest_id == 0 || !LivoxLidarSdkStart()) {
+    printf("Add the async consumers failed\n");
+    LivoxLidarSdkUninit();
+    return -1;
+  }
+
+  // The fake lidar sends from its point data port, the sdk routes by source address.
+  int sock = socket(AF_INET, SOCK_DGRAM, 0);
+  struct sockaddr_in addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = inet_addr(kLidarIp);
+  addr.sin_port = htons(kLidarPort + 200);
+  struct sockaddr_in dst = addr;
+  dst.sin_addr.s_addr = inet_addr("127.0.0.1");
+  dst.sin_port = htons(kHostPort + 200);
+  if (sock < 0 || bind(sock, (struct sockaddr*)&addr, sizeof(addr)) != 0) {
+    printf("Bind the lidar socket failed\n");
+    LivoxLidarSdkUninit();
+    return -1;
+  }
+
+  std::vector<uint8_t> buf(kPacketSize, 0);
+  LivoxLidarEthernetPacket* packet = reinterpret_cast<LivoxLidarEthernetPacket*>(buf.data());
+  packet->length = kPacketSize;
+  packet->dot_num = 96;
+  packet->data_type = kLivoxLidarCartesianCoordinateHighData;
+  int64_t start_ns = NowNs();
+  for (int i = 0; i < packet_num; ++i) {
+    packet->udp_cnt = static_cast<uint16_t>(i);
+    sendto(sock, buf.data(), buf.size(), 0, (struct sockaddr*)&dst, sizeof(dst));
+    // Bursts of 32 per millisecond stay within any receive buffer.
+    if (i % 32 == 31) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+  }
+  int64_t sent_ns = NowNs();
+
+  LivoxLidarConsumerStats stats;
+  LivoxLidarConsumerStats oldest_stats;
+  memset(&stats, 0, sizeof(stats));
+  memset(&oldest_stats, 0, sizeof(oldest_stats));
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  while (std::chrono::steady_clock::now() < deadline) {
+    GetLivoxLidarAsyncConsumerStats(consumer_id, &stats);
+    GetLivoxLidarAsyncConsumerStats(oldest_id, &oldest_stats);
+    if (direct_packets.load() == packet_num && stats.delivered + stats.dropped == (uint64_t)packet_num &&
+        oldest_stats.delivered + oldest_stats.dropped == (uint64_t)packet_num) {
+      break;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  int direct = direct_packets.load();
+  double send_ms = (sent_ns - start_ns) / 1e6;
+  double direct_ms = (last_direct_ns.load() - start_ns) / 1e6;
+  printf("%d packets sent in %.1f ms, callback got %d by %.1f ms, consumer of %d us delivered %lu, dropped %lu, "
+         "queued %u\n", packet_num, send_ms, direct, direct_ms, kConsumerCostUs, (unsigned long)stats.delivered,
+         (unsigned long)stats.dropped, stats.queued);
+  printf("drop oldest consumer delivered %lu, dropped %lu, queued %u\n", (unsigned long)oldest_stats.delivered,
+         (unsigned long)oldest_stats.dropped, oldest_stats.queued);
+
+  close(sock);
+  LivoxLidarRemoveAsyncPointCloudConsumer(consumer_id);
+  LivoxLidarRemoveAsyncPointCloudConsumer(oldest_id);
+  LivoxLidarSdkUninit();
+  remove(kConfigPath);
+
+  bool result = true;
+  if (direct != packet_num) {
+    printf("The point cloud callback missed packets\n");
+    result = false;
+  }
+  // Called in line by the data io thread, the consumer alone would hold it up for packet_num * 200 us.
+  if (direct_ms >= send_ms + packet_num * kConsumerCostUs / 1000.0 / 2) {
+    printf("The data io thread was held up by the consumer\n");
+    result = false;
+  }
+  if (stats.delivered + stats.dropped != (uint64_t)packet_num || stats.dropped == 0) {
+    printf("The consumer accounted for %lu of %d packets, %lu dropped\n",
+           (unsigned long)(stats.delivered + stats.dropped), packet_num, (unsigned long)stats.dropped);
+    result = false;
+  }
+  if (oldest_stats.delivered + oldest_stats.dropped != (uint64_t)packet_num || oldest_stats.dropped == 0) {
+    printf("The drop oldest consumer accounted for %lu of %d packets, %lu dropped\n",
+           (unsigned long)(oldest_stats.delivered + oldest_stats.dropped), packet_num,
+           (unsigned long)oldest_stats.dropped);
+    result = false;
+  }
+  return result ? 0 : -1;
+}
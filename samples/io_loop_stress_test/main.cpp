@@ -0,0 +1,313 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2022 Livox. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+// Stress test of the poll set: 512 loopback sockets on one io loop each get a datagram, and every
+// delegate must see it. Then sockets remove their partner from within the dispatch of the same wait,
+// and the removed ones must never be called back. Runs with every backend the sdk is built with.
+// With epoll, an edge triggered socket must also not be drained twice in one iteration.
+
+#include "base/io_loop.h"
+#include "base/network/network_util.h"
+
+#include <unistd.h>
+#include <arpa/inet.h>
+
+#include <stdio.h>
+#include <chrono>
+#include <vector>
+
+using namespace livox::lidar;
+
+namespace {
+
+const int kSocketNum = 512;
+
+struct TestSocket {
+  socket_t sock;
+  struct sockaddr_in addr;
+  int events;
+};
+
+bool CreateSockets(std::vector<TestSocket>& sockets) {
+  sockets.resize(kSocketNum);
+  for (TestSocket& item : sockets) {
+    item.sock = util::CreateSocket(0, true, false, false, "127.0.0.1", "", false, 64 * 1024);
+    if (item.sock < 0) {
+      printf("Create socket failed\n");
+      return false;
+    }
+    socklen_t len = sizeof(item.addr);
+    getsockname(item.sock, (struct sockaddr*)&item.addr, &len);
+    item.events = 0;
+  }
+  return true;
+}
+
+void CloseSockets(std::vector<TestSocket>& sockets) {
+  for (TestSocket& item : sockets) {
+    util::CloseSock(item.sock);
+  }
+  sockets.clear();
+}
+
+bool SendToAll(socket_t send_sock, const std::vector<TestSocket>& sockets) {
+  uint8_t payload[64] = {0};
+  for (const TestSocket& item : sockets) {
+    if (sendto(send_sock, payload, sizeof(payload), 0, (const struct sockaddr*)&item.addr, sizeof(item.addr)) < 0) {
+      printf("sendto failed\n");
+      return false;
+    }
+  }
+  return true;
+}
+
+void DrainSocket(socket_t sock) {
+  uint8_t buf[128];
+  while (recv(sock, buf, sizeof(buf), MSG_DONTWAIT) > 0) {
+  }
+}
+
+class CountingDelegate : public IOLoop::IOLoopDelegate {
+ public:
+  void OnData(socket_t sock, void* data) override {
+    DrainSocket(sock);
+    ++static_cast<TestSocket*>(data)->events;
+  }
+};
+
+int CountSeen(const std::vector<TestSocket>& sockets) {
+  int seen = 0;
+  for (const TestSocket& item : sockets) {
+    seen += item.events > 0 ? 1 : 0;
+  }
+  return seen;
+}
+
+// Every delegate of kSocketNum sockets added to one loop fires for its datagram.
+bool TestDelegates(MultipleIOType io_type, socket_t send_sock) {
+  IOLoop loop(false, false, io_type);
+  if (!loop.Init()) {
+    printf("Init io loop failed\n");
+    return false;
+  }
+  std::vector<TestSocket> sockets;
+  if (!CreateSockets(sockets)) {
+    return false;
+  }
+  CountingDelegate delegate;
+  for (TestSocket& item : sockets) {
+    loop.AddDelegate(item.sock, &delegate, &item);
+  }
+  // Runs the posted registrations.
+  loop.Loop(0);
+
+  bool result = SendToAll(send_sock, sockets);
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+  while (result && CountSeen(sockets) < kSocketNum && std::chrono::steady_clock::now() < deadline) {
+    loop.Loop(10);
+  }
+  int seen = CountSeen(sockets);
+  if (seen != kSocketNum) {
+    printf("io type %d: %d of %d delegates got their datagram\n", io_type, seen, kSocketNum);
+    result = false;
+  }
+
+  for (TestSocket& item : sockets) {
+    loop.RemoveDelegate(item.sock, &delegate);
+  }
+  loop.Loop(0);
+  loop.Uninit();
+  CloseSockets(sockets);
+  return result;
+}
+
+// Sockets are paired, the first of a pair dispatched removes the other one while the events of the
+// same wait are still being dispatched. The removed sockets keep their datagram, so a stale event or a
+// leftover registration would call them back.
+bool TestRemoveDuringDispatch(MultipleIOType io_type, socket_t send_sock) {
+  std::unique_ptr<MultipleIOBase> multiple_io = MultipleIOFactory::CreateMultipleIO(io_type);
+  if (!multiple_io || !multiple_io->PollCreate(POLL_SIZE_HINT)) {
+    printf("Create multiple io failed\n");
+    return false;
+  }
+  std::vector<TestSocket> sockets;
+  if (!CreateSockets(sockets)) {
+    return false;
+  }
+  std::vector<bool> removed(kSocketNum, false);
+  MultipleIOBase* io = multiple_io.get();
+  for (int i = 0; i < kSocketNum; ++i) {
+    PollFd poll_fd = {};
+    poll_fd.fd = sockets[i].sock;
+    poll_fd.event = READBLE_EVENT;
+    poll_fd.event_callback = [&sockets, &removed, io, i](FdEvent) {
+      TestSocket& item = sockets[i];
+      ++item.events;
+      DrainSocket(item.sock);
+      int partner = i ^ 1;
+      if (!removed[i] && !removed[partner]) {
+        PollFd remove_fd = {};
+        remove_fd.fd = sockets[partner].sock;
+        io->PollSetRemove(remove_fd);
+        removed[partner] = true;
+      }
+    };
+    if (!io->PollSetAdd(poll_fd)) {
+      printf("io type %d: add socket %d failed\n", io_type, i);
+      return false;
+    }
+  }
+
+  bool result = SendToAll(send_sock, sockets);
+  // Give loopback time to queue every datagram so that one wait returns all of them.
+  usleep(20 * 1000);
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+  int pairs_done = 0;
+  while (result && pairs_done < kSocketNum / 2 && std::chrono::steady_clock::now() < deadline) {
+    io->Poll(10);
+    pairs_done = 0;
+    for (int i = 0; i < kSocketNum; i += 2) {
+      pairs_done += (sockets[i].events + sockets[i + 1].events) > 0 ? 1 : 0;
+    }
+  }
+  // A few more waits, the removed sockets still hold data.
+  for (int i = 0; i < 5; ++i) {
+    io->Poll(10);
+  }
+
+  for (int i = 0; i < kSocketNum; i += 2) {
+    int events = sockets[i].events + sockets[i + 1].events;
+    if (events != 1) {
+      printf("io type %d: pair %d got %d events, expected 1\n", io_type, i / 2, events);
+      result = false;
+      break;
+    }
+    int kept = sockets[i].events > 0 ? i : i + 1;
+    if (removed[kept]) {
+      printf("io type %d: removed socket %d was called back\n", io_type, kept);
+      result = false;
+      break;
+    }
+  }
+
+  for (int i = 0; i < kSocketNum; ++i) {
+    if (!removed[i]) {
+      PollFd remove_fd = {};
+      remove_fd.fd = sockets[i].sock;
+      io->PollSetRemove(remove_fd);
+    }
+  }
+  io->Poll(0);
+  io->PollDestroy();
+  CloseSockets(sockets);
+  return result;
+}
+
+#ifdef HAVE_EPOLL
+// An edge triggered socket left in the backlog by its drain budget and hit by a fresh edge in the same
+// wait is drained once per iteration, not once for the backlog and once for the event.
+bool TestDrainOncePerIteration(socket_t send_sock) {
+  MultipleIOEpoll epoll;
+  if (!epoll.PollCreate(POLL_SIZE_HINT)) {
+    printf("Create epoll failed\n");
+    return false;
+  }
+  std::vector<TestSocket> sockets;
+  if (!CreateSockets(sockets)) {
+    return false;
+  }
+  TestSocket& item = sockets[0];
+  PollFd poll_fd = {};
+  poll_fd.fd = item.sock;
+  poll_fd.event = READBLE_EVENT;
+  poll_fd.event_callback = [](FdEvent) {};
+  // A budget of one datagram per drain, true while the socket may hold more.
+  poll_fd.drain_callback = [&item]() {
+    uint8_t buf[128];
+    if (recv(item.sock, buf, sizeof(buf), MSG_DONTWAIT) <= 0) {
+      return false;
+    }
+    ++item.events;
+    return true;
+  };
+  epoll.PollSetAdd(poll_fd);
+
+  std::vector<TestSocket> target(1, item);
+  bool result = true;
+  for (int i = 0; i < 4 && result; ++i) {
+    result = SendToAll(send_sock, target);
+  }
+  usleep(20 * 1000);
+  // First edge, one drain, the socket goes to the backlog.
+  epoll.Poll(100);
+  // A fresh edge while backlogged.
+  result = result && SendToAll(send_sock, target);
+  usleep(20 * 1000);
+  int before = item.events;
+  epoll.Poll(100);
+  int drained = item.events - before;
+  if (drained != 1) {
+    printf("epoll: a backlogged socket with a fresh edge was drained %d times in one iteration\n", drained);
+    result = false;
+  }
+
+  PollFd remove_fd = {};
+  remove_fd.fd = item.sock;
+  epoll.PollSetRemove(remove_fd);
+  epoll.PollDestroy();
+  CloseSockets(sockets);
+  return result;
+}
+#endif  // HAVE_EPOLL
+
+} // namespace
+
+int main(int argc, const char *argv[]) {
+  socket_t send_sock = util::CreateSocket(0, true, false, false, "127.0.0.1");
+  if (send_sock < 0) {
+    printf("Create send socket failed\n");
+    return -1;
+  }
+
+  std::vector<MultipleIOType> io_types = {kMultipleIODefault};
+#ifdef HAVE_IO_URING
+  io_types.push_back(kMultipleIOUring);
+#endif
+
+  bool result = true;
+  for (MultipleIOType io_type : io_types) {
+    bool delegates = TestDelegates(io_type, send_sock);
+    bool remove = TestRemoveDuringDispatch(io_type, send_sock);
+    printf("io type %d: %d sockets delegates %s, remove during dispatch %s\n", io_type, kSocketNum,
+           delegates ? "ok" : "FAILED", remove ? "ok" : "FAILED");
+    result = result && delegates && remove;
+  }
+#ifdef HAVE_EPOLL
+  bool drain_once = TestDrainOncePerIteration(send_sock);
+  printf("epoll: drain once per iteration %s\n", drain_once ? "ok" : "FAILED");
+  result = result && drain_once;
+#endif
+  util::CloseSock(send_sock);
+  return result ? 0 : -1;
+}
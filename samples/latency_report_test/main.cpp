@@ -0,0 +1,181 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2022 Livox. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+// Loopback check of data_latency_report: a fake lidar on 127.0.0.2 sends point cloud packets to the sdk
+// for a little longer than the report interval, once with the blocking data io loop and once with
+// data_busy_poll_spin_us. Each run must stamp the packets with their kernel receive time and log the rx to
+// callback latency report under the label of its mode.
+
+#include "livox_lidar_def.h"
+#include "livox_lidar_api.h"
+#include "spdlog/spdlog.h"
+#include "spdlog/sinks/ostream_sink.h"
+#include "spdlog/sinks/stdout_color_sinks.h"
+
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+
+#include <stdio.h>
+#include <string.h>
+#include <atomic>
+#include <chrono>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+const char* kConfigPath = "latency_report_test.json";
+// Apart from the host ip, whose own datagrams the sdk ignores.
+const char* kLidarIp = "127.0.0.2";
+// Ports of the command, push, point, imu and log streams are 100 apart, those of a Mid360 are fixed.
+const uint16_t kLidarPort = 56100;
+const uint16_t kHostPort = 57121;
+const uint32_t kPacketSize = 1380;
+// The sdk reports every 5 s, from the first packet received after the interval.
+const int kSendMs = 5500;
+
+typedef struct {
+  const char* label;
+  uint32_t busy_poll_spin_us;
+} Mode;
+
+std::atomic<int> packets(0);
+std::atomic<int> stamped_packets(0);
+
+bool WriteConfig(uint32_t busy_poll_spin_us) {
+  FILE* file = fopen(kConfigPath, "w");
+  if (file == nullptr) {
+    return false;
+  }
+  fprintf(file,
+      "{\n"
+      "  \"data_latency_report\": true,\n"
+      "  \"data_busy_poll_spin_us\": %u,\n"
+      "  \"MID360\": {\n"
+      "    \"lidar_net_info\": { \"cmd_data_port\": %u, \"push_msg_port\": %u, \"point_data_port\": %u,\n"
+      "                        \"imu_data_port\": %u, \"log_data_port\": %u },\n"
+      "    \"host_net_info\": [ { \"lidar_ip\": [\"%s\"], \"host_ip\": \"127.0.0.1\", \"multicast_ip\": \"\",\n"
+      "                         \"cmd_data_port\": %u, \"push_msg_port\": %u, \"point_data_port\": %u,\n"
+      "                         \"imu_data_port\": %u, \"log_data_port\": %u } ]\n"
+      "  }\n"
+      "}\n",
+      busy_poll_spin_us, kLidarPort, kLidarPort + 100, kLidarPort + 200, kLidarPort + 300, kLidarPort + 400,
+      kLidarIp, kHostPort, kHostPort + 100, kHostPort + 200, kHostPort + 300, kHostPort + 400);
+  fclose(file);
+  return true;
+}
+
+void PointCloudCallbackEx(const uint32_t handle, const uint8_t dev_type, LivoxLidarEthernetPacket* data,
+                          const LivoxLidarRxInfo* rx_info, void* client_data) {
+  packets.fetch_add(1, std::memory_order_relaxed);
+  if (rx_info != nullptr && rx_info->kernel_rx_ns != 0 && rx_info->dispatch_ns >= rx_info->kernel_rx_ns) {
+    stamped_packets.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+/** Run the sdk in mode while a fake lidar sends, the log lines of the run are appended to log. */
+bool RunMode(const Mode& mode, std::ostringstream& log) {
+  packets.store(0);
+  stamped_packets.store(0);
+  // The sdk logs through the console logger when one is registered, this one also keeps the lines.
+  std::vector<spdlog::sink_ptr> sinks;
+  sinks.push_back(std::make_shared<spdlog::sinks::stdout_color_sink_mt>());
+  sinks.push_back(std::make_shared<spdlog::sinks::ostream_sink_mt>(log));
+  std::shared_ptr<spdlog::logger> logger = std::make_shared<spdlog::logger>("console", sinks.begin(), sinks.end());
+  logger->set_level(spdlog::level::debug);
+  spdlog::register_logger(logger);
+
+  if (!WriteConfig(mode.busy_poll_spin_us) || !LivoxLidarSdkInit(kConfigPath)) {
+    printf("Livox sdk init failed\n");
+    spdlog::drop_all();
+    return false;
+  }
+  SetLivoxLidarPointCloudCallBackEx(PointCloudCallbackEx, nullptr);
+  if (!LivoxLidarSdkStart()) {
+    printf("Livox sdk start failed\n");
+    LivoxLidarSdkUninit();
+    return false;
+  }
+
+  // The fake lidar sends from its point data port, the sdk routes by source address.
+  int sock = socket(AF_INET, SOCK_DGRAM, 0);
+  struct sockaddr_in addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = inet_addr(kLidarIp);
+  addr.sin_port = htons(kLidarPort + 200);
+  struct sockaddr_in dst = addr;
+  dst.sin_addr.s_addr = inet_addr("127.0.0.1");
+  dst.sin_port = htons(kHostPort + 200);
+  if (sock < 0 || bind(sock, (struct sockaddr*)&addr, sizeof(addr)) != 0) {
+    printf("Bind the lidar socket failed\n");
+    if (sock >= 0) {
+      close(sock);
+    }
+    LivoxLidarSdkUninit();
+    return false;
+  }
+
+  std::vector<uint8_t> buf(kPacketSize, 0);
+  LivoxLidarEthernetPacket* packet = reinterpret_cast<LivoxLidarEthernetPacket*>(buf.data());
+  packet->length = kPacketSize;
+  packet->dot_num = 96;
+  packet->data_type = kLivoxLidarCartesianCoordinateHighData;
+  int sent = 0;
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(kSendMs);
+  while (std::chrono::steady_clock::now() < deadline) {
+    packet->udp_cnt = static_cast<uint16_t>(sent);
+    sendto(sock, buf.data(), buf.size(), 0, (struct sockaddr*)&dst, sizeof(dst));
+    ++sent;
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  close(sock);
+  LivoxLidarSdkUninit();
+  remove(kConfigPath);
+
+  std::string report = std::string("Rx to callback latency, mode:") + mode.label + ",";
+  bool reported = log.str().find(report) != std::string::npos;
+  printf("mode %s: %d packets sent, callback got %d, %d with a kernel rx time, latency report %s\n", mode.label,
+         sent, packets.load(), stamped_packets.load(), reported ? "logged" : "MISSING");
+  return packets.load() > 0 && stamped_packets.load() > 0 && reported;
+}
+
+} // namespace
+
+int main(int argc, const char *argv[]) {
+  const Mode modes[] = { { "blocking", 0 }, { "busy poll", 50 } };
+  bool result = true;
+  for (const Mode& mode : modes) {
+    std::ostringstream log;
+    if (!RunMode(mode, log)) {
+      printf("The latency report of mode %s failed\n", mode.label);
+      result = false;
+    }
+  }
+  return result ? 0 : -1;
+}
@@ -0,0 +1,201 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2022 Livox. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+// Microbenchmark of IOLoop::PostTask with many producers, against the mutex protected task
+// vector with a wake up on every post that IOLoop used before the lock free queue.
+// Throughput: N producers post tasks as fast as they can to one running loop.
+// Round trip: one producer posts a task and waits for it to run, so every post finds the loop
+// parked. The loop waits up to one second, a lost wake up shows as a round trip that long.
+
+#include "base/io_loop.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace livox::lidar;
+using std::chrono::steady_clock;
+
+namespace {
+
+const int kLoopTimeoutMs = 1000;
+
+/** The task queue of IOLoop before it went lock free, on the same multiple io. */
+class MutexTaskLoop {
+ public:
+  bool Init() {
+    multiple_io_ = MultipleIOFactory::CreateMultipleIO();
+    return multiple_io_ && multiple_io_->PollCreate(POLL_SIZE_HINT);
+  }
+  void Uninit() { multiple_io_->PollDestroy(); }
+  void PostTask(const IOLoop::IOLoopTask& task) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      pending_tasks_.push_back(task);
+    }
+    multiple_io_->PollWakeUp();
+  }
+  void Loop(int timeout) {
+    multiple_io_->Poll(timeout);
+    std::vector<IOLoop::IOLoopTask> tasks;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      tasks.swap(pending_tasks_);
+    }
+    for (auto& task : tasks) {
+      task();
+    }
+  }
+
+ private:
+  std::unique_ptr<MultipleIOBase> multiple_io_;
+  std::mutex mutex_;
+  std::vector<IOLoop::IOLoopTask> pending_tasks_;
+};
+
+/** The loop under test, run by a thread of its own until Stop. */
+template <typename Loop>
+class LoopRunner {
+ public:
+  explicit LoopRunner(Loop& loop) : loop_(loop), quit_(false) {
+    thread_ = std::thread([this]() {
+      while (!quit_.load(std::memory_order_acquire)) {
+        loop_.Loop(kLoopTimeoutMs);
+      }
+    });
+  }
+  void Stop() {
+    loop_.PostTask([this]() { quit_.store(true, std::memory_order_release); });
+    thread_.join();
+  }
+
+ private:
+  Loop& loop_;
+  std::atomic<bool> quit_;
+  std::thread thread_;
+};
+
+/** Tasks per second run by the loop for producer_num threads posting tasks_per_producer each. */
+template <typename Loop>
+double Throughput(Loop& loop, int producer_num, int tasks_per_producer) {
+  std::atomic<int64_t> executed(0);
+  const int64_t total = static_cast<int64_t>(producer_num) * tasks_per_producer;
+  LoopRunner<Loop> runner(loop);
+  steady_clock::time_point start = steady_clock::now();
+  std::vector<std::thread> producers;
+  for (int i = 0; i < producer_num; ++i) {
+    producers.emplace_back([&loop, &executed, tasks_per_producer]() {
+      for (int j = 0; j < tasks_per_producer; ++j) {
+        loop.PostTask([&executed]() { executed.fetch_add(1, std::memory_order_relaxed); });
+      }
+    });
+  }
+  for (auto& producer : producers) {
+    producer.join();
+  }
+  while (executed.load(std::memory_order_relaxed) < total) {
+    std::this_thread::yield();
+  }
+  double seconds = std::chrono::duration<double>(steady_clock::now() - start).count();
+  runner.Stop();
+  return total / seconds;
+}
+
+/** Average and worst post to run delay in us over round_num posts to a parked loop. */
+template <typename Loop>
+void RoundTrip(Loop& loop, int round_num, double& average_us, double& max_us) {
+  LoopRunner<Loop> runner(loop);
+  std::atomic<bool> done(false);
+  double sum_us = 0;
+  max_us = 0;
+  for (int i = 0; i < round_num; ++i) {
+    // Let the loop park in its wait before posting.
+    std::this_thread::sleep_for(std::chrono::microseconds(50));
+    done.store(false, std::memory_order_relaxed);
+    steady_clock::time_point start = steady_clock::now();
+    loop.PostTask([&done]() { done.store(true, std::memory_order_release); });
+    while (!done.load(std::memory_order_acquire)) {
+      std::this_thread::yield();
+    }
+    double us = std::chrono::duration<double, std::micro>(steady_clock::now() - start).count();
+    sum_us += us;
+    max_us = us > max_us ? us : max_us;
+  }
+  runner.Stop();
+  average_us = sum_us / round_num;
+}
+
+} // namespace
+
+int main(int argc, const char *argv[]) {
+  int tasks_per_producer = 200000;
+  if (argc > 1) {
+    tasks_per_producer = atoi(argv[1]);
+  }
+  if (tasks_per_producer <= 0) {
+    tasks_per_producer = 1;
+  }
+  int round_num = tasks_per_producer / 100 > 100 ? tasks_per_producer / 100 : 100;
+
+  IOLoop lock_free_loop(false, false);
+  MutexTaskLoop mutex_loop;
+  if (!lock_free_loop.Init() || !mutex_loop.Init()) {
+    printf("Init loops failed\n");
+    return -1;
+  }
+
+  printf("%d tasks per producer, %u hardware threads\n", tasks_per_producer, std::thread::hardware_concurrency());
+  const int producer_nums[] = {1, 2, 4, 8};
+  for (int producer_num : producer_nums) {
+    double lock_free = Throughput(lock_free_loop, producer_num, tasks_per_producer);
+    double mutex = Throughput(mutex_loop, producer_num, tasks_per_producer);
+    printf("%d producers: lock free %.2fM tasks/s, mutex %.2fM tasks/s\n", producer_num, lock_free / 1e6,
+           mutex / 1e6);
+  }
+
+  double lock_free_average = 0;
+  double lock_free_max = 0;
+  double mutex_average = 0;
+  double mutex_max = 0;
+  RoundTrip(lock_free_loop, round_num, lock_free_average, lock_free_max);
+  RoundTrip(mutex_loop, round_num, mutex_average, mutex_max);
+  printf("round trip to a parked loop over %d posts: lock free %.1f us average, %.1f us max, "
+         "mutex %.1f us average, %.1f us max\n", round_num, lock_free_average, lock_free_max, mutex_average,
+         mutex_max);
+
+  lock_free_loop.Uninit();
+  mutex_loop.Uninit();
+
+  // Half the loop timeout, only a missed wake up takes that long.
+  if (lock_free_max >= kLoopTimeoutMs * 1000 / 2) {
+    printf("A post to a parked loop was not woken up\n");
+    return -1;
+  }
+  return 0;
+}
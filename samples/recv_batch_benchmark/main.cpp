@@ -0,0 +1,137 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2022 Livox. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+// Loopback benchmark of util::RecvBatchFrom: the receive calls made per datagram when a data
+// socket is drained with a batch of 1 and of 32, as DeviceManager does on point/IMU ports.
+
+#include "base/network/network_util.h"
+
+#include <unistd.h>
+#include <arpa/inet.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <vector>
+
+using namespace livox::lidar;
+
+namespace {
+
+// Size of a point cloud datagram of 96 high precision points.
+const size_t kDatagramSize = 1380;
+// Datagrams queued before every drain, well below the receive buffer.
+const int kBurstSize = 64;
+
+struct BenchResult {
+  uint64_t calls;
+  uint64_t datagrams;
+  double ns_per_datagram;
+};
+
+bool RunBench(util::socket_t recv_sock, util::socket_t send_sock, const struct sockaddr_in& dst,
+              int batch_size, int total, BenchResult& result) {
+  std::vector<uint8_t> payload(kDatagramSize, 0xa5);
+  std::vector<std::vector<uint8_t>> bufs(batch_size, std::vector<uint8_t>(kDatagramSize));
+  std::vector<util::RecvMsg> msgs(batch_size);
+  for (int i = 0; i < batch_size; ++i) {
+    msgs[i].buf = bufs[i].data();
+    msgs[i].buf_size = bufs[i].size();
+  }
+
+  result.calls = 0;
+  result.datagrams = 0;
+  std::chrono::nanoseconds recv_time(0);
+  for (int sent = 0; sent < total; sent += kBurstSize) {
+    for (int i = 0; i < kBurstSize; ++i) {
+      if (sendto(send_sock, payload.data(), payload.size(), 0, (const struct sockaddr*)&dst, sizeof(dst)) < 0) {
+        printf("sendto failed\n");
+        return false;
+      }
+    }
+    // Drain until the socket reports empty, the final empty call is part of the cost.
+    auto start = std::chrono::steady_clock::now();
+    uint64_t burst_received = 0;
+    while (true) {
+      int ret = util::RecvBatchFrom(recv_sock, msgs.data(), batch_size);
+      ++result.calls;
+      if (ret == 0) {
+        break;
+      }
+      burst_received += ret;
+    }
+    recv_time += std::chrono::steady_clock::now() - start;
+    if (burst_received != kBurstSize) {
+      printf("batch %d: received %lu of %d datagrams\n", batch_size, (unsigned long)burst_received, kBurstSize);
+      return false;
+    }
+    result.datagrams += burst_received;
+  }
+  result.ns_per_datagram = static_cast<double>(recv_time.count()) / result.datagrams;
+  return true;
+}
+
+} // namespace
+
+int main(int argc, const char *argv[]) {
+  int total = 100000;
+  if (argc > 1) {
+    total = atoi(argv[1]);
+  }
+  if (total < kBurstSize) {
+    total = kBurstSize;
+  }
+
+  util::socket_t recv_sock = util::CreateSocket(0, true, false, false, "127.0.0.1");
+  util::socket_t send_sock = util::CreateSocket(0, true, false, false, "127.0.0.1");
+  if (recv_sock < 0 || send_sock < 0) {
+    printf("Create loopback sockets failed\n");
+    return -1;
+  }
+  struct sockaddr_in dst;
+  socklen_t len = sizeof(dst);
+  getsockname(recv_sock, (struct sockaddr*)&dst, &len);
+
+  const int batch_sizes[] = {1, 32};
+  BenchResult results[2];
+  for (int i = 0; i < 2; ++i) {
+    if (!RunBench(recv_sock, send_sock, dst, batch_sizes[i], total, results[i])) {
+      return -1;
+    }
+    printf("batch %2d: %lu datagrams, %lu receive calls, %.3f calls/datagram, %.0f ns/datagram\n",
+        batch_sizes[i], (unsigned long)results[i].datagrams, (unsigned long)results[i].calls,
+        static_cast<double>(results[i].calls) / results[i].datagrams, results[i].ns_per_datagram);
+  }
+
+  util::CloseSock(recv_sock);
+  util::CloseSock(send_sock);
+
+  // A batch of 32 drains a burst of 64 in 3 calls instead of 65.
+  if (results[1].calls * 4 > results[0].calls) {
+    printf("Batched receive made too many calls\n");
+    return -1;
+  }
+  return 0;
+}
@@ -0,0 +1,199 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2022 Livox. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+// Allocation check of the rt mode data path, linked with the sdk built with the allocation tripwire. A
+// fake lidar on 127.0.0.2 sends point cloud and imu packets from before the sdk arms the tripwire until
+// well after, through the point cloud and imu callbacks and an asynchronous consumer. Any heap allocation
+// of the data path once armed fails the test.
+
+#include "livox_lidar_def.h"
+#include "livox_lidar_api.h"
+
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+namespace {
+
+const char* kConfigPath = "rt_alloc_tripwire_test.json";
+// Apart from the host ip, whose own datagrams the sdk ignores.
+const char* kLidarIp = "127.0.0.2";
+// Ports of the command, push, point, imu and log streams are 100 apart, those of a Mid360 are fixed.
+const uint16_t kLidarPort = 56100;
+const uint16_t kHostPort = 57111;
+const uint32_t kWarmupMs = 200;
+const uint32_t kPointPacketSize = 1380;
+const uint32_t kImuPacketSize = 60;
+
+std::atomic<int> point_packets(0);
+std::atomic<int> imu_packets(0);
+std::atomic<int> consumer_packets(0);
+
+bool WriteConfig() {
+  FILE* file = fopen(kConfigPath, "w");
+  if (file == nullptr) {
+    return false;
+  }
+  fprintf(file,
+      "{\n"
+      "  \"rt_mode\": true,\n"
+      "  \"rt_warmup_ms\": %u,\n"
+      "  \"rt_alloc_tripwire\": \"count\",\n"
+      "  \"MID360\": {\n"
+      "    \"lidar_net_info\": { \"cmd_data_port\": %u, \"push_msg_port\": %u, \"point_data_port\": %u,\n"
+      "                        \"imu_data_port\": %u, \"log_data_port\": %u },\n"
+      "    \"host_net_info\": [ { \"lidar_ip\": [\"%s\"], \"host_ip\": \"127.0.0.1\", \"multicast_ip\": \"\",\n"
+      "                         \"cmd_data_port\": %u, \"push_msg_port\": %u, \"point_data_port\": %u,\n"
+      "                         \"imu_data_port\": %u, \"log_data_port\": %u } ]\n"
+      "  }\n"
+      "}\n",
+      kWarmupMs, kLidarPort, kLidarPort + 100, kLidarPort + 200, kLidarPort + 300, kLidarPort + 400, kLidarIp,
+      kHostPort, kHostPort + 100, kHostPort + 200, kHostPort + 300, kHostPort + 400);
+  fclose(file);
+  return true;
+}
+
+void PointCloudCallback(const uint32_t handle, const uint8_t dev_type, LivoxLidarEthernetPacket* data,
+                        void* client_data) {
+  point_packets.fetch_add(1, std::memory_order_relaxed);
+}
+
+void ImuDataCallback(const uint32_t handle, const uint8_t dev_type, LivoxLidarEthernetPacket* data,
+                     void* client_data) {
+  imu_packets.fetch_add(1, std::memory_order_relaxed);
+}
+
+void Consumer(const uint32_t handle, const uint8_t dev_type, LivoxLidarEthernetPacket* data, void* client_data) {
+  consumer_packets.fetch_add(1, std::memory_order_relaxed);
+}
+
+/** A socket of the fake lidar bound to its port, -1 on failure. */
+int CreateLidarSocket(uint16_t port) {
+  int sock = socket(AF_INET, SOCK_DGRAM, 0);
+  struct sockaddr_in addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = inet_addr(kLidarIp);
+  addr.sin_port = htons(port);
+  if (sock >= 0 && bind(sock, (struct sockaddr*)&addr, sizeof(addr)) != 0) {
+    close(sock);
+    return -1;
+  }
+  return sock;
+}
+
+bool SendTo(int sock, uint16_t host_port, const std::vector<uint8_t>& buf) {
+  struct sockaddr_in dst;
+  memset(&dst, 0, sizeof(dst));
+  dst.sin_family = AF_INET;
+  dst.sin_addr.s_addr = inet_addr("127.0.0.1");
+  dst.sin_port = htons(host_port);
+  return sendto(sock, buf.data(), buf.size(), 0, (struct sockaddr*)&dst, sizeof(dst)) ==
+         static_cast<ssize_t>(buf.size());
+}
+
+} // namespace
+
+int main(int argc, const char *argv[]) {
+  uint32_t run_ms = kWarmupMs + 500;
+  if (argc > 1 && atoi(argv[1]) > 0) {
+    run_ms = kWarmupMs + atoi(argv[1]);
+  }
+  if (!WriteConfig() || !LivoxLidarSdkInit(kConfigPath)) {
+    printf("Livox sdk init failed\n");
+    return -1;
+  }
+  SetLivoxLidarPointCloudCallBack(PointCloudCallback, nullptr);
+  SetLivoxLidarImuDataCallback(ImuDataCallback, nullptr);
+  uint16_t consumer_id = LivoxLidarAddAsyncPointCloudConsumer(Consumer, nullptr, 1024,
+                                                              kLivoxLidarDeliveryDropOldest);
+  int point_sock = CreateLidarSocket(kLidarPort + 200);
+  int imu_sock = CreateLidarSocket(kLidarPort + 300);
+  if (consumer_id == 0 || point_sock < 0 || imu_sock < 0 || !LivoxLidarSdkStart()) {
+    printf("Set up the sdk or the lidar sockets failed\n");
+    LivoxLidarSdkUninit();
+    return -1;
+  }
+
+  std::vector<uint8_t> point_buf(kPointPacketSize, 0);
+  LivoxLidarEthernetPacket* point_packet = reinterpret_cast<LivoxLidarEthernetPacket*>(point_buf.data());
+  point_packet->length = kPointPacketSize;
+  point_packet->dot_num = 96;
+  point_packet->data_type = kLivoxLidarCartesianCoordinateHighData;
+  std::vector<uint8_t> imu_buf(kImuPacketSize, 0);
+  LivoxLidarEthernetPacket* imu_packet = reinterpret_cast<LivoxLidarEthernetPacket*>(imu_buf.data());
+  imu_packet->length = kImuPacketSize;
+  imu_packet->dot_num = 1;
+  imu_packet->data_type = kLivoxLidarImuData;
+
+  // Both streams run through the arming of the tripwire and on past it.
+  auto start = std::chrono::steady_clock::now();
+  auto armed = start + std::chrono::milliseconds(kWarmupMs + 50);
+  auto end = start + std::chrono::milliseconds(run_ms);
+  int armed_point_packets = -1;
+  int armed_imu_packets = -1;
+  bool sent = true;
+  for (uint16_t i = 0; sent && std::chrono::steady_clock::now() < end; ++i) {
+    if (armed_point_packets < 0 && std::chrono::steady_clock::now() >= armed) {
+      armed_point_packets = point_packets.load();
+      armed_imu_packets = imu_packets.load();
+    }
+    point_packet->udp_cnt = i;
+    imu_packet->udp_cnt = i;
+    sent = SendTo(point_sock, kHostPort + 200, point_buf) && SendTo(imu_sock, kHostPort + 300, imu_buf);
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  // Let the io threads finish the last packets.
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  uint64_t allocations = LivoxLidarSdkGetRtAllocationCount();
+  int armed_points = point_packets.load() - armed_point_packets;
+  int armed_imus = imu_packets.load() - armed_imu_packets;
+  printf("point packets %d, imu packets %d, consumer packets %d, %d point and %d imu packets once armed, "
+         "%lu data path allocations\n", point_packets.load(), imu_packets.load(), consumer_packets.load(),
+         armed_points, armed_imus, (unsigned long)allocations);
+
+  close(point_sock);
+  close(imu_sock);
+  LivoxLidarRemoveAsyncPointCloudConsumer(consumer_id);
+  LivoxLidarSdkUninit();
+  remove(kConfigPath);
+
+  if (!sent || armed_point_packets < 0 || armed_points <= 0 || armed_imus <= 0) {
+    printf("No data reached the sdk once the tripwire was armed\n");
+    return -1;
+  }
+  if (allocations != 0) {
+    printf("The data path allocated %lu times in rt mode\n", (unsigned long)allocations);
+    return -1;
+  }
+  return 0;
+}
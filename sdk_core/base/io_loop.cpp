@@ -24,27 +24,35 @@
 
 #include "io_loop.h"
 #include <functional>
-#include <mutex>
 #include <iostream>
 #include <algorithm>
 #include "logging.h"
 
-using std::lock_guard;
-using std::mutex;
-using std::vector;
 using std::chrono::steady_clock;
 
 namespace livox {
 namespace lidar {
 
 bool IOLoop::Init() {
+  if (enable_timer_) {
+    timer_wheel_.reset(new TimerWheel());
+  }
+  if (io_type_ != kMultipleIODefault) {
+    auto multiple_io = MultipleIOFactory::CreateMultipleIO(io_type_);
+    if (multiple_io && multiple_io->PollCreate(POLL_SIZE_HINT)) {
+      multiple_io_base_ = std::move(multiple_io);
+      return true;
+    }
+    LOG_WARN("Multiple IO type {} is unavailable, use the default one.", static_cast<int>(io_type_));
+  }
+
   auto multiple_io = MultipleIOFactory::CreateMultipleIO();
   if (!multiple_io) {
     LOG_ERROR("Creat Multiple IO Failed!");
     return false;
   }
   multiple_io_base_ = std::move(multiple_io);
-  if (!multiple_io_base_->PollCreate(OPEN_MAX_POLL)) {
+  if (!multiple_io_base_->PollCreate(POLL_SIZE_HINT)) {
     LOG_ERROR("Poll Create Failed!");
     return false;
   }
@@ -55,26 +63,84 @@ void IOLoop::Uninit() {
   multiple_io_base_->PollDestroy();
 }
 
-void IOLoop::AddDelegate(socket_t sock, IOLoop::IOLoopDelegate *delegate, void *data) {
-  PostTask(std::bind(&IOLoop::AddDelegateAsync, this, sock, delegate, data));
+void IOLoop::AddDelegate(socket_t sock, IOLoop::IOLoopDelegate *delegate, void *data, bool direct_recv) {
+  PostTask(std::bind(&IOLoop::AddDelegateAsync, this, sock, delegate, data, direct_recv));
 }
 
 void IOLoop::RemoveDelegate(socket_t sock, IOLoopDelegate *) {
   PostTask(std::bind(&IOLoop::RemoveDelegateAsync, this, sock));
 }
 
-void IOLoop::Loop() {
-  multiple_io_base_->Poll(POLL_TIMEOUT);
+int IOLoop::Loop(int timeout) {
+  // Spin while data keeps arriving, sleep in the blocking wait once the spin window expires.
+  if (busy_poll_spin_us_ != 0 && steady_clock::now() < spin_deadline_) {
+    timeout = 0;
+  }
+  if (timer_wheel_ && !timer_wheel_->Empty()) {
+    timeout = timer_wheel_->NextTimeout(steady_clock::now(), timeout);
+  }
+  if (timeout != 0) {
+    // Publish parked_ before the last look at the queue, PostTask pushes before it reads parked_,
+    // so either the task is seen here or the producer wakes the poll up.
+    parked_.store(true, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (!pending_tasks_.Empty()) {
+      timeout = 0;
+    }
+  }
+  int events = multiple_io_base_->Poll(timeout);
+  parked_.store(false, std::memory_order_relaxed);
+  if (busy_poll_spin_us_ != 0 && events > 0) {
+    spin_deadline_ = steady_clock::now() + std::chrono::microseconds(busy_poll_spin_us_);
+  }
 
-  vector<IOLoopTask> tasks;
-  {
-    lock_guard<mutex> lock(mutex_);
-    tasks.swap(pending_tasks_);
+  if (timer_wheel_ && !timer_wheel_->Empty()) {
+    timer_wheel_->Advance(steady_clock::now());
   }
 
-  for (auto &task : tasks) {
+  IOLoopTask task;
+  while (pending_tasks_.Pop(task)) {
     task();
   }
+
+  if (external_wait_) {
+    // The caller waits on GetPollFd until the next call, tasks posted meanwhile must make it readable.
+    parked_.store(true, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (!pending_tasks_.Empty() && parked_.exchange(false, std::memory_order_relaxed)) {
+      Wakeup();
+    }
+  }
+  return events;
+}
+
+int IOLoop::GetPollFd() const {
+  return multiple_io_base_ ? multiple_io_base_->GetPollFd() : -1;
+}
+
+int IOLoop::NextTimeout(int max_timeout) const {
+  if (!timer_wheel_ || timer_wheel_->Empty()) {
+    return max_timeout;
+  }
+  return timer_wheel_->NextTimeout(steady_clock::now(), max_timeout);
+}
+
+TimerId IOLoop::AddTimer(uint32_t delay_ms, const IOLoopTask &task, uint32_t period_ms) {
+  if (!timer_wheel_) {
+    LOG_ERROR("Add timer failed, the io loop is created without timer.");
+    return kInvalidTimerId;
+  }
+  return timer_wheel_->Add(steady_clock::now(), delay_ms, task, period_ms);
+}
+
+void IOLoop::CancelTimer(TimerId id) {
+  if (timer_wheel_) {
+    timer_wheel_->Cancel(id);
+  }
+}
+
+void IOLoop::PostTimer(uint32_t delay_ms, const IOLoopTask &task) {
+  PostTask([this, delay_ms, task]() { AddTimer(delay_ms, task); });
 }
 
  bool IOLoop::Wakeup() {
@@ -85,14 +151,15 @@ void IOLoop::Loop() {
  }
 
 void IOLoop::PostTask(const IOLoopTask &task) {
-  {
-    lock_guard<mutex> lock(mutex_);
-    pending_tasks_.push_back(task);
+  pending_tasks_.Push(task);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  // Only the first producer after the loop parked pays for the wake up.
+  if (parked_.load(std::memory_order_relaxed) && parked_.exchange(false, std::memory_order_relaxed)) {
+    Wakeup();
   }
-  Wakeup();
 }
 
-void IOLoop::AddDelegateAsync(socket_t sock, IOLoop::IOLoopDelegate *delegate, void *data) {
+void IOLoop::AddDelegateAsync(socket_t sock, IOLoop::IOLoopDelegate *delegate, void *data, bool direct_recv) {
   PollFd pollfd = {};
   pollfd.fd = sock;
   pollfd.event = READBLE_EVENT;
@@ -103,12 +170,17 @@ void IOLoop::AddDelegateAsync(socket_t sock, IOLoop::IOLoopDelegate *delegate, v
       }
     }
   };
-  if (enable_timer_) {
-    pollfd.timer_callback = [=](TimePoint t) {
+  if (direct_recv) {
+    pollfd.recv_callback = [=](const util::RecvMsg &msg) {
       if (delegate) {
-        delegate->OnTimer(t);
+        delegate->OnRecv(sock, data, msg);
       }
     };
+    if (edge_triggered_) {
+      pollfd.drain_callback = [=]() {
+        return delegate ? delegate->OnDrain(sock, data) : false;
+      };
+    }
   }
   if (enable_wake_) {
     pollfd.wake_callback = [=]() {
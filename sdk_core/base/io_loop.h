@@ -25,8 +25,8 @@
 #ifndef LIVOX_IO_LOOP_H_
 #define LIVOX_IO_LOOP_H_
 
+#include <atomic>
 #include <functional>
-#include <mutex>
 #include <unordered_map>
 #include <utility>
 #include <vector>
@@ -34,13 +34,16 @@
 #include "command_callback.h"
 #include "noncopyable.h"
 #include "thread_base.h"
+#include "mpsc_queue.h"
+#include "timer_wheel.h"
+#include "recv_buffer_pool.h"
 #include "multiple_io/multiple_io_base.h"
 #include "multiple_io/multiple_io_factory.h"
 
 namespace livox {
 namespace lidar {
 
-#define OPEN_MAX_POLL 48
+#define POLL_SIZE_HINT 64 // initial capacity, the poll set grows with the sockets added
 #define POLL_TIMEOUT 50 //ms
 typedef int socket_t;
 
@@ -51,33 +54,75 @@ class IOLoop : public noncopyable {
   class IOLoopDelegate {
    public:
     virtual void OnData(socket_t, void *) {}
-    virtual void OnTimer(std::chrono::steady_clock::time_point) {}
+    virtual void OnRecv(socket_t, void *, const util::RecvMsg &) {}
+    /** Read a bounded number of datagrams, return true if the socket may still hold some. */
+    virtual bool OnDrain(socket_t sock, void *data) { OnData(sock, data); return false; }
     virtual void OnWake() {}
   };
 
  public:
-  explicit IOLoop(bool enable_timer = true, bool enable_wake = true)
-      : enable_timer_(enable_timer), enable_wake_(enable_wake){};
+  /** With enable_timer the loop runs the timers added by AddTimer. */
+  explicit IOLoop(bool enable_timer = true, bool enable_wake = true, MultipleIOType io_type = kMultipleIODefault)
+      : enable_timer_(enable_timer), enable_wake_(enable_wake), io_type_(io_type), busy_poll_spin_us_(0),
+        edge_triggered_(false), external_wait_(false), parked_(false) {};
 
 
   bool Init();
   void Uninit();
-  void AddDelegate(socket_t sock, IOLoopDelegate *delegate, void *data = NULL);
+  /** With direct_recv, backends receiving datagrams themselves deliver them through OnRecv instead of OnData. */
+  void AddDelegate(socket_t sock, IOLoopDelegate *delegate, void *data = NULL, bool direct_recv = false);
   void RemoveDelegate(socket_t sock, IOLoopDelegate *delegate);
-  void Loop();
+  /** Wait up to timeout ms, less if a timer is due, and run the events, return the number of events. */
+  int Loop(int timeout = POLL_TIMEOUT);
   bool Wakeup();
+  /** Thread safe and lock free, the loop is only woken up if it is blocked in the poll. */
   void PostTask(const IOLoopTask &task);
+  /**
+   * Run task on the loop delay_ms from now, then every period_ms if it is not 0.
+   * Loop thread only, as is CancelTimer.
+   */
+  TimerId AddTimer(uint32_t delay_ms, const IOLoopTask &task, uint32_t period_ms = 0);
+  void CancelTimer(TimerId id);
+  /** Thread safe AddTimer for timers that are never cancelled. */
+  void PostTimer(uint32_t delay_ms, const IOLoopTask &task);
+  RecvBufferPool& GetRecvBufferPool() { return recv_buffer_pool_; }
+  /**
+   * Keep polling without blocking for spin_us after the last ready descriptor before
+   * falling back to the blocking wait, 0 disables it. Set before the loop is started.
+   */
+  void SetBusyPoll(uint32_t spin_us) { busy_poll_spin_us_ = spin_us; }
+  /**
+   * Watch direct_recv delegates edge triggered through OnDrain where the backend supports it,
+   * their OnData must then leave the socket empty. Set before the delegates are added.
+   */
+  void SetEdgeTriggered(bool enable) { edge_triggered_ = enable; }
+  /**
+   * The loop is run by a thread waiting on GetPollFd between calls of Loop, so PostTask keeps
+   * waking it up outside of Loop. Set before the loop is run.
+   */
+  void SetExternalWait(bool enable) { external_wait_ = enable; }
+  /** Descriptor readable when the loop has events, -1 if the backend has none. */
+  int GetPollFd() const;
+  /** Milliseconds until the next timer is due, capped by max_timeout. Loop thread only. */
+  int NextTimeout(int max_timeout) const;
 
  private:
-  void AddDelegateAsync(socket_t sock, IOLoopDelegate *delegate, void *data);
+  void AddDelegateAsync(socket_t sock, IOLoopDelegate *delegate, void *data, bool direct_recv);
   void RemoveDelegateAsync(socket_t sock);
 
  private:
-  std::mutex mutex_;
   bool enable_timer_;
   bool enable_wake_;
-  std::vector<IOLoopTask> pending_tasks_;
+  MultipleIOType io_type_;
+  uint32_t busy_poll_spin_us_;
+  bool edge_triggered_;
+  bool external_wait_;
+  std::chrono::steady_clock::time_point spin_deadline_;
+  std::atomic<bool> parked_;  /**< the loop is, or is about to be, blocked in the poll. */
+  MpscQueue<IOLoopTask> pending_tasks_;
   std::unique_ptr<MultipleIOBase> multiple_io_base_;
+  RecvBufferPool recv_buffer_pool_;
+  std::unique_ptr<TimerWheel> timer_wheel_;
 };
 
 } // namespace lidar
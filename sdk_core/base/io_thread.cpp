@@ -41,8 +41,8 @@ void IOThread::ThreadFunc() {
   }
 }
 
-bool IOThread::Init(bool enable_timer, bool enable_wake) {
-  loop_ = std::make_shared<IOLoop>(enable_timer, enable_wake);
+bool IOThread::Init(bool enable_timer, bool enable_wake, MultipleIOType io_type) {
+  loop_ = std::make_shared<IOLoop>(enable_timer, enable_wake, io_type);
   return loop_->Init();
 }
 
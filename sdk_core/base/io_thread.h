@@ -35,7 +35,7 @@ class IOThread : public ThreadBase {
  public:
   IOThread() : loop_(nullptr) {}
   virtual ~IOThread();
-  bool Init(bool enable_timer = true, bool enable_wake = true);
+  bool Init(bool enable_timer = true, bool enable_wake = true, MultipleIOType io_type = kMultipleIODefault);
   std::weak_ptr<IOLoop> GetLoop() { return loop_; }
   void ThreadFunc();
 
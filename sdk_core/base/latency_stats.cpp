@@ -0,0 +1,104 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2022 Livox. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#include "latency_stats.h"
+#include "logging.h"
+
+namespace livox {
+namespace lidar {
+
+static const uint64_t kLatencyReportIntervalNs = 5000000000ULL;
+
+LatencyStats::LatencyStats() : label_("data"), max_ns_(0), next_report_ns_(0) {
+  for (uint32_t i = 0; i < kBucketNum; ++i) {
+    buckets_[i].store(0, std::memory_order_relaxed);
+  }
+}
+
+void LatencyStats::Record(uint64_t rx_timestamp_ns, uint64_t now_ns) {
+  if (rx_timestamp_ns == 0) {
+    return;
+  }
+  uint64_t latency_ns = now_ns > rx_timestamp_ns ? now_ns - rx_timestamp_ns : 0;
+
+  uint64_t latency_us = latency_ns / 1000;
+  uint32_t bucket = 0;
+  while (latency_us > 0 && bucket < kBucketNum - 1) {
+    latency_us >>= 1;
+    ++bucket;
+  }
+  buckets_[bucket].fetch_add(1, std::memory_order_relaxed);
+
+  uint64_t max_ns = max_ns_.load(std::memory_order_relaxed);
+  while (latency_ns > max_ns && !max_ns_.compare_exchange_weak(max_ns, latency_ns, std::memory_order_relaxed)) {
+  }
+
+  uint64_t next_report_ns = next_report_ns_.load(std::memory_order_relaxed);
+  if (next_report_ns == 0) {
+    next_report_ns_.compare_exchange_strong(next_report_ns, now_ns + kLatencyReportIntervalNs);
+  } else if (now_ns >= next_report_ns &&
+             next_report_ns_.compare_exchange_strong(next_report_ns, now_ns + kLatencyReportIntervalNs)) {
+    Report();
+  }
+}
+
+void LatencyStats::Reset() {
+  for (uint32_t i = 0; i < kBucketNum; ++i) {
+    buckets_[i].store(0, std::memory_order_relaxed);
+  }
+  max_ns_.store(0, std::memory_order_relaxed);
+  next_report_ns_.store(0, std::memory_order_relaxed);
+}
+
+void LatencyStats::Report() {
+  uint64_t buckets[kBucketNum];
+  uint64_t total = 0;
+  for (uint32_t i = 0; i < kBucketNum; ++i) {
+    buckets[i] = buckets_[i].exchange(0, std::memory_order_relaxed);
+    total += buckets[i];
+  }
+  uint64_t max_ns = max_ns_.exchange(0, std::memory_order_relaxed);
+  if (total == 0) {
+    return;
+  }
+  LOG_INFO("Rx to callback latency, mode:{}, packets:{}, p50:<{}us, p90:<{}us, p99:<{}us, max:{}us",
+           label_, total, Percentile(buckets, total, 50), Percentile(buckets, total, 90),
+           Percentile(buckets, total, 99), max_ns / 1000);
+}
+
+uint64_t LatencyStats::Percentile(const uint64_t* buckets, uint64_t total, uint32_t percent) const {
+  // Bucket i holds latencies below 2^i us, the upper bound is reported.
+  uint64_t target = (total * percent + 99) / 100;
+  uint64_t count = 0;
+  for (uint32_t i = 0; i < kBucketNum; ++i) {
+    count += buckets[i];
+    if (count >= target) {
+      return 1ULL << i;
+    }
+  }
+  return 1ULL << (kBucketNum - 1);
+}
+
+} // namespace lidar
+}  // namespace livox
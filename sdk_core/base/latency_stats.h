@@ -0,0 +1,65 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2022 Livox. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifndef LIVOX_LATENCY_STATS_H_
+#define LIVOX_LATENCY_STATS_H_
+
+#include <stdint.h>
+#include <atomic>
+#include <string>
+#include "noncopyable.h"
+
+namespace livox {
+namespace lidar {
+
+/**
+ * Lock free histogram of the packet arrival to callback latency. Samples land in
+ * power of two microsecond buckets, and the percentiles are logged and reset
+ * every report interval by the thread recording the first sample after it.
+ */
+class LatencyStats : public noncopyable {
+ public:
+  static const uint32_t kBucketNum = 32;
+
+  LatencyStats();
+  void SetLabel(const std::string& label) { label_ = label; }
+  /** Record the latency of a datagram stamped by the kernel at rx_timestamp_ns and delivered at now_ns. */
+  void Record(uint64_t rx_timestamp_ns, uint64_t now_ns);
+  void Reset();
+
+ private:
+  void Report();
+  uint64_t Percentile(const uint64_t* buckets, uint64_t total, uint32_t percent) const;
+
+ private:
+  std::string label_;
+  std::atomic<uint64_t> buckets_[kBucketNum];
+  std::atomic<uint64_t> max_ns_;
+  std::atomic<uint64_t> next_report_ns_;
+};
+
+} // namespace lidar
+}  // namespace livox
+
+#endif  // LIVOX_LATENCY_STATS_H_
@@ -0,0 +1,90 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2022 Livox. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifndef LIVOX_MPSC_QUEUE_H_
+#define LIVOX_MPSC_QUEUE_H_
+
+#include <atomic>
+#include <utility>
+#include "noncopyable.h"
+
+namespace livox {
+namespace lidar {
+
+/**
+ * Unbounded lock free queue for many producers and a single consumer. Push is wait free,
+ * one exchange and one store. The consumer always keeps the last node it consumed as the stub.
+ */
+template <typename T>
+class MpscQueue : public noncopyable {
+ public:
+  MpscQueue() : head_(new Node()), tail_(head_.load(std::memory_order_relaxed)) {}
+  ~MpscQueue() {
+    T value;
+    while (Pop(value)) {
+    }
+    delete tail_;
+  }
+
+  /** Thread safe. */
+  void Push(T value) {
+    Node* node = new Node(std::move(value));
+    Node* prev = head_.exchange(node, std::memory_order_acq_rel);
+    prev->next.store(node, std::memory_order_release);
+  }
+
+  /**
+   * Consumer thread only. Returns false when empty, and also while the oldest push is between its
+   * exchange and its store; the value becomes visible once that producer finishes.
+   */
+  bool Pop(T& value) {
+    Node* next = tail_->next.load(std::memory_order_acquire);
+    if (next == nullptr) {
+      return false;
+    }
+    value = std::move(next->value);
+    delete tail_;
+    tail_ = next;
+    return true;
+  }
+
+  /** Consumer thread only. */
+  bool Empty() const { return tail_->next.load(std::memory_order_acquire) == nullptr; }
+
+ private:
+  struct Node {
+    Node() : next(nullptr) {}
+    explicit Node(T v) : value(std::move(v)), next(nullptr) {}
+    T value;
+    std::atomic<Node*> next;
+  };
+
+  std::atomic<Node*> head_;  /**< last pushed node, producers side. */
+  Node* tail_;               /**< stub preceding the oldest value, consumer side. */
+};
+
+} // namespace lidar
+}  // namespace livox
+
+#endif  // LIVOX_MPSC_QUEUE_H_
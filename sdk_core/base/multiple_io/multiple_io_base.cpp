@@ -27,17 +27,62 @@
 namespace livox {
 namespace lidar {
 
-void MultipleIOBase::CheckTimer() {
-  TimePoint t = std::chrono::steady_clock::now();
-  if (t - last_timeout_ > std::chrono::milliseconds(50)) {
-    last_timeout_ = t;
-    for (auto & descriptor : descriptors_) {
-      PollFd pollfd =  descriptor.second;
-      if (pollfd.timer_callback) {
-        pollfd.timer_callback(t);
-      }
-    }
+PollHandler* PollFdSet::Add(const PollFd& poll_fd) {
+  int fd = poll_fd.fd;
+  if (fd < 0) {
+    return nullptr;
+  }
+  PollHandler* handler = Find(fd);
+  if (handler != nullptr) {
+    wake_num_ -= handler->poll_fd.wake_callback ? 1 : 0;
+    handler->poll_fd = poll_fd;
+    wake_num_ += poll_fd.wake_callback ? 1 : 0;
+    return handler;
+  }
+  if (static_cast<size_t>(fd) >= index_.size()) {
+    index_.resize(static_cast<size_t>(fd) + 1, nullptr);
+  }
+  handler = new PollHandler();
+  handler->poll_fd = poll_fd;
+  handler->pos = handlers_.size();
+  handler->removed = false;
+  handler->backlogged = false;
+  handlers_.emplace_back(handler);
+  index_[fd] = handler;
+  wake_num_ += poll_fd.wake_callback ? 1 : 0;
+  return handler;
+}
+
+bool PollFdSet::Remove(int fd) {
+  PollHandler* handler = Find(fd);
+  if (handler == nullptr) {
+    return false;
   }
+  size_t pos = handler->pos;
+  handler->removed = true;
+  wake_num_ -= handler->poll_fd.wake_callback ? 1 : 0;
+  retired_.push_back(std::move(handlers_[pos]));
+  if (pos + 1 != handlers_.size()) {
+    handlers_[pos] = std::move(handlers_.back());
+    handlers_[pos]->pos = pos;
+  }
+  handlers_.pop_back();
+  index_[fd] = nullptr;
+  return true;
+}
+
+PollHandler* PollFdSet::Find(int fd) {
+  if (fd < 0 || static_cast<size_t>(fd) >= index_.size()) {
+    return nullptr;
+  }
+  return index_[fd];
+}
+
+void PollFdSet::clear() {
+  handlers_.clear();
+  retired_.clear();
+  index_.clear();
+  wake_num_ = 0;
 }
 
 void MultipleIOBase::WakeUpInit() {
@@ -53,10 +98,12 @@ void MultipleIOBase::WakeUpInit() {
       if (wake_up_pipe_) {
         wake_up_pipe_->Drain();
       }
-      for (auto & descriptor : descriptors_) {
-        PollFd pollfd =  descriptor.second;
-        if (pollfd.wake_callback) {
-          pollfd.wake_callback();
+      if (descriptors_.WakeNum() == 0) {
+        return;
+      }
+      for (auto & handler : descriptors_) {
+        if (handler->poll_fd.wake_callback) {
+          handler->poll_fd.wake_callback();
         }
       }
     }
@@ -25,11 +25,13 @@
 #ifndef MULTIPLE_IO_BASE_H_
 #define MULTIPLE_IO_BASE_H_
 
-#include <map>
+#include <stdint.h>
+#include <vector>
 #include <functional>
 #include <chrono>
 #include <memory>
 #include "base/wake_up/wake_up_pipe.h"
+#include "base/network/network_util.h"
 
 namespace livox {
 namespace lidar {
@@ -41,28 +43,83 @@ namespace lidar {
 typedef std::chrono::steady_clock::time_point TimePoint;
 typedef int FdEvent;
 
+typedef enum {
+  kMultipleIODefault = 0,  /* epoll, kqueue, select or poll, depending on the platform. */
+  kMultipleIOUring = 1     /* io_uring, Linux only. */
+} MultipleIOType;
+
 typedef struct {
   int fd;                                         /* File descriptor. */
   FdEvent event;                                  /* Read | Write Event to listen. */
   std::function<void(FdEvent)> event_callback;    /* Read or Write Event Callback. */
-  std::function<void(TimePoint)> timer_callback;  /* Timer Event Callback. */
   std::function<void()> wake_callback;            /* WakeUp Event Callback. */
+  std::function<void(const util::RecvMsg&)> recv_callback;  /* Datagram received by the backend, optional. */
+  /**
+   * Edge triggered read, optional. Backends supporting it report readiness once per edge and call it
+   * instead of event_callback. It returns true if its budget ran out before the socket was empty, the
+   * backend calls it again on the next iteration without waiting for a new edge.
+   */
+  std::function<bool()> drain_callback;
 } PollFd;
 
+/** Registration record of a descriptor, its address is stable for as long as it is registered. */
+typedef struct {
+  PollFd poll_fd;
+  size_t pos;    /* position in the dense handler list. */
+  bool removed;  /* retired, events still queued for it must be ignored. */
+  bool backlogged;  /* queued to be drained again on the next iteration without a new edge. */
+} PollHandler;
+
+/**
+ * Descriptors registered to a multiple io. Handlers are heap records that backends hand to the
+ * kernel as event cookies, so dispatch is one indirect call without lookup nor copy. A dense list
+ * and a table indexed by fd make add, remove and iteration cheap whatever the number of sockets.
+ */
+class PollFdSet {
+ public:
+  typedef std::vector<std::unique_ptr<PollHandler>>::iterator iterator;
+  /** Register poll_fd, updating the handler in place if fd is already registered. */
+  PollHandler* Add(const PollFd& poll_fd);
+  /**
+   * Return false if fd is not registered. The handler is flagged removed and kept alive until
+   * ReleaseRetired, so that events already returned by the kernel can still be looked at.
+   */
+  bool Remove(int fd);
+  PollHandler* Find(int fd);
+  /** Handler at position pos of the dense list, positions follow the swap with the last on removal. */
+  PollHandler* Get(size_t pos) { return handlers_[pos].get(); }
+  /** Free the removed handlers, call it when no event of a previous wait is pending. */
+  void ReleaseRetired() { retired_.clear(); }
+  /** Number of handlers with a wake_callback. */
+  size_t WakeNum() const { return wake_num_; }
+  void clear();
+  size_t size() const { return handlers_.size(); }
+  bool empty() const { return handlers_.empty(); }
+  iterator begin() { return handlers_.begin(); }
+  iterator end() { return handlers_.end(); }
+ private:
+  std::vector<std::unique_ptr<PollHandler>> handlers_;
+  std::vector<std::unique_ptr<PollHandler>> retired_;
+  std::vector<PollHandler*> index_;  /* fd -> handler, nullptr if not registered. */
+  size_t wake_num_ = 0;
+};
+
 class MultipleIOBase {
  public:
   MultipleIOBase() = default;
   virtual ~MultipleIOBase() = default;
+  /** size is the expected number of descriptors, the poll set grows beyond it as needed. */
   virtual bool PollCreate(int size) = 0;
   virtual void PollDestroy() = 0;
   virtual bool PollSetAdd(PollFd poll_fd) = 0;
   virtual bool PollSetRemove(PollFd poll_fd) = 0;
-  virtual void Poll(int timeout) = 0;
+  /** Wait up to timeout ms and dispatch the events, return the number of ready descriptors. */
+  virtual int Poll(int timeout) = 0;
   virtual void PollWakeUp();
+  /** Descriptor readable when Poll has events to dispatch, -1 if the backend has none. */
+  virtual int GetPollFd() const { return -1; }
  protected:
-  virtual void CheckTimer();
-  std::map<int, PollFd> descriptors_;
-  TimePoint last_timeout_ = TimePoint();
+  PollFdSet descriptors_;
 
   virtual void WakeUpInit();
   virtual void WakeUpUninit();
@@ -24,6 +24,8 @@
 
 #include "multiple_io_epoll.h"
 #ifdef HAVE_EPOLL
+#include <algorithm>
+
 namespace livox {
 namespace lidar {
 
@@ -37,12 +39,12 @@ int GetEvent (FdEvent event) {
 }
 
 bool MultipleIOEpoll::PollCreate(int size) {
-  max_poll_size_ = size + 1;
-  epoll_fd_ = epoll_create(max_poll_size_);
+  // The size is only a hint since Linux 2.6.8, the interest list grows as needed.
+  epoll_fd_ = epoll_create(size + 1);
   if (epoll_fd_ < 0) {
     return false;
   }
-  pollset_.reset(new struct epoll_event[size]);
+  pollset_.reserve(size + 1);
   WakeUpInit();
   return true;
 }
@@ -56,18 +58,23 @@ void MultipleIOEpoll::PollDestroy() {
 }
 
 bool MultipleIOEpoll::PollSetAdd(PollFd poll_fd) {
-  if (max_poll_size_ <= (int)descriptors_.size()) {
-    return false;
-  }
   struct epoll_event ee = {0};
   ee.events = GetEvent(poll_fd.event);
-  ee.data.fd = poll_fd.fd;
+  if (poll_fd.drain_callback) {
+    ee.events |= EPOLLET;
+  }
+  if (poll_fd.fd < 0 || descriptors_.Find(poll_fd.fd) != nullptr) {
+    return false;
+  }
+  PollHandler* handler = descriptors_.Add(poll_fd);
+  ee.data.ptr = handler;
   if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, poll_fd.fd, &ee) == -1) {
-      return false;
+    descriptors_.Remove(poll_fd.fd);
+    return false;
+  }
+  if (pollset_.size() < descriptors_.size()) {
+    pollset_.resize(descriptors_.size());
   }
-
-  int fd = poll_fd.fd;
-  descriptors_[fd] = poll_fd;
   return true;
 }
 
@@ -75,15 +82,19 @@ bool MultipleIOEpoll::PollSetRemove(PollFd poll_fd) {
   int fd = poll_fd.fd;
   struct epoll_event ee = {0};
   epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, &ee);
-  if (descriptors_.find(fd) != descriptors_.end()) {
-      descriptors_.erase(fd);
-  }
+  descriptors_.Remove(fd);
   return true;
 }
 
-void MultipleIOEpoll::Poll(int time_out) {
-  int ret = epoll_wait(epoll_fd_, pollset_.get(), (int)descriptors_.size(),
-                    time_out);
+int MultipleIOEpoll::Poll(int time_out) {
+  // Sockets left with data by their budget get no new edge, do not sleep before serving them.
+  backlog_.swap(backlog_next_);
+  // No event of the previous wait is pending any more, the handlers removed since can go.
+  backlog_.erase(std::remove_if(backlog_.begin(), backlog_.end(),
+      [](const PollHandler* handler) { return handler->removed; }), backlog_.end());
+  descriptors_.ReleaseRetired();
+  int ret = epoll_wait(epoll_fd_, pollset_.data(), (int)pollset_.size(), backlog_.empty() ? time_out : 0);
+  int merged = 0;
   if (ret > 0) {
     for (int i =0; i< ret; i++) {
       FdEvent fd_event = NONE_EVENT;
@@ -93,14 +104,39 @@ void MultipleIOEpoll::Poll(int time_out) {
       if (pollset_[i].events & EPOLLOUT) {
         fd_event |= WRITABLE_EVENT;
       }
-      int fd = pollset_[i].data.fd;
-      if (descriptors_.find(fd) != descriptors_.end()) {
-        PollFd pollfd =  descriptors_[fd];
-        pollfd.event_callback(fd_event);
+      PollHandler* handler = static_cast<PollHandler*>(pollset_[i].data.ptr);
+      if (handler->removed) {
+        continue;
       }
+      if (handler->poll_fd.drain_callback && (fd_event & READBLE_EVENT)) {
+        // A backlogged socket with a fresh edge is drained once, from the backlog below.
+        if (handler->backlogged) {
+          ++merged;
+        } else {
+          Drain(handler);
+        }
+      } else {
+        handler->poll_fd.event_callback(fd_event);
+      }
+    }
+  }
+  ret = ret > 0 ? ret - merged : 0;
+  for (PollHandler* handler : backlog_) {
+    if (!handler->removed) {
+      handler->backlogged = false;
+      Drain(handler);
+      ++ret;
     }
   }
-  CheckTimer();
+  backlog_.clear();
+  return ret;
+}
+
+void MultipleIOEpoll::Drain(PollHandler* handler) {
+  if (handler->poll_fd.drain_callback() && !handler->backlogged) {
+    handler->backlogged = true;
+    backlog_next_.push_back(handler);
+  }
 }
 
 } // namespace lidar
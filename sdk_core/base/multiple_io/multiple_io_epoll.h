@@ -28,6 +28,7 @@
 #include "multiple_io_base.h"
 #include "livox_lidar_cfg.h"
 #include <memory>
+#include <vector>
 
 #ifdef HAVE_EPOLL
 
@@ -39,12 +40,15 @@ class MultipleIOEpoll : public MultipleIOBase {
   bool PollCreate(int size);
   bool PollSetAdd(PollFd poll_fd);
   bool PollSetRemove(PollFd poll_fd);
-  void Poll(int timeout);
+  int Poll(int timeout);
+  int GetPollFd() const { return epoll_fd_; }
   void PollDestroy();
  private:
+  void Drain(PollHandler* handler);
   int epoll_fd_ = -1;
-  std::unique_ptr<struct epoll_event[]> pollset_;
-  int max_poll_size_ = 0;
+  std::vector<struct epoll_event> pollset_;
+  std::vector<PollHandler*> backlog_;  /* edge triggered handlers whose drain budget ran out. */
+  std::vector<PollHandler*> backlog_next_;
 };
 
 } // namespace lidar
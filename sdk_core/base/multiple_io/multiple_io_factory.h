@@ -30,6 +30,7 @@
 #include "multiple_io_kqueue.h"
 #include "multiple_io_select.h"
 #include "multiple_io_poll.h"
+#include "multiple_io_uring.h"
 #include <memory>
 
 namespace livox {
@@ -37,7 +38,12 @@ namespace lidar {
 
 class MultipleIOFactory {
  public:
-  static std::unique_ptr<MultipleIOBase> CreateMultipleIO() {
+  static std::unique_ptr<MultipleIOBase> CreateMultipleIO(MultipleIOType type = kMultipleIODefault) {
+#if defined(HAVE_IO_URING)
+    if (type == kMultipleIOUring) {
+      return std::unique_ptr<MultipleIOBase>(new MultipleIOUring());
+    }
+#endif
 #if defined(HAVE_EPOLL)
     return std::unique_ptr<MultipleIOBase>(new MultipleIOEpoll());
 #elif defined(HAVE_KQUEUE)
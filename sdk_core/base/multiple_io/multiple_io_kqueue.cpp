@@ -44,9 +44,7 @@ bool MultipleIOKqueue::PollCreate(int size) {
     close(kqueue_fd_);
     return false;
   }
-  max_poll_size_ = size + 1;
-  set_size_ = 2 * max_poll_size_;
-  kevent_set_.reset(new struct kevent[set_size_]);
+  kevent_set_.resize(2 * (size + 1));
   WakeUpInit();
   return true;
 }
@@ -60,41 +58,50 @@ void MultipleIOKqueue::PollDestroy() {
 }
 
 bool MultipleIOKqueue::PollSetAdd(PollFd poll_fd) {
-  if (max_poll_size_ <= (int)descriptors_.size()) {
+  int fd = poll_fd.fd;
+  if (fd < 0 || descriptors_.Find(fd) != nullptr) {
     return false;
   }
-  int fd = poll_fd.fd;
-  descriptors_[fd] = poll_fd;
+  PollHandler* handler = descriptors_.Add(poll_fd);
   if (poll_fd.event & READBLE_EVENT) {
-    EV_SET(&kevent_, fd, EVFILT_READ, EV_ADD, 0, 0, &descriptors_[fd].fd);
+    EV_SET(&kevent_, fd, EVFILT_READ, EV_ADD, 0, 0, handler);
     if (kevent(kqueue_fd_, &kevent_, 1, nullptr, 0, nullptr) == -1) {
-      descriptors_.erase(fd);
+      descriptors_.Remove(fd);
       return false;
     }
   }
   if (poll_fd.event & WRITABLE_EVENT) {
-    EV_SET(&kevent_, fd, EVFILT_WRITE, EV_ADD, 0, 0, &descriptors_[fd].fd);
+    EV_SET(&kevent_, fd, EVFILT_WRITE, EV_ADD, 0, 0, handler);
     if (kevent(kqueue_fd_, &kevent_, 1, nullptr, 0, nullptr) == -1) {
-      descriptors_.erase(fd);
+      if (poll_fd.event & READBLE_EVENT) {
+        EV_SET(&kevent_, fd, EVFILT_READ, EV_DELETE, 0, 0, NULL);
+        kevent(kqueue_fd_, &kevent_, 1, nullptr, 0, nullptr);
+      }
+      descriptors_.Remove(fd);
       return false;
     }
   }
+  // Each descriptor may report a read and a write filter in one wait.
+  if (kevent_set_.size() < 2 * descriptors_.size()) {
+    kevent_set_.resize(2 * descriptors_.size());
+  }
   return true;
 }
 
 bool MultipleIOKqueue::PollSetRemove(PollFd poll_fd) {
   int fd = poll_fd.fd;
   bool result = true;
-  if (descriptors_.find(fd) != descriptors_.end()) {
+  PollHandler* handler = descriptors_.Find(fd);
+  if (handler != nullptr) {
     do {
-      if (descriptors_[fd].event & READBLE_EVENT) {
+      if (handler->poll_fd.event & READBLE_EVENT) {
         EV_SET(&kevent_, fd, EVFILT_READ, EV_DELETE, 0, 0, NULL);
         if (kevent(kqueue_fd_, &kevent_, 1, nullptr, 0, nullptr) == -1) {
           result = false;
           break;
         }
       }
-      if (descriptors_[fd].event & WRITABLE_EVENT) {
+      if (handler->poll_fd.event & WRITABLE_EVENT) {
         EV_SET(&kevent_, fd, EVFILT_WRITE, EV_DELETE, 0, 0, NULL);
         if (kevent(kqueue_fd_, &kevent_, 1, nullptr, 0, nullptr) == -1) {
           result = false;
@@ -102,12 +109,12 @@ bool MultipleIOKqueue::PollSetRemove(PollFd poll_fd) {
         }
       }
     } while(0);
-    descriptors_.erase(fd);
+    descriptors_.Remove(fd);
   }
   return result;
 }
 
-void MultipleIOKqueue::Poll(int time_out) {
+int MultipleIOKqueue::Poll(int time_out) {
   struct timespec tv, *tvptr;
 
   if (time_out < 0) {
@@ -118,22 +125,22 @@ void MultipleIOKqueue::Poll(int time_out) {
     tvptr = &tv;
   }
 
-  int rv = kevent(kqueue_fd_, NULL, 0, kevent_set_.get(), set_size_, tvptr);
+  descriptors_.ReleaseRetired();
+  int rv = kevent(kqueue_fd_, NULL, 0, kevent_set_.data(), (int)kevent_set_.size(), tvptr);
   if (rv > 0) {
     for (int i = 0; i < rv; i++) {
-      int fd = *(int *)(kevent_set_[i].udata);
-      if (descriptors_.find(fd) != descriptors_.end()) {
-        PollFd pollfd =  descriptors_[fd];
+      PollHandler* handler = static_cast<PollHandler*>(kevent_set_[i].udata);
+      if (!handler->removed) {
         if (kevent_set_[i].filter == EVFILT_READ) {
-          pollfd.event_callback(READBLE_EVENT);
+          handler->poll_fd.event_callback(READBLE_EVENT);
         }
         if (kevent_set_[i].filter == EVFILT_WRITE) {
-          pollfd.event_callback(WRITABLE_EVENT);
+          handler->poll_fd.event_callback(WRITABLE_EVENT);
         }
       }
     }
   }
-  CheckTimer();
+  return rv > 0 ? rv : 0;
 }
 
 } // namespace lidar
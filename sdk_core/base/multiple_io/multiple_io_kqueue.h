@@ -37,14 +37,13 @@ class MultipleIOKqueue : public MultipleIOBase {
   bool PollCreate(int size);
   bool PollSetAdd(PollFd poll_fd);
   bool PollSetRemove(PollFd poll_fd);
-  void Poll(int timeout);
+  int Poll(int timeout);
+  int GetPollFd() const { return kqueue_fd_; }
   void PollDestroy();
  private:
   int kqueue_fd_ = -1;
   struct kevent kevent_ = {};
-  std::unique_ptr<struct kevent[]> kevent_set_;
-  int max_poll_size_ = 0;
-  int set_size_ = 0;
+  std::vector<struct kevent> kevent_set_;
 };
 
 } // namespace lidar
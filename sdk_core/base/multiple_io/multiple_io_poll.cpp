@@ -39,25 +39,26 @@ int GetEvent (FdEvent event) {
 }
 
 bool MultipleIOPoll:: PollCreate(int size) {
-  max_poll_size_ = size + 1;
-  pollset_.reset(new struct pollfd[max_poll_size_]);
+  pollset_.reserve(size + 1);
   WakeUpInit();
   return true;
 }
 
 bool MultipleIOPoll:: PollSetAdd(PollFd poll_fd) {
-  if (max_poll_size_ <= (int)descriptors_.size()) {
+  PollHandler* handler = descriptors_.Add(poll_fd);
+  if (handler == nullptr) {
     return false;
   }
 
-  int fd = poll_fd.fd;
-  descriptors_[fd] = poll_fd;
-
-  struct pollfd fds;
-  fds.fd = fd;
+  // pollset_ mirrors the order of the handlers, so a ready entry maps to its handler by position.
+  struct pollfd fds = {};
+  fds.fd = poll_fd.fd;
   fds.events = GetEvent(poll_fd.event);
-  pollset_[pollset_num_] = fds;
-  pollset_num_++;
+  if (handler->pos < pollset_.size()) {
+    pollset_[handler->pos] = fds;
+  } else {
+    pollset_.push_back(fds);
+  }
   return true;
 }
 
@@ -67,31 +68,25 @@ void MultipleIOPoll::PollDestroy() {
 }
 
 bool MultipleIOPoll:: PollSetRemove(PollFd poll_fd) {
-  int fd = poll_fd.fd;
-  if (descriptors_.find(fd) != descriptors_.end()) {
-    descriptors_.erase(fd);
-  }
-
-  for (int i = 0; i< pollset_num_; i++) {
-    if (pollset_[i].fd == fd) {
-      int dst = i;
-      for (i++; i < pollset_num_ - 1; i++) {
-        if (pollset_[i].fd == fd) {
-          pollset_num_--;
-        } else {
-          pollset_[dst] = pollset_[i];
-          dst++;
-        }
-      }
-    }
+  PollHandler* handler = descriptors_.Find(poll_fd.fd);
+  if (handler == nullptr) {
+    return true;
   }
+  size_t pos = handler->pos;
+  descriptors_.Remove(poll_fd.fd);
+  pollset_[pos] = pollset_.back();
+  pollset_.pop_back();
   return true;
 }
 
-void MultipleIOPoll:: Poll(int time_out) {
-  int rv = poll(pollset_.get(), pollset_num_, time_out);
+int MultipleIOPoll:: Poll(int time_out) {
+  descriptors_.ReleaseRetired();
+  int rv = poll(pollset_.data(), pollset_.size(), time_out);
   if (rv > 0) {
-    for (int i = 0; i < pollset_num_; i++) {
+    for (size_t i = 0; i < pollset_.size(); i++) {
+      if (pollset_[i].revents == NONE_EVENT) {
+        continue;
+      }
       FdEvent fd_event = NONE_EVENT;
       if (pollset_[i].revents & POLLIN) {
         fd_event |= READBLE_EVENT;
@@ -99,15 +94,11 @@ void MultipleIOPoll:: Poll(int time_out) {
       if (pollset_[i].revents & POLLOUT) {
         fd_event |= WRITABLE_EVENT;
       }
-      int fd = pollset_[i].fd;
-      if (descriptors_.find(fd) != descriptors_.end()) {
-          PollFd pollfd =  descriptors_[fd];
-          pollfd.event_callback(fd_event);
-      }
       pollset_[i].revents = NONE_EVENT;
+      descriptors_.Get(i)->poll_fd.event_callback(fd_event);
     }
   }
-  CheckTimer();
+  return rv > 0 ? rv : 0;
 }
 
 } // namespace lidar
@@ -28,6 +28,7 @@
 #include "multiple_io_base.h"
 #include "livox_lidar_cfg.h"
 #include <memory>
+#include <vector>
 
 
 #ifdef HAVE_POLL
@@ -40,12 +41,10 @@ class MultipleIOPoll : public MultipleIOBase {
   bool PollCreate(int size);
   bool PollSetAdd(PollFd poll_fd);
   bool PollSetRemove(PollFd poll_fd);
-  void Poll(int timeout);
+  int Poll(int timeout);
   void PollDestroy();
  private:
-  std::unique_ptr<struct pollfd[]> pollset_;
-  int pollset_num_ = 0;
-  int max_poll_size_ = 0;
+  std::vector<struct pollfd> pollset_;
 };
 
 } // namespace lidar
@@ -24,6 +24,7 @@
 
 #include "multiple_io_select.h"
 #include <thread>
+#include <algorithm>
 
 #ifdef HAVE_SELECT
 namespace livox {
@@ -32,8 +33,6 @@ namespace lidar {
 bool MultipleIOSelect:: PollCreate(int size) {
   FD_ZERO(&rfds_);
   FD_ZERO(&wfds_);
-  //wake up fd + 1
-  max_poll_size_ = size + 1;
   WakeUpInit();
   return true;
 }
@@ -45,11 +44,18 @@ void MultipleIOSelect::PollDestroy() {
 }
 
 bool MultipleIOSelect:: PollSetAdd(PollFd poll_fd) {
-  if (max_poll_size_ <= (int)descriptors_.size()) {
+  int fd = poll_fd.fd;
+  // fd_set is a fixed size bitmap on POSIX and a fixed size array on Windows.
+#ifdef WIN32
+  if (descriptors_.Find(fd) == nullptr && descriptors_.size() >= FD_SETSIZE) {
+#else
+  if (fd >= FD_SETSIZE) {
+#endif
+    return false;
+  }
+  if (descriptors_.Add(poll_fd) == nullptr) {
     return false;
   }
-  int fd = poll_fd.fd;
-  descriptors_[fd] = poll_fd;
   if (max_fd_ < fd) {
     max_fd_ = fd;
   }
@@ -64,26 +70,27 @@ bool MultipleIOSelect:: PollSetAdd(PollFd poll_fd) {
 
 bool MultipleIOSelect:: PollSetRemove(PollFd poll_fd) {
   int fd = poll_fd.fd;
-  if (descriptors_.find(fd) != descriptors_.end()) {
-    descriptors_.erase(fd);
-  }
+  descriptors_.Remove(fd);
   FD_CLR(fd, &rfds_);
   FD_CLR(fd, &wfds_);
   if (max_fd_ <= fd) {
-    max_fd_--;
+    max_fd_ = -1;
+    for (auto& handler : descriptors_) {
+      max_fd_ = std::max(max_fd_, handler->poll_fd.fd);
+    }
   }
   return true;
 }
 
-void MultipleIOSelect:: Poll(int time_out) {
+int MultipleIOSelect:: Poll(int time_out) {
   fd_set readset, writeset;
   struct timeval tv, *tvptr;
   if (descriptors_.size() == 0) {
     if (time_out > 0) {
       std::this_thread::sleep_for(std::chrono::milliseconds(time_out));
-      return;
+      return 0;
     }
-    return ;
+    return 0;
   }
 
   if (time_out < 0) {
@@ -97,10 +104,11 @@ void MultipleIOSelect:: Poll(int time_out) {
   memcpy(&readset, &rfds_, sizeof(fd_set));
   memcpy(&writeset, &wfds_, sizeof(fd_set));
 
+  descriptors_.ReleaseRetired();
   int rv = select(max_fd_ + 1, &readset, &writeset, nullptr, tvptr);
   if (rv > 0) {
-    for (auto& descriptor : descriptors_) {
-      int fd = descriptor.first;
+    for (auto& handler : descriptors_) {
+      int fd = handler->poll_fd.fd;
       FdEvent fd_event = NONE_EVENT;
       if (FD_ISSET(fd, &readset)) {
         fd_event |= READBLE_EVENT;
@@ -109,12 +117,11 @@ void MultipleIOSelect:: Poll(int time_out) {
         fd_event |= WRITABLE_EVENT;
       }
       if (fd_event != NONE_EVENT) {
-        PollFd pollfd =  descriptor.second;
-        pollfd.event_callback(fd_event);
+        handler->poll_fd.event_callback(fd_event);
       }
     }
   }
-  CheckTimer();
+  return rv > 0 ? rv : 0;
 }
 
 } // namespace lidar
@@ -38,13 +38,12 @@ class MultipleIOSelect : public MultipleIOBase {
   bool PollCreate(int size);
   bool PollSetAdd(PollFd poll_fd);
   bool PollSetRemove(PollFd poll_fd);
-  void Poll(int timeout);
+  int Poll(int timeout);
   void PollDestroy();
  private:
   int max_fd_ = -1;
   fd_set rfds_;
   fd_set wfds_;
-  int max_poll_size_ = 0;
 };
 
 } // namespace lidar
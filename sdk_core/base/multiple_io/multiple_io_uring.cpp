@@ -0,0 +1,424 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2022 Livox. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+#include "multiple_io_uring.h"
+
+#ifdef HAVE_IO_URING
+
+#include <errno.h>
+#include <poll.h>
+#include <signal.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <netinet/in.h>
+#include <algorithm>
+
+#include "base/network/network_util.h"
+#include "base/logging.h"
+
+namespace livox {
+namespace lidar {
+
+static const uint32_t kUringSqEntries = 64;
+static const uint32_t kUringCqEntries = 1024;
+static const uint16_t kUringBufferNum = 256;       /* power of two, required by the buffer ring. */
+static const uint16_t kUringBufferGroup = 0;
+static const size_t kUringMaxPayloadSize = 8192;
+static const uint64_t kUringIgnoredUserData = 0;
+static const int kUringPendingRetryMs = 1;
+
+static const size_t kUringControlSize = util::kRecvControlSize;
+
+static const size_t kUringBufferSize = sizeof(struct io_uring_recvmsg_out) + sizeof(struct sockaddr_in) +
+    kUringControlSize + kUringMaxPayloadSize;
+
+MultipleIOUring::~MultipleIOUring() {
+  ReleaseRing();
+}
+
+bool MultipleIOUring::PollCreate(int) {
+  if (!SetupRing(kUringSqEntries) || !SetupBufferRing()) {
+    ReleaseRing();
+    return false;
+  }
+  WakeUpInit();
+  return true;
+}
+
+void MultipleIOUring::PollDestroy() {
+  WakeUpUninit();
+  ReleaseRing();
+}
+
+bool MultipleIOUring::SetupRing(uint32_t entries) {
+  struct io_uring_params params;
+  memset(&params, 0, sizeof(params));
+  params.flags = IORING_SETUP_CQSIZE;
+  params.cq_entries = kUringCqEntries;
+  ring_fd_ = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+  if (ring_fd_ < 0) {
+    ring_fd_ = -1;
+    return false;
+  }
+  if (!(params.features & IORING_FEAT_SINGLE_MMAP) || !(params.features & IORING_FEAT_EXT_ARG)) {
+    return false;
+  }
+
+  size_t sq_size = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+  size_t cq_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+  ring_size_ = std::max(sq_size, cq_size);
+  ring_ptr_ = mmap(nullptr, ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_,
+                   IORING_OFF_SQ_RING);
+  if (ring_ptr_ == MAP_FAILED) {
+    ring_ptr_ = nullptr;
+    return false;
+  }
+  sqes_size_ = params.sq_entries * sizeof(struct io_uring_sqe);
+  void* sqes = mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_,
+                    IORING_OFF_SQES);
+  if (sqes == MAP_FAILED) {
+    return false;
+  }
+  sqes_ = static_cast<struct io_uring_sqe*>(sqes);
+
+  uint8_t* ring = static_cast<uint8_t*>(ring_ptr_);
+  sq_head_ = reinterpret_cast<uint32_t*>(ring + params.sq_off.head);
+  sq_tail_ = reinterpret_cast<uint32_t*>(ring + params.sq_off.tail);
+  sq_mask_ = *reinterpret_cast<uint32_t*>(ring + params.sq_off.ring_mask);
+  sq_entries_ = params.sq_entries;
+  sqe_tail_ = *sq_tail_;
+  // Submission slots map one to one onto the sqe array.
+  uint32_t* sq_array = reinterpret_cast<uint32_t*>(ring + params.sq_off.array);
+  for (uint32_t i = 0; i < sq_entries_; ++i) {
+    sq_array[i] = i;
+  }
+
+  cq_head_ = reinterpret_cast<uint32_t*>(ring + params.cq_off.head);
+  cq_tail_ = reinterpret_cast<uint32_t*>(ring + params.cq_off.tail);
+  cq_mask_ = *reinterpret_cast<uint32_t*>(ring + params.cq_off.ring_mask);
+  cqes_ = reinterpret_cast<struct io_uring_cqe*>(ring + params.cq_off.cqes);
+  return true;
+}
+
+bool MultipleIOUring::SetupBufferRing() {
+  if (!buffers_.Init(kUringBufferSize, kUringBufferNum)) {
+    return false;
+  }
+  buf_ring_size_ = kUringBufferNum * sizeof(struct io_uring_buf);
+  void* buf_ring = mmap(nullptr, buf_ring_size_, PROT_READ | PROT_WRITE, MAP_ANONYMOUS | MAP_PRIVATE, -1, 0);
+  if (buf_ring == MAP_FAILED) {
+    return false;
+  }
+  buf_ring_ = static_cast<struct io_uring_buf_ring*>(buf_ring);
+
+  struct io_uring_buf_reg reg;
+  memset(&reg, 0, sizeof(reg));
+  reg.ring_addr = reinterpret_cast<uint64_t>(buf_ring_);
+  reg.ring_entries = kUringBufferNum;
+  reg.bgid = kUringBufferGroup;
+  if (syscall(__NR_io_uring_register, ring_fd_, IORING_REGISTER_PBUF_RING, &reg, 1) < 0) {
+    return false;
+  }
+
+  buf_ring_tail_ = 0;
+  for (uint16_t bid = 0; bid < kUringBufferNum; ++bid) {
+    RecycleBuffer(bid);
+  }
+  __atomic_store_n(&buf_ring_->tail, buf_ring_tail_, __ATOMIC_RELEASE);
+  return true;
+}
+
+void MultipleIOUring::ReleaseRing() {
+  // Closing the ring cancels every request still in flight and drops the buffer ring registration.
+  if (ring_fd_ >= 0) {
+    close(ring_fd_);
+    ring_fd_ = -1;
+  }
+  if (sqes_) {
+    munmap(sqes_, sqes_size_);
+    sqes_ = nullptr;
+  }
+  if (ring_ptr_) {
+    munmap(ring_ptr_, ring_size_);
+    ring_ptr_ = nullptr;
+  }
+  if (buf_ring_) {
+    munmap(buf_ring_, buf_ring_size_);
+    buf_ring_ = nullptr;
+  }
+  pending_requests_.clear();
+  requests_.clear();
+  retired_requests_.clear();
+  descriptors_.clear();
+}
+
+bool MultipleIOUring::PollSetAdd(PollFd poll_fd) {
+  int fd = poll_fd.fd;
+  if (ring_fd_ < 0 || requests_.find(fd) != requests_.end()) {
+    return false;
+  }
+
+  std::unique_ptr<Request> request(new Request());
+  request->poll_fd = poll_fd;
+  request->direct_recv = static_cast<bool>(poll_fd.recv_callback);
+  request->armed = false;
+  request->removed = false;
+  memset(&request->msg, 0, sizeof(request->msg));
+  request->msg.msg_namelen = sizeof(struct sockaddr_in);
+  request->msg.msg_controllen = kUringControlSize;
+
+  if (!Arm(request.get())) {
+    pending_requests_.push_back(request.get());
+  }
+  requests_[fd] = std::move(request);
+  descriptors_.Add(poll_fd);
+  return true;
+}
+
+bool MultipleIOUring::PollSetRemove(PollFd poll_fd) {
+  int fd = poll_fd.fd;
+  descriptors_.Remove(fd);
+  auto it = requests_.find(fd);
+  if (it == requests_.end()) {
+    return true;
+  }
+  std::unique_ptr<Request> request = std::move(it->second);
+  requests_.erase(it);
+  request->removed = true;
+  if (request->armed) {
+    // The kernel still references the request until its final completion is reaped.
+    if (!Cancel(request.get())) {
+      pending_requests_.push_back(request.get());
+    }
+    retired_requests_.push_back(std::move(request));
+  } else {
+    pending_requests_.erase(std::remove(pending_requests_.begin(), pending_requests_.end(), request.get()),
+                            pending_requests_.end());
+  }
+  return true;
+}
+
+struct io_uring_sqe* MultipleIOUring::GetSqe() {
+  uint32_t head = __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE);
+  if (sqe_tail_ - head >= sq_entries_) {
+    Enter(0, 0, nullptr, 0);
+    head = __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE);
+    if (sqe_tail_ - head >= sq_entries_) {
+      return nullptr;
+    }
+  }
+  struct io_uring_sqe* sqe = &sqes_[sqe_tail_ & sq_mask_];
+  memset(sqe, 0, sizeof(*sqe));
+  ++sqe_tail_;
+  return sqe;
+}
+
+int MultipleIOUring::Enter(uint32_t min_complete, uint32_t flags, const void* arg, size_t arg_size) {
+  __atomic_store_n(sq_tail_, sqe_tail_, __ATOMIC_RELEASE);
+  uint32_t to_submit = sqe_tail_ - __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE);
+  return static_cast<int>(syscall(__NR_io_uring_enter, ring_fd_, to_submit, min_complete, flags, arg, arg_size));
+}
+
+bool MultipleIOUring::Arm(Request* request) {
+  struct io_uring_sqe* sqe = GetSqe();
+  if (sqe == nullptr) {
+    LOG_WARN("io_uring submission queue full, fd {} is armed on the next poll.", request->poll_fd.fd);
+    return false;
+  }
+  sqe->fd = request->poll_fd.fd;
+  sqe->user_data = reinterpret_cast<uint64_t>(request);
+  if (request->direct_recv) {
+    sqe->opcode = IORING_OP_RECVMSG;
+    sqe->addr = reinterpret_cast<uint64_t>(&request->msg);
+    sqe->len = 1;
+    sqe->ioprio = IORING_RECV_MULTISHOT;
+    sqe->flags = IOSQE_BUFFER_SELECT;
+    sqe->buf_group = kUringBufferGroup;
+  } else {
+    sqe->opcode = IORING_OP_POLL_ADD;
+    uint32_t events = 0;
+    if (request->poll_fd.event & READBLE_EVENT) {
+      events |= POLLIN;
+    }
+    if (request->poll_fd.event & WRITABLE_EVENT) {
+      events |= POLLOUT;
+    }
+    sqe->poll32_events = events;
+  }
+  request->armed = true;
+  return true;
+}
+
+bool MultipleIOUring::Cancel(Request* request) {
+  struct io_uring_sqe* sqe = GetSqe();
+  if (sqe == nullptr) {
+    LOG_WARN("io_uring submission queue full, the request of fd {} is cancelled on the next poll.",
+             request->poll_fd.fd);
+    return false;
+  }
+  sqe->opcode = IORING_OP_ASYNC_CANCEL;
+  sqe->fd = -1;
+  sqe->addr = reinterpret_cast<uint64_t>(request);
+  sqe->user_data = kUringIgnoredUserData;
+  return true;
+}
+
+bool MultipleIOUring::SubmitPending() {
+  while (!pending_requests_.empty()) {
+    Request* request = pending_requests_.back();
+    bool submitted = request->removed ? Cancel(request) : Arm(request);
+    if (!submitted) {
+      return false;
+    }
+    pending_requests_.pop_back();
+  }
+  return true;
+}
+
+void MultipleIOUring::RecycleBuffer(uint16_t bid) {
+  // Index the entries by hand, the bufs flexible array of the uapi header is shifted by 8 bytes in C++.
+  struct io_uring_buf* bufs = reinterpret_cast<struct io_uring_buf*>(buf_ring_);
+  struct io_uring_buf* buf = &bufs[buf_ring_tail_ & (kUringBufferNum - 1)];
+  buf->addr = reinterpret_cast<uint64_t>(buffers_.GetBuffer(bid));
+  buf->len = static_cast<uint32_t>(buffers_.GetBufferSize());
+  buf->bid = bid;
+  ++buf_ring_tail_;
+}
+
+int MultipleIOUring::Poll(int time_out) {
+  descriptors_.ReleaseRetired();
+  if (!SubmitPending() && (time_out < 0 || time_out > kUringPendingRetryMs)) {
+    // Come back soon, the completions reaped below make room in the queue.
+    time_out = kUringPendingRetryMs;
+  }
+  struct __kernel_timespec ts;
+  ts.tv_sec = time_out / 1000;
+  ts.tv_nsec = (time_out % 1000) * 1000000LL;
+  struct io_uring_getevents_arg arg;
+  memset(&arg, 0, sizeof(arg));
+  arg.sigmask_sz = _NSIG / 8;
+  arg.ts = (time_out >= 0) ? reinterpret_cast<uint64_t>(&ts) : 0;
+  Enter(1, IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG, &arg, sizeof(arg));
+
+  uint32_t head = *cq_head_;
+  uint32_t tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+  uint16_t buf_ring_tail = buf_ring_tail_;
+  int events = static_cast<int>(tail - head);
+  for (; head != tail; ++head) {
+    struct io_uring_cqe cqe = cqes_[head & cq_mask_];
+    HandleCompletion(cqe);
+  }
+  __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+  if (buf_ring_tail != buf_ring_tail_) {
+    __atomic_store_n(&buf_ring_->tail, buf_ring_tail_, __ATOMIC_RELEASE);
+  }
+  return events;
+}
+
+void MultipleIOUring::HandleCompletion(const struct io_uring_cqe& cqe) {
+  if (cqe.user_data == kUringIgnoredUserData) {
+    return;
+  }
+  Request* request = reinterpret_cast<Request*>(cqe.user_data);
+  bool more = (cqe.flags & IORING_CQE_F_MORE) != 0;
+  if (!more) {
+    request->armed = false;
+  }
+
+  if (request->removed) {
+    if (cqe.flags & IORING_CQE_F_BUFFER) {
+      RecycleBuffer(static_cast<uint16_t>(cqe.flags >> IORING_CQE_BUFFER_SHIFT));
+    }
+    if (!more) {
+      auto it = std::find_if(retired_requests_.begin(), retired_requests_.end(),
+          [request](const std::unique_ptr<Request>& retired) { return retired.get() == request; });
+      if (it != retired_requests_.end()) {
+        // Its cancel is not needed any more either.
+        pending_requests_.erase(std::remove(pending_requests_.begin(), pending_requests_.end(), request),
+                                pending_requests_.end());
+        retired_requests_.erase(it);
+      }
+    }
+    return;
+  }
+
+  if (request->direct_recv) {
+    HandleRecv(request, cqe);
+  } else if (cqe.res > 0) {
+    FdEvent fd_event = NONE_EVENT;
+    if (cqe.res & (POLLIN | POLLERR | POLLHUP)) {
+      fd_event |= READBLE_EVENT;
+    }
+    if (cqe.res & POLLOUT) {
+      fd_event |= WRITABLE_EVENT;
+    }
+    request->poll_fd.event_callback(fd_event);
+  }
+
+  if (request->armed || request->removed) {
+    return;
+  }
+  if (cqe.res < 0 && cqe.res != -ENOBUFS && cqe.res != -EINTR && cqe.res != -EAGAIN) {
+    if (!request->direct_recv || cqe.res != -EINVAL) {
+      return;
+    }
+    // Multishot recvmsg is not supported by this kernel, watch the socket for readiness instead.
+    request->direct_recv = false;
+  }
+  if (!Arm(request)) {
+    pending_requests_.push_back(request);
+  }
+}
+
+void MultipleIOUring::HandleRecv(Request* request, const struct io_uring_cqe& cqe) {
+  if (!(cqe.flags & IORING_CQE_F_BUFFER)) {
+    return;
+  }
+  uint16_t bid = static_cast<uint16_t>(cqe.flags >> IORING_CQE_BUFFER_SHIFT);
+  if (cqe.res > 0) {
+    uint8_t* buf = buffers_.GetBuffer(bid);
+    const struct io_uring_recvmsg_out* out = reinterpret_cast<const struct io_uring_recvmsg_out*>(buf);
+    size_t name_offset = sizeof(struct io_uring_recvmsg_out);
+    size_t control_offset = name_offset + request->msg.msg_namelen;
+    size_t payload_offset = control_offset + request->msg.msg_controllen;
+    if (static_cast<size_t>(cqe.res) >= payload_offset) {
+      util::RecvMsg msg;
+      msg.buf = buf + payload_offset;
+      msg.size = std::min<uint32_t>(out->payloadlen, static_cast<uint32_t>(cqe.res - payload_offset));
+      msg.buf_size = msg.size;
+      memcpy(&msg.addr, buf + name_offset, sizeof(msg.addr));
+      struct msghdr control = {};
+      control.msg_control = buf + control_offset;
+      control.msg_controllen = std::min<size_t>(out->controllen, request->msg.msg_controllen);
+      util::ParseRecvControl(&control, msg);
+      request->poll_fd.recv_callback(msg);
+    }
+  }
+  RecycleBuffer(bid);
+}
+
+} // namespace lidar
+}  // namespace livox
+
+#endif  // HAVE_IO_URING
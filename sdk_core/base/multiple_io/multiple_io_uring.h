@@ -0,0 +1,111 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2022 Livox. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+#ifndef MULTIPLE_IO_URING_H_
+#define MULTIPLE_IO_URING_H_
+
+#include "multiple_io_base.h"
+#include "livox_lidar_cfg.h"
+#include <map>
+#include <memory>
+#include <vector>
+
+#ifdef HAVE_IO_URING
+
+#include <sys/socket.h>
+#include <linux/io_uring.h>
+#include "base/recv_buffer_pool.h"
+
+namespace livox {
+namespace lidar {
+
+/**
+ * io_uring backend. Descriptors with a recv_callback are served by a multishot
+ * recvmsg that picks its buffer from a registered provided-buffer ring, so a
+ * datagram is received without a readiness wakeup followed by a read. Other
+ * descriptors are watched by one-shot poll requests re-armed after each event.
+ */
+class MultipleIOUring : public MultipleIOBase {
+ public:
+  ~MultipleIOUring();
+  bool PollCreate(int size);
+  bool PollSetAdd(PollFd poll_fd);
+  bool PollSetRemove(PollFd poll_fd);
+  int Poll(int timeout);
+  void PollDestroy();
+
+ private:
+  typedef struct {
+    PollFd poll_fd;
+    bool direct_recv;   /* multishot recvmsg instead of poll. */
+    bool armed;         /* a request is in flight in the kernel. */
+    bool removed;
+    struct msghdr msg;  /* recvmsg layout, referenced by the kernel while armed. */
+  } Request;
+
+  bool SetupRing(uint32_t entries);
+  bool SetupBufferRing();
+  void ReleaseRing();
+  struct io_uring_sqe* GetSqe();
+  int Enter(uint32_t min_complete, uint32_t flags, const void* arg, size_t arg_size);
+  /** Queue the request, false when the submission queue stays full, it is then retried by Poll. */
+  bool Arm(Request* request);
+  bool Cancel(Request* request);
+  /** Submit the arms and cancels left over by a full submission queue, false if some are still pending. */
+  bool SubmitPending();
+  void HandleCompletion(const struct io_uring_cqe& cqe);
+  void HandleRecv(Request* request, const struct io_uring_cqe& cqe);
+  void RecycleBuffer(uint16_t bid);
+
+  int ring_fd_ = -1;
+  void* ring_ptr_ = nullptr;
+  size_t ring_size_ = 0;
+  struct io_uring_sqe* sqes_ = nullptr;
+  size_t sqes_size_ = 0;
+
+  uint32_t* sq_head_ = nullptr;
+  uint32_t* sq_tail_ = nullptr;
+  uint32_t sq_mask_ = 0;
+  uint32_t sq_entries_ = 0;
+  uint32_t sqe_tail_ = 0;
+
+  uint32_t* cq_head_ = nullptr;
+  uint32_t* cq_tail_ = nullptr;
+  uint32_t cq_mask_ = 0;
+  struct io_uring_cqe* cqes_ = nullptr;
+
+  struct io_uring_buf_ring* buf_ring_ = nullptr;
+  size_t buf_ring_size_ = 0;
+  uint16_t buf_ring_tail_ = 0;
+  RecvBufferPool buffers_;
+
+  std::map<int, std::unique_ptr<Request>> requests_;
+  std::vector<std::unique_ptr<Request>> retired_requests_;  /* removed, waiting for their last completion. */
+  std::vector<Request*> pending_requests_;  /* to arm, or to cancel once removed, when the queue has room. */
+};
+
+} // namespace lidar
+}  // namespace livox
+
+#endif  // HAVE_IO_URING
+#endif  // MULTIPLE_IO_URING_H_
@@ -34,11 +34,13 @@
 #include <sys/socket.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
+#include <time.h>
 #endif // WIN32
 #include <stdio.h>
 #include <stdio.h>
 #include <fcntl.h>
 #include <string>
+#include <vector>
 
 namespace livox {
 namespace lidar {
@@ -46,7 +48,31 @@ namespace lidar {
 namespace util {
 
 typedef int socket_t;
-socket_t CreateSocket(uint16_t port, bool nonblock = true, bool reuse_port = true, bool is_broadcast = false, const std::string netif = "", const std::string multicast_ip = "");
+
+/** Upper bound of datagrams fetched by a single RecvBatchFrom call. */
+static const int kMaxRecvBatchSize = 64;
+
+/** Receive buffer requested by CreateSocket unless the caller asks for another size. */
+static const uint32_t kDefaultRecvBufSize = 1024 * 1024;
+
+#ifndef WIN32
+/** Control message space for the rx timestamp, the GRO segment size and the drop counter. */
+static const size_t kRecvControlSize = CMSG_SPACE(sizeof(struct timespec)) + CMSG_SPACE(sizeof(int)) +
+    CMSG_SPACE(sizeof(uint32_t));
+#endif
+
+typedef struct {
+  void *buf;                 /* Receive buffer, filled by RecvBatchFrom. */
+  size_t buf_size;           /* Capacity of buf. */
+  struct sockaddr_in addr;   /* Source address of the datagram. */
+  int size;                  /* Received bytes. */
+  uint64_t timestamp;        /* Kernel receive time in ns since epoch, 0 if the datagram is not stamped. */
+  uint16_t gso_size;         /* Segment size when the kernel coalesced several datagrams into buf, 0 otherwise. */
+  uint32_t drops;            /* Datagrams the socket has dropped so far, reported with SO_RXQ_OVFL, 0 if none. */
+} RecvMsg;
+
+socket_t CreateSocket(uint16_t port, bool nonblock = true, bool reuse_port = true, bool is_broadcast = false, const std::string netif = "", const std::string multicast_ip = "", bool share_port = false,
+                      uint32_t recv_buf_size = kDefaultRecvBufSize);
 //socket_t CreateSocket(uint16_t port, bool nonblock = true, bool reuse_port = true, bool is_broadcast = false);
 
 void CloseSock(socket_t sock);
@@ -55,6 +81,77 @@ bool FindLocalIp(const struct sockaddr_in &client_addr, uint32_t &local_ip);
 
 size_t RecvFrom(socket_t &sock, void *buff,  size_t buf_size, int flag, struct sockaddr *addr, int* addrlen);
 
+/**
+ * Only accept datagrams from ip:port on the socket. A connected socket outranks the
+ * unconnected ones bound to the same port, so the kernel demultiplexes by source.
+ * @param ip    ipv4 address in network order.
+ * @param port  port in host order.
+ */
+bool ConnectSocket(socket_t sock, uint32_t ip, uint16_t port);
+
+/**
+ * Receive up to count datagrams without blocking.
+ * @return the number of datagrams received, 0 if the socket has nothing to read.
+ */
+int RecvBatchFrom(socket_t sock, RecvMsg *msgs, int count);
+
+/**
+ * Steer datagrams of a SO_REUSEPORT group by source address, so that every
+ * sender always lands on the same socket of the group.
+ * @param sock        any socket of the group created with share_port.
+ * @param group_size  number of sockets in the group.
+ * @return true if the steering program is attached.
+ */
+bool AttachReusePortSteering(socket_t sock, uint32_t group_size);
+
+/**
+ * Drop every datagram arriving on the socket, keeping only the port bound.
+ * @return true if the filter is attached.
+ */
+bool AttachDropFilter(socket_t sock);
+
+/** Find the index of the network interface owning the ipv4 address host_ip. */
+bool GetInterfaceIndex(const std::string& host_ip, int& if_index);
+
+/**
+ * Find the name of the network interface owning host_ip and the cpus local to its device,
+ * as reported by the kernel. cpus stays empty for virtual interfaces.
+ * @return true if the interface is found.
+ */
+bool GetInterfaceTopology(const std::string& host_ip, std::string& if_name, std::vector<int>& cpus);
+
+/** Stamp every datagram received on the socket with the kernel receive time. */
+bool EnableRxTimestamp(socket_t sock);
+
+/**
+ * Let the kernel hand over several equal sized datagrams of one flow in a single
+ * receive, RecvBatchFrom reports their segment size in RecvMsg::gso_size.
+ */
+bool EnableUdpGro(socket_t sock);
+
+/**
+ * Busy poll the device queue for up to busy_poll_us when the socket has no data, and
+ * optionally prefer busy polling over interrupt driven processing.
+ */
+bool SetBusyPoll(socket_t sock, uint32_t busy_poll_us, bool prefer_busy_poll);
+
+/**
+ * Request a receive buffer of size bytes, beyond net.core.rmem_max if the process
+ * has CAP_NET_ADMIN.
+ */
+bool SetRecvBufferSize(socket_t sock, uint32_t size);
+
+/** Receive buffer granted by the kernel in bytes, 0 on failure. */
+uint32_t GetRecvBufferSize(socket_t sock);
+
+/** Report the drop counter of the socket with received datagrams, see RecvMsg::drops. */
+bool EnableRxDropCount(socket_t sock);
+
+#ifndef WIN32
+/** Fill the timestamp, gso_size and drops of recv_msg from the control messages of msg. */
+void ParseRecvControl(const struct msghdr *msg, RecvMsg &recv_msg);
+#endif
+
 }  // namespace util
 } // namespace lidar
 }  // namespace livox
@@ -0,0 +1,65 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2022 Livox. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+#include "packet_capture.h"
+
+#ifdef __linux__
+#include <arpa/inet.h>
+#include <netinet/ip.h>
+#include <netinet/udp.h>
+#endif
+
+namespace livox {
+namespace lidar {
+
+#ifdef __linux__
+
+bool PacketCapture::DeliverUdp(uint8_t* data, uint32_t len, uint64_t timestamp, const PacketCallback& callback) {
+  if (len < sizeof(struct iphdr)) {
+    return false;
+  }
+  const struct iphdr* ip = (const struct iphdr*)data;
+  uint32_t ip_len = ip->ihl * 4;
+  if (ip_len < sizeof(struct iphdr) || len < ip_len + sizeof(struct udphdr)) {
+    return false;
+  }
+  const struct udphdr* udp = (const struct udphdr*)(data + ip_len);
+  uint32_t udp_len = ntohs(udp->len);
+  if (udp_len < sizeof(struct udphdr) || ip_len + udp_len > len) {
+    return false;
+  }
+  callback(ip->saddr, ntohs(udp->source), data + ip_len + sizeof(struct udphdr), udp_len - sizeof(struct udphdr),
+           timestamp);
+  return true;
+}
+
+#else
+
+bool PacketCapture::DeliverUdp(uint8_t*, uint32_t, uint64_t, const PacketCallback&) {
+  return false;
+}
+
+#endif  // __linux__
+
+} // namespace lidar
+}  // namespace livox
@@ -0,0 +1,65 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2022 Livox. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+#ifndef LIVOX_PACKET_CAPTURE_H_
+#define LIVOX_PACKET_CAPTURE_H_
+
+#include <stdint.h>
+#include <functional>
+#include "base/noncopyable.h"
+
+namespace livox {
+namespace lidar {
+
+/**
+ * Receive path capturing udp datagrams below the socket layer. The descriptor
+ * becomes readable when packets are pending, Read then delivers the payloads
+ * in place from the capture memory.
+ */
+class PacketCapture : public noncopyable {
+ public:
+  /**
+   * handle is the source ipv4 address in network order, port the source port and timestamp
+   * the kernel receive time in ns since epoch, 0 if the capture does not stamp packets.
+   */
+  typedef std::function<void(uint32_t handle, uint16_t port, uint8_t* buf, uint32_t size,
+                             uint64_t timestamp)> PacketCallback;
+
+  virtual ~PacketCapture() {}
+  virtual int GetFd() const = 0;
+
+  /**
+   * Deliver every pending packet and hand its memory back to the kernel.
+   * @return the number of delivered packets.
+   */
+  virtual uint32_t Read(const PacketCallback& callback) = 0;
+
+ protected:
+  /** Parse an ipv4/udp packet starting at the ip header and deliver its payload. */
+  static bool DeliverUdp(uint8_t* data, uint32_t len, uint64_t timestamp, const PacketCallback& callback);
+};
+
+} // namespace lidar
+}  // namespace livox
+
+#endif  // LIVOX_PACKET_CAPTURE_H_
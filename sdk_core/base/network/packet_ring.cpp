@@ -0,0 +1,202 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2022 Livox. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+#include "packet_ring.h"
+#include "base/network/network_util.h"
+
+#ifdef __linux__
+#include <linux/filter.h>
+#include <linux/if_ether.h>
+#include <linux/if_packet.h>
+#include <netinet/in.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+namespace livox {
+namespace lidar {
+
+#ifdef __linux__
+
+static const uint32_t kPacketRingBlockSize = 1 << 18;
+static const uint32_t kPacketRingBlockNum = 16;
+static const uint32_t kPacketRingFrameSize = 2048;
+static const uint32_t kPacketRingBlockTimeout = 1;  /* ms before a partly filled block is handed out. */
+
+static bool AttachPortFilter(int fd, uint16_t port) {
+  // Offsets are relative to the ipv4 header, the link layer header is stripped by SOCK_DGRAM.
+  struct sock_filter code[] = {
+    { BPF_LD | BPF_B | BPF_ABS, 0, 0, 0 },                   // A = version | ihl
+    { BPF_ALU | BPF_AND | BPF_K, 0, 0, 0xf0 },
+    { BPF_JMP | BPF_JEQ | BPF_K, 0, 8, 0x40 },               // ipv4
+    { BPF_LD | BPF_B | BPF_ABS, 0, 0, 9 },
+    { BPF_JMP | BPF_JEQ | BPF_K, 0, 6, IPPROTO_UDP },        // udp
+    { BPF_LD | BPF_H | BPF_ABS, 0, 0, 6 },
+    { BPF_JMP | BPF_JSET | BPF_K, 4, 0, 0x3fff },            // not a fragment
+    { BPF_LDX | BPF_B | BPF_MSH, 0, 0, 0 },                  // X = ip header length
+    { BPF_LD | BPF_H | BPF_IND, 0, 0, 2 },                   // A = udp destination port
+    { BPF_JMP | BPF_JEQ | BPF_K, 0, 1, port },
+    { BPF_RET | BPF_K, 0, 0, 0xffffffff },
+    { BPF_RET | BPF_K, 0, 0, 0 },
+  };
+  struct sock_fprog prog;
+  prog.len = sizeof(code) / sizeof(code[0]);
+  prog.filter = code;
+  return setsockopt(fd, SOL_SOCKET, SO_ATTACH_FILTER, &prog, sizeof(prog)) == 0;
+}
+
+PacketRing::PacketRing()
+    : fd_(-1),
+      ring_(nullptr),
+      ring_size_(0),
+      block_size_(kPacketRingBlockSize),
+      block_num_(kPacketRingBlockNum),
+      current_block_(0) {}
+
+PacketRing::~PacketRing() {
+  Close();
+}
+
+bool PacketRing::Open(const std::string& host_ip, uint16_t port) {
+  int if_index = 0;
+  if (!host_ip.empty() && !util::GetInterfaceIndex(host_ip, if_index)) {
+    return false;
+  }
+
+  // Protocol 0 receives nothing until bind, so no packet skips the filter.
+  fd_ = socket(AF_PACKET, SOCK_DGRAM, 0);
+  if (fd_ < 0) {
+    return false;
+  }
+
+  int version = TPACKET_V3;
+  if (setsockopt(fd_, SOL_PACKET, PACKET_VERSION, &version, sizeof(version)) != 0) {
+    Close();
+    return false;
+  }
+#ifdef PACKET_IGNORE_OUTGOING
+  int ignore_outgoing = 1;
+  setsockopt(fd_, SOL_PACKET, PACKET_IGNORE_OUTGOING, &ignore_outgoing, sizeof(ignore_outgoing));
+#endif
+  if (!AttachPortFilter(fd_, port)) {
+    Close();
+    return false;
+  }
+
+  struct tpacket_req3 req;
+  memset(&req, 0, sizeof(req));
+  req.tp_block_size = block_size_;
+  req.tp_block_nr = block_num_;
+  req.tp_frame_size = kPacketRingFrameSize;
+  req.tp_frame_nr = (block_size_ / kPacketRingFrameSize) * block_num_;
+  req.tp_retire_blk_tov = kPacketRingBlockTimeout;
+  if (setsockopt(fd_, SOL_PACKET, PACKET_RX_RING, &req, sizeof(req)) != 0) {
+    Close();
+    return false;
+  }
+
+  ring_size_ = static_cast<size_t>(block_size_) * block_num_;
+  void* ring = mmap(nullptr, ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+  if (ring == MAP_FAILED) {
+    Close();
+    return false;
+  }
+  ring_ = static_cast<uint8_t*>(ring);
+  current_block_ = 0;
+
+  struct sockaddr_ll addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sll_family = AF_PACKET;
+  addr.sll_protocol = htons(ETH_P_IP);
+  addr.sll_ifindex = if_index;
+  if (bind(fd_, (struct sockaddr*)&addr, sizeof(addr)) != 0) {
+    Close();
+    return false;
+  }
+  return true;
+}
+
+void PacketRing::Close() {
+  if (ring_ != nullptr) {
+    munmap(ring_, ring_size_);
+    ring_ = nullptr;
+  }
+  if (fd_ >= 0) {
+    close(fd_);
+    fd_ = -1;
+  }
+}
+
+uint32_t PacketRing::Read(const PacketCallback& callback) {
+  uint32_t count = 0;
+  if (ring_ == nullptr) {
+    return count;
+  }
+  while (true) {
+    struct tpacket_block_desc* block = (struct tpacket_block_desc*)(ring_ + current_block_ * block_size_);
+    if (!(__atomic_load_n(&block->hdr.bh1.block_status, __ATOMIC_ACQUIRE) & TP_STATUS_USER)) {
+      break;
+    }
+
+    uint8_t* pkt = (uint8_t*)block + block->hdr.bh1.offset_to_first_pkt;
+    for (uint32_t i = 0; i < block->hdr.bh1.num_pkts; ++i) {
+      const struct tpacket3_hdr* hdr = (const struct tpacket3_hdr*)pkt;
+      const struct sockaddr_ll* sll = (const struct sockaddr_ll*)(pkt + TPACKET_ALIGN(sizeof(struct tpacket3_hdr)));
+      uint8_t* data = pkt + hdr->tp_net;
+      uint32_t len = hdr->tp_snaplen;
+      uint64_t timestamp = static_cast<uint64_t>(hdr->tp_sec) * 1000000000ULL + hdr->tp_nsec;
+      pkt += hdr->tp_next_offset;
+      if (sll->sll_pkttype != PACKET_OUTGOING && DeliverUdp(data, len, timestamp, callback)) {
+        ++count;
+      }
+    }
+
+    __atomic_store_n(&block->hdr.bh1.block_status, TP_STATUS_KERNEL, __ATOMIC_RELEASE);
+    current_block_ = (current_block_ + 1) % block_num_;
+  }
+  return count;
+}
+
+#else
+
+PacketRing::PacketRing()
+    : fd_(-1), ring_(nullptr), ring_size_(0), block_size_(0), block_num_(0), current_block_(0) {}
+
+PacketRing::~PacketRing() {}
+
+bool PacketRing::Open(const std::string&, uint16_t) {
+  return false;
+}
+
+void PacketRing::Close() {}
+
+uint32_t PacketRing::Read(const PacketCallback&) {
+  return 0;
+}
+
+#endif  // __linux__
+
+} // namespace lidar
+}  // namespace livox
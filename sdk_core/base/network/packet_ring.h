@@ -0,0 +1,70 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2022 Livox. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+#ifndef LIVOX_PACKET_RING_H_
+#define LIVOX_PACKET_RING_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+#include "packet_capture.h"
+
+namespace livox {
+namespace lidar {
+
+/**
+ * AF_PACKET TPACKET_V3 receive ring capturing the IPv4/UDP datagrams sent to
+ * one host port. A classic BPF filter keeps only that port, and payloads are
+ * handed out in place from the mmap'd blocks. Fragmented datagrams are not
+ * reassembled and are dropped by the filter. Linux only, Open fails elsewhere.
+ */
+class PacketRing : public PacketCapture {
+ public:
+  PacketRing();
+  ~PacketRing();
+
+  /**
+   * Open the ring.
+   * @param host_ip  address of the capturing interface, empty to capture on every interface.
+   * @param port     destination udp port to capture.
+   */
+  bool Open(const std::string& host_ip, uint16_t port);
+  void Close();
+  int GetFd() const { return fd_; }
+
+  /** Deliver every packet of the blocks released by the kernel, then hand the blocks back. */
+  uint32_t Read(const PacketCallback& callback);
+
+ private:
+  int fd_;
+  uint8_t* ring_;
+  size_t ring_size_;
+  uint32_t block_size_;
+  uint32_t block_num_;
+  uint32_t current_block_;
+};
+
+} // namespace lidar
+}  // namespace livox
+
+#endif  // LIVOX_PACKET_RING_H_
@@ -24,21 +24,27 @@
 #ifndef WIN32
 #include "base/network/network_util.h"
 #include <ifaddrs.h>
+#include <net/if.h>
 #include <string>
 #include <string.h>
 #include <sys/ioctl.h>
 #include <unistd.h>
 #include <netdb.h>
+#include <netinet/udp.h>
+#include <time.h>
+#ifdef __linux__
+#include <linux/filter.h>
+#endif
 
 namespace livox {
 namespace lidar {
 namespace util {
 
-socket_t CreateSocket(uint16_t port, bool nonblock, bool reuse_port, bool is_broadcast, const std::string netif, const std::string multicast_ip) {
+socket_t CreateSocket(uint16_t port, bool nonblock, bool reuse_port, bool is_broadcast, const std::string netif, const std::string multicast_ip, bool share_port,
+                      uint32_t recv_buf_size) {
   int status = -1;
   int on = -1;
   int sock = -1;
-  int recv_buff_size = 1024 * 1024 * 200;
   struct sockaddr_in servaddr;
 
   sock = socket(AF_INET, SOCK_DGRAM, 0);
@@ -65,9 +71,19 @@ socket_t CreateSocket(uint16_t port, bool nonblock, bool reuse_port, bool is_bro
       return -1;
    }
   }
-  status = setsockopt(sock, SOL_SOCKET, SO_RCVBUF,
-	  (char *)&recv_buff_size, sizeof(recv_buff_size));
-  if (status != 0) {
+
+#ifdef SO_REUSEPORT
+  if (share_port) {
+    status = setsockopt(sock, SOL_SOCKET, SO_REUSEPORT,
+                        (char *) &on, sizeof (on));
+    if (status != 0) {
+      printf("share port failed\n");
+      close(sock);
+      return -1;
+    }
+  }
+#endif
+  if (!SetRecvBufferSize(sock, recv_buf_size)) {
 	  close(sock);
 	  return -1;
   }
@@ -211,6 +227,257 @@ size_t RecvFrom(socket_t &sock, void *buff,  size_t buf_size, int flag, struct s
   return recvfrom(sock, buff, buf_size, 0, addr, (socklen_t *)addrlen);
 }
 
+bool AttachReusePortSteering(socket_t sock, uint32_t group_size) {
+#if defined(__linux__) && defined(SO_ATTACH_REUSEPORT_CBPF)
+  if (group_size == 0) {
+    return false;
+  }
+  // index = ntohl(ip->saddr) % group_size
+  struct sock_filter code[] = {
+    { BPF_LD | BPF_W | BPF_ABS, 0, 0, (uint32_t)(SKF_NET_OFF + 12) },
+    { BPF_ALU | BPF_MOD | BPF_K, 0, 0, group_size },
+    { BPF_RET | BPF_A, 0, 0, 0 },
+  };
+  struct sock_fprog prog;
+  prog.len = sizeof(code) / sizeof(code[0]);
+  prog.filter = code;
+  return setsockopt(sock, SOL_SOCKET, SO_ATTACH_REUSEPORT_CBPF, &prog, sizeof(prog)) == 0;
+#else
+  return false;
+#endif
+}
+
+bool AttachDropFilter(socket_t sock) {
+#ifdef __linux__
+  struct sock_filter code[] = {
+    { BPF_RET | BPF_K, 0, 0, 0 },
+  };
+  struct sock_fprog prog;
+  prog.len = sizeof(code) / sizeof(code[0]);
+  prog.filter = code;
+  return setsockopt(sock, SOL_SOCKET, SO_ATTACH_FILTER, &prog, sizeof(prog)) == 0;
+#else
+  return false;
+#endif
+}
+
+bool GetInterfaceIndex(const std::string& host_ip, int& if_index) {
+  if_index = 0;
+  struct in_addr addr;
+  if (inet_pton(AF_INET, host_ip.c_str(), &addr) != 1) {
+    return false;
+  }
+  struct ifaddrs* if_addrs = nullptr;
+  if (getifaddrs(&if_addrs) != 0) {
+    return false;
+  }
+  for (struct ifaddrs* ifa = if_addrs; ifa != nullptr; ifa = ifa->ifa_next) {
+    if (ifa->ifa_addr == nullptr || ifa->ifa_addr->sa_family != AF_INET) {
+      continue;
+    }
+    if (((struct sockaddr_in*)ifa->ifa_addr)->sin_addr.s_addr == addr.s_addr) {
+      if_index = if_nametoindex(ifa->ifa_name);
+      break;
+    }
+  }
+  freeifaddrs(if_addrs);
+  return if_index > 0;
+}
+
+bool GetInterfaceTopology(const std::string& host_ip, std::string& if_name, std::vector<int>& cpus) {
+  if_name.clear();
+  cpus.clear();
+  int if_index = 0;
+  char name[IF_NAMESIZE] = {0};
+  if (!GetInterfaceIndex(host_ip, if_index) || if_indextoname(if_index, name) == nullptr) {
+    return false;
+  }
+  if_name = name;
+
+#ifdef __linux__
+  // A list of ranges such as "0-7,16-23", missing for interfaces without a device.
+  std::string path = "/sys/class/net/" + if_name + "/device/local_cpulist";
+  FILE* file = fopen(path.c_str(), "r");
+  if (file == nullptr) {
+    return true;
+  }
+  int first = 0;
+  int last = 0;
+  char sep = 0;
+  while (fscanf(file, "%d", &first) == 1) {
+    last = first;
+    sep = static_cast<char>(fgetc(file));
+    if (sep == '-') {
+      if (fscanf(file, "%d", &last) != 1) {
+        break;
+      }
+      sep = static_cast<char>(fgetc(file));
+    }
+    for (int cpu = first; cpu <= last; ++cpu) {
+      cpus.push_back(cpu);
+    }
+    if (sep != ',') {
+      break;
+    }
+  }
+  fclose(file);
+#endif
+  return true;
+}
+
+bool ConnectSocket(socket_t sock, uint32_t ip, uint16_t port) {
+  struct sockaddr_in addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = ip;
+  addr.sin_port = htons(port);
+  return connect(sock, (const struct sockaddr *)&addr, sizeof(addr)) == 0;
+}
+
+bool EnableRxTimestamp(socket_t sock) {
+#ifdef SO_TIMESTAMPNS
+  int on = 1;
+  return setsockopt(sock, SOL_SOCKET, SO_TIMESTAMPNS, &on, sizeof(on)) == 0;
+#else
+  return false;
+#endif
+}
+
+bool SetRecvBufferSize(socket_t sock, uint32_t size) {
+  int buf_size = static_cast<int>(size);
+#ifdef SO_RCVBUFFORCE
+  if (setsockopt(sock, SOL_SOCKET, SO_RCVBUFFORCE, &buf_size, sizeof(buf_size)) == 0) {
+    return true;
+  }
+#endif
+  return setsockopt(sock, SOL_SOCKET, SO_RCVBUF, &buf_size, sizeof(buf_size)) == 0;
+}
+
+uint32_t GetRecvBufferSize(socket_t sock) {
+  int buf_size = 0;
+  socklen_t len = sizeof(buf_size);
+  if (getsockopt(sock, SOL_SOCKET, SO_RCVBUF, &buf_size, &len) != 0 || buf_size < 0) {
+    return 0;
+  }
+  return static_cast<uint32_t>(buf_size);
+}
+
+bool EnableRxDropCount(socket_t sock) {
+#ifdef SO_RXQ_OVFL
+  int on = 1;
+  return setsockopt(sock, SOL_SOCKET, SO_RXQ_OVFL, &on, sizeof(on)) == 0;
+#else
+  return false;
+#endif
+}
+
+bool EnableUdpGro(socket_t sock) {
+#ifdef UDP_GRO
+  int on = 1;
+  return setsockopt(sock, IPPROTO_UDP, UDP_GRO, &on, sizeof(on)) == 0;
+#else
+  return false;
+#endif
+}
+
+bool SetBusyPoll(socket_t sock, uint32_t busy_poll_us, bool prefer_busy_poll) {
+  bool result = true;
+#ifdef SO_BUSY_POLL
+  int busy_poll = static_cast<int>(busy_poll_us);
+  result = setsockopt(sock, SOL_SOCKET, SO_BUSY_POLL, &busy_poll, sizeof(busy_poll)) == 0;
+#else
+  result = false;
+#endif
+  if (prefer_busy_poll) {
+#ifdef SO_PREFER_BUSY_POLL
+    int prefer = 1;
+    result = (setsockopt(sock, SOL_SOCKET, SO_PREFER_BUSY_POLL, &prefer, sizeof(prefer)) == 0) && result;
+#else
+    result = false;
+#endif
+  }
+  return result;
+}
+
+void ParseRecvControl(const struct msghdr *msg, RecvMsg &recv_msg) {
+  recv_msg.timestamp = 0;
+  recv_msg.gso_size = 0;
+  recv_msg.drops = 0;
+  for (struct cmsghdr *cmsg = CMSG_FIRSTHDR(msg); cmsg != nullptr;
+       cmsg = CMSG_NXTHDR(const_cast<struct msghdr *>(msg), cmsg)) {
+#ifdef SCM_TIMESTAMPNS
+    if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_TIMESTAMPNS) {
+      struct timespec ts;
+      memcpy(&ts, CMSG_DATA(cmsg), sizeof(ts));
+      recv_msg.timestamp = static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL + static_cast<uint64_t>(ts.tv_nsec);
+    }
+#endif
+#ifdef SO_RXQ_OVFL
+    if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SO_RXQ_OVFL) {
+      memcpy(&recv_msg.drops, CMSG_DATA(cmsg), sizeof(recv_msg.drops));
+    }
+#endif
+#ifdef UDP_GRO
+    if (cmsg->cmsg_level == IPPROTO_UDP && cmsg->cmsg_type == UDP_GRO) {
+      int gso_size = 0;
+      memcpy(&gso_size, CMSG_DATA(cmsg), sizeof(gso_size));
+      recv_msg.gso_size = static_cast<uint16_t>(gso_size);
+    }
+#endif
+  }
+}
+
+int RecvBatchFrom(socket_t sock, RecvMsg *msgs, int count) {
+  if (count > kMaxRecvBatchSize) {
+    count = kMaxRecvBatchSize;
+  }
+#ifdef __linux__
+  struct mmsghdr hdrs[kMaxRecvBatchSize];
+  struct iovec iovs[kMaxRecvBatchSize];
+  union {
+    char buf[kRecvControlSize];
+    struct cmsghdr align;
+  } controls[kMaxRecvBatchSize];
+  memset(hdrs, 0, sizeof(struct mmsghdr) * count);
+  for (int i = 0; i < count; ++i) {
+    iovs[i].iov_base = msgs[i].buf;
+    iovs[i].iov_len = msgs[i].buf_size;
+    hdrs[i].msg_hdr.msg_iov = &iovs[i];
+    hdrs[i].msg_hdr.msg_iovlen = 1;
+    hdrs[i].msg_hdr.msg_name = &msgs[i].addr;
+    hdrs[i].msg_hdr.msg_namelen = sizeof(msgs[i].addr);
+    hdrs[i].msg_hdr.msg_control = controls[i].buf;
+    hdrs[i].msg_hdr.msg_controllen = sizeof(controls[i].buf);
+  }
+
+  int ret = recvmmsg(sock, hdrs, count, MSG_DONTWAIT, nullptr);
+  if (ret <= 0) {
+    return 0;
+  }
+  for (int i = 0; i < ret; ++i) {
+    msgs[i].size = hdrs[i].msg_len;
+    ParseRecvControl(&hdrs[i].msg_hdr, msgs[i]);
+  }
+  return ret;
+#else
+  int received = 0;
+  while (received < count) {
+    RecvMsg &msg = msgs[received];
+    socklen_t addrlen = sizeof(msg.addr);
+    ssize_t size = recvfrom(sock, msg.buf, msg.buf_size, MSG_DONTWAIT, (struct sockaddr *)&msg.addr, &addrlen);
+    if (size < 0) {
+      break;
+    }
+    msg.size = size;
+    msg.timestamp = 0;
+    msg.gso_size = 0;
+    msg.drops = 0;
+    ++received;
+  }
+  return received;
+#endif
+}
+
 }  // namespace util
 } // namespace lidar
 }  // namespace livox
@@ -38,11 +38,12 @@ void CloseSock(socket_t sock) {
   closesocket(sock);
 }
 
-socket_t CreateSocket(uint16_t port, bool nonblock, bool reuse_port, bool is_broadcast, std::string netif, const std::string multicast_ip) {
+socket_t CreateSocket(uint16_t port, bool nonblock, bool reuse_port, bool is_broadcast, std::string netif, const std::string multicast_ip, bool share_port,
+                      uint32_t recv_buf_size) {
   int status = -1;
   int on = -1;
   int sock = -1;
-  int recv_buff_size = 1024 * 1024 * 200;
+  int recv_buff_size = static_cast<int>(recv_buf_size);
   struct sockaddr_in servaddr;
   sock = socket(AF_INET, SOCK_DGRAM, 0);
   if (sock == INVALID_SOCKET) {
@@ -170,6 +171,79 @@ size_t RecvFrom(socket_t &sock, void *buff,  size_t buf_size, int flag, struct s
   return recvfrom(sock, (char *)buff, buf_size, 0, addr, addrlen);
 }
 
+bool ConnectSocket(socket_t sock, uint32_t ip, uint16_t port) {
+  struct sockaddr_in addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = ip;
+  addr.sin_port = htons(port);
+  return connect(sock, (const struct sockaddr *)&addr, sizeof(addr)) == 0;
+}
+
+bool AttachReusePortSteering(socket_t sock, uint32_t group_size) {
+  return false;
+}
+
+bool AttachDropFilter(socket_t sock) {
+  return false;
+}
+
+bool GetInterfaceIndex(const std::string& host_ip, int& if_index) {
+  return false;
+}
+
+bool GetInterfaceTopology(const std::string& host_ip, std::string& if_name, std::vector<int>& cpus) {
+  return false;
+}
+
+bool EnableRxTimestamp(socket_t sock) {
+  return false;
+}
+
+bool SetRecvBufferSize(socket_t sock, uint32_t size) {
+  int buf_size = static_cast<int>(size);
+  return setsockopt(sock, SOL_SOCKET, SO_RCVBUF, (const char *)&buf_size, sizeof(buf_size)) == 0;
+}
+
+uint32_t GetRecvBufferSize(socket_t sock) {
+  int buf_size = 0;
+  int len = sizeof(buf_size);
+  if (getsockopt(sock, SOL_SOCKET, SO_RCVBUF, (char *)&buf_size, &len) != 0 || buf_size < 0) {
+    return 0;
+  }
+  return static_cast<uint32_t>(buf_size);
+}
+
+bool EnableRxDropCount(socket_t sock) {
+  return false;
+}
+
+bool EnableUdpGro(socket_t sock) {
+  return false;
+}
+
+bool SetBusyPoll(socket_t sock, uint32_t busy_poll_us, bool prefer_busy_poll) {
+  return false;
+}
+
+int RecvBatchFrom(socket_t sock, RecvMsg *msgs, int count) {
+  int received = 0;
+  while (received < count) {
+    RecvMsg &msg = msgs[received];
+    int addrlen = sizeof(msg.addr);
+    int size = recvfrom(sock, (char *)msg.buf, (int)msg.buf_size, 0, (struct sockaddr *)&msg.addr, &addrlen);
+    if (size < 0) {
+      break;
+    }
+    msg.size = size;
+    msg.timestamp = 0;
+    msg.gso_size = 0;
+    msg.drops = 0;
+    ++received;
+  }
+  return received;
+}
+
 } // namespace util
 }  // namespace lidar
 }  // namespace livox
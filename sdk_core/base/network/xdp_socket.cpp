@@ -0,0 +1,372 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2022 Livox. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+#include "xdp_socket.h"
+#include "base/network/network_util.h"
+
+#include <algorithm>
+
+#ifdef HAVE_AF_XDP
+#include <arpa/inet.h>
+#include <dirent.h>
+#include <linux/bpf.h>
+#include <linux/if_ether.h>
+#include <linux/if_link.h>
+#include <linux/if_xdp.h>
+#include <net/if.h>
+#include <netinet/in.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace livox {
+namespace lidar {
+
+#ifdef HAVE_AF_XDP
+
+static const uint32_t kXdpFrameSize = 2048;
+static const uint32_t kXdpFrameNum = 2048;
+static const uint32_t kXdpRingSize = 2048;       /* power of two, holds every frame. */
+static const uint32_t kXdpMaxQueueNum = 64;
+static const int32_t kXdpHeaderLen = ETH_HLEN + 20 + 8;  /* ethernet, ipv4 without options, udp. */
+
+static struct bpf_insn BpfInsn(uint8_t code, uint8_t dst, uint8_t src, int16_t off, int32_t imm) {
+  struct bpf_insn insn;
+  memset(&insn, 0, sizeof(insn));
+  insn.code = code;
+  insn.dst_reg = dst;
+  insn.src_reg = src;
+  insn.off = off;
+  insn.imm = imm;
+  return insn;
+}
+
+static int Bpf(int cmd, union bpf_attr* attr) {
+  return static_cast<int>(syscall(__NR_bpf, cmd, attr, sizeof(*attr)));
+}
+
+static uint32_t CountRxQueues(int if_index) {
+  char if_name[IF_NAMESIZE] = {0};
+  if (if_indextoname(if_index, if_name) == nullptr) {
+    return 0;
+  }
+  std::string path = std::string("/sys/class/net/") + if_name + "/queues";
+  DIR* dir = opendir(path.c_str());
+  if (dir == nullptr) {
+    return 0;
+  }
+  uint32_t num = 0;
+  for (struct dirent* entry = readdir(dir); entry != nullptr; entry = readdir(dir)) {
+    if (strncmp(entry->d_name, "rx-", 3) == 0) {
+      ++num;
+    }
+  }
+  closedir(dir);
+  return num;
+}
+
+XdpSocket::XdpSocket()
+    : rx_queue_num_(0),
+      xsk_fd_(-1),
+      map_fd_(-1),
+      prog_fd_(-1),
+      link_fd_(-1),
+      umem_(nullptr),
+      umem_size_(0) {
+  memset(&rx_ring_, 0, sizeof(rx_ring_));
+  memset(&fill_ring_, 0, sizeof(fill_ring_));
+  memset(&completion_ring_, 0, sizeof(completion_ring_));
+}
+
+XdpSocket::~XdpSocket() {
+  Close();
+}
+
+bool XdpSocket::HasPort(uint16_t port) const {
+  return std::find(ports_.begin(), ports_.end(), port) != ports_.end();
+}
+
+bool XdpSocket::Open(const std::string& host_ip, uint32_t queue_id, const std::vector<uint16_t>& ports) {
+  int if_index = 0;
+  if (ports.empty() || queue_id >= kXdpMaxQueueNum || !util::GetInterfaceIndex(host_ip, if_index)) {
+    return false;
+  }
+  ports_ = ports;
+  rx_queue_num_ = CountRxQueues(if_index);
+
+  xsk_fd_ = socket(AF_XDP, SOCK_RAW, 0);
+  if (xsk_fd_ < 0 || !SetupUmem()) {
+    Close();
+    return false;
+  }
+
+  struct sockaddr_xdp addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sxdp_family = AF_XDP;
+  addr.sxdp_flags = XDP_COPY;
+  addr.sxdp_ifindex = if_index;
+  addr.sxdp_queue_id = queue_id;
+  if (bind(xsk_fd_, (struct sockaddr*)&addr, sizeof(addr)) != 0 || !LoadProgram()) {
+    Close();
+    return false;
+  }
+
+  union bpf_attr attr;
+  memset(&attr, 0, sizeof(attr));
+  attr.map_fd = map_fd_;
+  attr.key = reinterpret_cast<uint64_t>(&queue_id);
+  attr.value = reinterpret_cast<uint64_t>(&xsk_fd_);
+  attr.flags = BPF_ANY;
+  if (Bpf(BPF_MAP_UPDATE_ELEM, &attr) != 0) {
+    Close();
+    return false;
+  }
+
+  // The link detaches the program from the interface when it is closed.
+  memset(&attr, 0, sizeof(attr));
+  attr.link_create.prog_fd = prog_fd_;
+  attr.link_create.target_ifindex = if_index;
+  attr.link_create.attach_type = BPF_XDP;
+  attr.link_create.flags = XDP_FLAGS_SKB_MODE;
+  link_fd_ = Bpf(BPF_LINK_CREATE, &attr);
+  if (link_fd_ < 0) {
+    Close();
+    return false;
+  }
+  return true;
+}
+
+bool XdpSocket::SetupUmem() {
+  umem_size_ = static_cast<size_t>(kXdpFrameSize) * kXdpFrameNum;
+  void* umem = mmap(nullptr, umem_size_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_POPULATE, -1, 0);
+  if (umem == MAP_FAILED) {
+    return false;
+  }
+  umem_ = static_cast<uint8_t*>(umem);
+
+  struct xdp_umem_reg reg;
+  memset(&reg, 0, sizeof(reg));
+  reg.addr = reinterpret_cast<uint64_t>(umem_);
+  reg.len = umem_size_;
+  reg.chunk_size = kXdpFrameSize;
+  reg.headroom = 0;
+  if (setsockopt(xsk_fd_, SOL_XDP, XDP_UMEM_REG, &reg, sizeof(reg)) != 0) {
+    return false;
+  }
+
+  int ring_size = kXdpRingSize;
+  if (setsockopt(xsk_fd_, SOL_XDP, XDP_UMEM_FILL_RING, &ring_size, sizeof(ring_size)) != 0 ||
+      setsockopt(xsk_fd_, SOL_XDP, XDP_UMEM_COMPLETION_RING, &ring_size, sizeof(ring_size)) != 0 ||
+      setsockopt(xsk_fd_, SOL_XDP, XDP_RX_RING, &ring_size, sizeof(ring_size)) != 0) {
+    return false;
+  }
+
+  struct xdp_mmap_offsets off;
+  socklen_t off_len = sizeof(off);
+  if (getsockopt(xsk_fd_, SOL_XDP, XDP_MMAP_OFFSETS, &off, &off_len) != 0) {
+    return false;
+  }
+  if (!MapRing(rx_ring_, sizeof(struct xdp_desc), off.rx.desc, XDP_PGOFF_RX_RING, off.rx.producer,
+               off.rx.consumer) ||
+      !MapRing(fill_ring_, sizeof(uint64_t), off.fr.desc, XDP_UMEM_PGOFF_FILL_RING, off.fr.producer,
+               off.fr.consumer) ||
+      !MapRing(completion_ring_, sizeof(uint64_t), off.cr.desc, XDP_UMEM_PGOFF_COMPLETION_RING, off.cr.producer,
+               off.cr.consumer)) {
+    return false;
+  }
+
+  // Hand every frame to the kernel up front.
+  uint64_t* fill = static_cast<uint64_t*>(fill_ring_.desc);
+  for (uint32_t i = 0; i < kXdpFrameNum; ++i) {
+    fill[i & fill_ring_.mask] = static_cast<uint64_t>(i) * kXdpFrameSize;
+  }
+  __atomic_store_n(fill_ring_.producer, kXdpFrameNum, __ATOMIC_RELEASE);
+  return true;
+}
+
+bool XdpSocket::MapRing(XdpRing& ring, size_t desc_size, uint64_t offset, uint64_t pgoff, uint64_t producer,
+                        uint64_t consumer) {
+  ring.map_size = offset + kXdpRingSize * desc_size;
+  void* map = mmap(nullptr, ring.map_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, xsk_fd_, pgoff);
+  if (map == MAP_FAILED) {
+    ring.map = nullptr;
+    return false;
+  }
+  ring.map = map;
+  ring.producer = reinterpret_cast<uint32_t*>(static_cast<uint8_t*>(map) + producer);
+  ring.consumer = reinterpret_cast<uint32_t*>(static_cast<uint8_t*>(map) + consumer);
+  ring.desc = static_cast<uint8_t*>(map) + offset;
+  ring.mask = kXdpRingSize - 1;
+  return true;
+}
+
+void XdpSocket::UnmapRing(XdpRing& ring) {
+  if (ring.map != nullptr) {
+    munmap(ring.map, ring.map_size);
+  }
+  memset(&ring, 0, sizeof(ring));
+}
+
+bool XdpSocket::LoadProgram() {
+  union bpf_attr attr;
+  memset(&attr, 0, sizeof(attr));
+  attr.map_type = BPF_MAP_TYPE_XSKMAP;
+  attr.key_size = sizeof(uint32_t);
+  attr.value_size = sizeof(uint32_t);
+  attr.max_entries = kXdpMaxQueueNum;
+  map_fd_ = Bpf(BPF_MAP_CREATE, &attr);
+  if (map_fd_ < 0) {
+    return false;
+  }
+
+  // Redirect unfragmented ipv4/udp to the listened ports, pass everything else. Packets of queues
+  // without a bound socket are passed as well.
+  std::vector<struct bpf_insn> insns;
+  std::vector<size_t> jumps_to_pass;
+  std::vector<size_t> jumps_to_redirect;
+  insns.push_back(BpfInsn(BPF_ALU64 | BPF_MOV | BPF_X, BPF_REG_6, BPF_REG_1, 0, 0));   // r6 = ctx
+  insns.push_back(BpfInsn(BPF_LDX | BPF_MEM | BPF_W, BPF_REG_2, BPF_REG_1, 0, 0));     // r2 = data
+  insns.push_back(BpfInsn(BPF_LDX | BPF_MEM | BPF_W, BPF_REG_3, BPF_REG_1, 4, 0));     // r3 = data_end
+  insns.push_back(BpfInsn(BPF_ALU64 | BPF_MOV | BPF_X, BPF_REG_4, BPF_REG_2, 0, 0));
+  insns.push_back(BpfInsn(BPF_ALU64 | BPF_ADD | BPF_K, BPF_REG_4, 0, 0, kXdpHeaderLen));
+  jumps_to_pass.push_back(insns.size());
+  insns.push_back(BpfInsn(BPF_JMP | BPF_JGT | BPF_X, BPF_REG_4, BPF_REG_3, 0, 0));
+  insns.push_back(BpfInsn(BPF_LDX | BPF_MEM | BPF_H, BPF_REG_5, BPF_REG_2, 12, 0));    // ether type
+  jumps_to_pass.push_back(insns.size());
+  insns.push_back(BpfInsn(BPF_JMP | BPF_JNE | BPF_K, BPF_REG_5, 0, 0, htons(ETH_P_IP)));
+  insns.push_back(BpfInsn(BPF_LDX | BPF_MEM | BPF_B, BPF_REG_5, BPF_REG_2, ETH_HLEN, 0));  // version, ihl
+  jumps_to_pass.push_back(insns.size());
+  insns.push_back(BpfInsn(BPF_JMP | BPF_JNE | BPF_K, BPF_REG_5, 0, 0, 0x45));
+  insns.push_back(BpfInsn(BPF_LDX | BPF_MEM | BPF_B, BPF_REG_5, BPF_REG_2, ETH_HLEN + 9, 0));  // protocol
+  jumps_to_pass.push_back(insns.size());
+  insns.push_back(BpfInsn(BPF_JMP | BPF_JNE | BPF_K, BPF_REG_5, 0, 0, IPPROTO_UDP));
+  insns.push_back(BpfInsn(BPF_LDX | BPF_MEM | BPF_H, BPF_REG_5, BPF_REG_2, ETH_HLEN + 6, 0));  // fragment
+  insns.push_back(BpfInsn(BPF_ALU64 | BPF_AND | BPF_K, BPF_REG_5, 0, 0, htons(0x3fff)));
+  jumps_to_pass.push_back(insns.size());
+  insns.push_back(BpfInsn(BPF_JMP | BPF_JNE | BPF_K, BPF_REG_5, 0, 0, 0));
+  insns.push_back(BpfInsn(BPF_LDX | BPF_MEM | BPF_H, BPF_REG_5, BPF_REG_2, ETH_HLEN + 20 + 2, 0));  // dst port
+  for (uint16_t port : ports_) {
+    jumps_to_redirect.push_back(insns.size());
+    insns.push_back(BpfInsn(BPF_JMP | BPF_JEQ | BPF_K, BPF_REG_5, 0, 0, htons(port)));
+  }
+  jumps_to_pass.push_back(insns.size());
+  insns.push_back(BpfInsn(BPF_JMP | BPF_JA, 0, 0, 0, 0));
+
+  size_t redirect = insns.size();
+  insns.push_back(BpfInsn(BPF_LDX | BPF_MEM | BPF_W, BPF_REG_2, BPF_REG_6, 16, 0));    // r2 = rx_queue_index
+  insns.push_back(BpfInsn(BPF_LD | BPF_DW | BPF_IMM, BPF_REG_1, BPF_PSEUDO_MAP_FD, 0, map_fd_));
+  insns.push_back(BpfInsn(0, 0, 0, 0, 0));
+  insns.push_back(BpfInsn(BPF_ALU64 | BPF_MOV | BPF_K, BPF_REG_3, 0, 0, XDP_PASS));    // fallback action
+  insns.push_back(BpfInsn(BPF_JMP | BPF_CALL, 0, 0, 0, BPF_FUNC_redirect_map));
+  insns.push_back(BpfInsn(BPF_JMP | BPF_EXIT, 0, 0, 0, 0));
+
+  size_t pass = insns.size();
+  insns.push_back(BpfInsn(BPF_ALU64 | BPF_MOV | BPF_K, BPF_REG_0, 0, 0, XDP_PASS));
+  insns.push_back(BpfInsn(BPF_JMP | BPF_EXIT, 0, 0, 0, 0));
+
+  for (size_t i : jumps_to_pass) {
+    insns[i].off = static_cast<int16_t>(pass - i - 1);
+  }
+  for (size_t i : jumps_to_redirect) {
+    insns[i].off = static_cast<int16_t>(redirect - i - 1);
+  }
+
+  static const char kLicense[] = "Dual MIT/GPL";
+  memset(&attr, 0, sizeof(attr));
+  attr.prog_type = BPF_PROG_TYPE_XDP;
+  attr.insn_cnt = static_cast<uint32_t>(insns.size());
+  attr.insns = reinterpret_cast<uint64_t>(insns.data());
+  attr.license = reinterpret_cast<uint64_t>(kLicense);
+  attr.expected_attach_type = BPF_XDP;
+  prog_fd_ = Bpf(BPF_PROG_LOAD, &attr);
+  return prog_fd_ >= 0;
+}
+
+void XdpSocket::Close() {
+  int* fds[] = { &link_fd_, &xsk_fd_, &prog_fd_, &map_fd_ };
+  for (int* fd : fds) {
+    if (*fd >= 0) {
+      close(*fd);
+      *fd = -1;
+    }
+  }
+  UnmapRing(rx_ring_);
+  UnmapRing(fill_ring_);
+  UnmapRing(completion_ring_);
+  if (umem_ != nullptr) {
+    munmap(umem_, umem_size_);
+    umem_ = nullptr;
+  }
+}
+
+uint32_t XdpSocket::Read(const PacketCallback& callback) {
+  uint32_t count = 0;
+  if (rx_ring_.map == nullptr) {
+    return count;
+  }
+  const struct xdp_desc* descs = static_cast<const struct xdp_desc*>(rx_ring_.desc);
+  uint64_t* fill = static_cast<uint64_t*>(fill_ring_.desc);
+  uint32_t consumer = *rx_ring_.consumer;
+  uint32_t producer = __atomic_load_n(rx_ring_.producer, __ATOMIC_ACQUIRE);
+  uint32_t fill_producer = *fill_ring_.producer;
+  for (; consumer != producer; ++consumer) {
+    const struct xdp_desc& desc = descs[consumer & rx_ring_.mask];
+    if (desc.len > ETH_HLEN && DeliverUdp(umem_ + desc.addr + ETH_HLEN, desc.len - ETH_HLEN, 0, callback)) {
+      ++count;
+    }
+    fill[fill_producer++ & fill_ring_.mask] = desc.addr;
+  }
+  __atomic_store_n(rx_ring_.consumer, consumer, __ATOMIC_RELEASE);
+  __atomic_store_n(fill_ring_.producer, fill_producer, __ATOMIC_RELEASE);
+  return count;
+}
+
+#else
+
+XdpSocket::XdpSocket()
+    : rx_queue_num_(0), xsk_fd_(-1), map_fd_(-1), prog_fd_(-1), link_fd_(-1), umem_(nullptr), umem_size_(0),
+      rx_ring_(), fill_ring_(), completion_ring_() {}
+
+XdpSocket::~XdpSocket() {}
+
+bool XdpSocket::Open(const std::string&, uint32_t, const std::vector<uint16_t>&) {
+  return false;
+}
+
+void XdpSocket::Close() {}
+
+bool XdpSocket::HasPort(uint16_t port) const {
+  return std::find(ports_.begin(), ports_.end(), port) != ports_.end();
+}
+
+uint32_t XdpSocket::Read(const PacketCallback&) {
+  return 0;
+}
+
+#endif  // HAVE_AF_XDP
+
+} // namespace lidar
+}  // namespace livox
@@ -0,0 +1,97 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2022 Livox. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+#ifndef LIVOX_XDP_SOCKET_H_
+#define LIVOX_XDP_SOCKET_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+#include <vector>
+#include "packet_capture.h"
+
+namespace livox {
+namespace lidar {
+
+/**
+ * AF_XDP receiver in generic (skb, copy) mode. An XDP program attached to the
+ * host interface redirects the ipv4/udp datagrams sent to the given ports into
+ * the socket bound on one rx queue, every other packet, including those of the
+ * other rx queues, goes on to the network stack. Payloads are delivered in place from the UMEM frames, which are then
+ * returned to the fill ring. Built when HAVE_AF_XDP is defined, Open fails
+ * otherwise.
+ */
+class XdpSocket : public PacketCapture {
+ public:
+  XdpSocket();
+  ~XdpSocket();
+
+  /**
+   * Attach the redirect program and bind the socket.
+   * @param host_ip   address of the capturing interface.
+   * @param queue_id  rx queue of the interface to bind.
+   * @param ports     destination udp ports to redirect.
+   */
+  bool Open(const std::string& host_ip, uint32_t queue_id, const std::vector<uint16_t>& ports);
+  void Close();
+  int GetFd() const { return xsk_fd_; }
+  bool HasPort(uint16_t port) const;
+  /** Rx queues of the interface found by Open, 0 if unknown. */
+  uint32_t GetRxQueueNum() const { return rx_queue_num_; }
+
+  /** Deliver every received frame, then return the frames to the fill ring. */
+  uint32_t Read(const PacketCallback& callback);
+
+ private:
+  typedef struct {
+    uint32_t* producer;
+    uint32_t* consumer;
+    void* desc;
+    uint32_t mask;
+    void* map;
+    size_t map_size;
+  } XdpRing;
+
+  bool LoadProgram();
+  bool SetupUmem();
+  bool MapRing(XdpRing& ring, size_t desc_size, uint64_t offset, uint64_t pgoff, uint64_t producer,
+               uint64_t consumer);
+  void UnmapRing(XdpRing& ring);
+
+  std::vector<uint16_t> ports_;
+  uint32_t rx_queue_num_;
+  int xsk_fd_;
+  int map_fd_;
+  int prog_fd_;
+  int link_fd_;
+  uint8_t* umem_;
+  size_t umem_size_;
+  XdpRing rx_ring_;
+  XdpRing fill_ring_;
+  XdpRing completion_ring_;
+};
+
+} // namespace lidar
+}  // namespace livox
+
+#endif  // LIVOX_XDP_SOCKET_H_
@@ -0,0 +1,164 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2022 Livox. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifndef LIVOX_RCU_VALUE_H_
+#define LIVOX_RCU_VALUE_H_
+
+#include <atomic>
+#include <memory>
+#include <utility>
+#include <vector>
+#include "noncopyable.h"
+
+namespace livox {
+namespace lidar {
+
+/**
+ * Read sections of a fixed set of reader threads, each owning a slot whose sequence is odd while it reads
+ * published values. Readers past the last slot share one counter. A value unpublished before Snapshot may
+ * be freed once HasPassed, every reader that could hold it has left its section by then.
+ */
+class RcuReaders : public noncopyable {
+ public:
+  typedef std::vector<uint64_t> Snapshot;
+
+  explicit RcuReaders(uint32_t slot_num) : slots_(new Slot[slot_num]), slot_num_(slot_num), untracked_(0) {
+    for (uint32_t i = 0; i < slot_num_; ++i) {
+      slots_[i].sequence.store(0, std::memory_order_relaxed);
+    }
+  }
+
+  /** Begin a read section of the thread owning slot, before loading any value. */
+  void Enter(uint32_t slot) {
+    if (slot < slot_num_) {
+      std::atomic<uint64_t>& sequence = slots_[slot].sequence;
+      sequence.store(sequence.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+      // Pairs with the fence of TakeSnapshot: either it sees the section or this loads the new value.
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+    } else {
+      untracked_.fetch_add(1, std::memory_order_seq_cst);
+    }
+  }
+
+  void Leave(uint32_t slot) {
+    if (slot < slot_num_) {
+      std::atomic<uint64_t>& sequence = slots_[slot].sequence;
+      sequence.store(sequence.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    } else {
+      untracked_.fetch_sub(1, std::memory_order_release);
+    }
+  }
+
+  /** The sections in progress, taken after a value is unpublished. */
+  Snapshot TakeSnapshot() const {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    Snapshot snapshot(slot_num_ + 1);
+    for (uint32_t i = 0; i < slot_num_; ++i) {
+      snapshot[i] = slots_[i].sequence.load(std::memory_order_acquire);
+    }
+    snapshot[slot_num_] = untracked_.load(std::memory_order_acquire);
+    return snapshot;
+  }
+
+  /**
+   * Whether every section of snapshot has ended. The untracked readers only count as done once none is
+   * left, a value unpublished while they are busy waits for a quiet moment.
+   */
+  bool HasPassed(const Snapshot& snapshot) const {
+    for (uint32_t i = 0; i < slot_num_; ++i) {
+      if (snapshot[i] % 2 != 0 && slots_[i].sequence.load(std::memory_order_acquire) == snapshot[i]) {
+        return false;
+      }
+    }
+    return snapshot[slot_num_] == 0 || untracked_.load(std::memory_order_acquire) == 0;
+  }
+
+ private:
+  typedef struct {
+    std::atomic<uint64_t> sequence;
+    char pad[64 - sizeof(std::atomic<uint64_t>)];
+  } Slot;
+
+  std::unique_ptr<Slot[]> slots_;
+  uint32_t slot_num_;
+  std::atomic<uint32_t> untracked_;
+};
+
+/** Read section of the thread owning slot for the lifetime of the scope. */
+class RcuReadScope : public noncopyable {
+ public:
+  RcuReadScope(RcuReaders& readers, uint32_t slot) : readers_(readers), slot_(slot) { readers_.Enter(slot_); }
+  ~RcuReadScope() { readers_.Leave(slot_); }
+
+ private:
+  RcuReaders& readers_;
+  uint32_t slot_;
+};
+
+/**
+ * Value read wait free and replaced by copy on write. A replaced value is retired and freed by a later
+ * Store once the readers that may still use it have left their sections, which suits values changed
+ * rarely compared to how often they are read.
+ */
+template <typename T>
+class RcuValue : public noncopyable {
+ public:
+  explicit RcuValue(const RcuReaders& readers) : readers_(readers), current_(nullptr) {}
+
+  /** Inside a read section of readers, nullptr until a value is published. */
+  const T* Load() const { return current_.load(std::memory_order_acquire); }
+
+  /** Publish value and free the retired values no reader can hold any more, writers are serialized by the caller. */
+  void Store(std::unique_ptr<T> value) {
+    current_.store(value.get(), std::memory_order_release);
+    std::unique_ptr<T> previous = std::move(owned_);
+    owned_ = std::move(value);
+    if (previous) {
+      retired_.push_back(Retired(std::move(previous), readers_.TakeSnapshot()));
+    }
+    for (auto it = retired_.begin(); it != retired_.end();) {
+      it = readers_.HasPassed(it->second) ? retired_.erase(it) : it + 1;
+    }
+  }
+
+  /** Free every value, no reader may be running. Writers are serialized by the caller. */
+  void Clear() {
+    current_.store(nullptr, std::memory_order_release);
+    owned_.reset();
+    retired_.clear();
+  }
+
+ private:
+  typedef std::pair<std::unique_ptr<T>, RcuReaders::Snapshot> Retired;
+
+  const RcuReaders& readers_;
+  std::atomic<const T*> current_;
+  std::unique_ptr<T> owned_;
+  std::vector<Retired> retired_;
+};
+
+} // namespace lidar
+}  // namespace livox
+
+#endif  // LIVOX_RCU_VALUE_H_
@@ -0,0 +1,54 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2022 Livox. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#include "recv_buffer_pool.h"
+
+namespace livox {
+namespace lidar {
+
+bool RecvBufferPool::Init(size_t buffer_size, size_t buffer_num) {
+  if (buffer_size == 0 || buffer_num == 0) {
+    return false;
+  }
+  if (buffer_size == buffer_size_ && buffer_num == msgs_.size()) {
+    return true;
+  }
+
+  buffer_size_ = buffer_size;
+  // Zeroed so that the pages are faulted in now rather than by the first packets.
+  slab_.reset(new uint8_t[buffer_size * buffer_num]());
+  msgs_.resize(buffer_num);
+  for (size_t i = 0; i < buffer_num; ++i) {
+    msgs_[i].buf = GetBuffer(i);
+    msgs_[i].buf_size = buffer_size;
+    msgs_[i].size = 0;
+    msgs_[i].timestamp = 0;
+    msgs_[i].gso_size = 0;
+    msgs_[i].drops = 0;
+  }
+  return true;
+}
+
+} // namespace lidar
+}  // namespace livox
@@ -0,0 +1,60 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2022 Livox. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifndef LIVOX_RECV_BUFFER_POOL_H_
+#define LIVOX_RECV_BUFFER_POOL_H_
+
+#include <stdint.h>
+#include <memory>
+#include <vector>
+#include "noncopyable.h"
+#include "network/network_util.h"
+
+namespace livox {
+namespace lidar {
+
+/**
+ * Pre-sized receive buffers owned by one io loop. All buffers live in a single
+ * slab allocated at Init, so receiving datagrams never touches the heap. The
+ * buffers are exposed as a RecvMsg array to be filled by util::RecvBatchFrom.
+ */
+class RecvBufferPool : public noncopyable {
+ public:
+  RecvBufferPool() : buffer_size_(0) {}
+  bool Init(size_t buffer_size, size_t buffer_num);
+  size_t GetBufferSize() const { return buffer_size_; }
+  size_t GetBufferNum() const { return msgs_.size(); }
+  uint8_t* GetBuffer(size_t index) { return slab_.get() + index * buffer_size_; }
+  util::RecvMsg* GetRecvMsgs() { return msgs_.data(); }
+
+ private:
+  size_t buffer_size_;
+  std::unique_ptr<uint8_t[]> slab_;
+  std::vector<util::RecvMsg> msgs_;
+};
+
+} // namespace lidar
+}  // namespace livox
+
+#endif  // LIVOX_RECV_BUFFER_POOL_H_
@@ -0,0 +1,242 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2022 Livox. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#include "rt_guard.h"
+
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+#ifdef WIN32
+#include <malloc.h>
+#else
+#include <sys/mman.h>
+#endif
+
+#include "logging.h"
+
+namespace livox {
+namespace lidar {
+
+bool LockProcessMemory() {
+#ifdef WIN32
+  LOG_WARN("Lock process memory is not supported on this platform");
+  return false;
+#else
+  if (mlockall(MCL_CURRENT | MCL_FUTURE) != 0) {
+    LOG_WARN("Lock process memory failed, errno {}, it needs CAP_IPC_LOCK or a memlock limit", errno);
+    return false;
+  }
+  return true;
+#endif
+}
+
+namespace {
+
+std::atomic<bool> tripwire_armed(false);
+std::atomic<bool> tripwire_abort(false);
+std::atomic<uint64_t> tripwire_count(0);
+#ifdef LIVOX_RT_ALLOC_TRIPWIRE
+// Plain data, operator new may run before any constructor of the thread.
+thread_local bool in_data_path = false;
+#endif
+
+} // namespace
+
+#ifdef LIVOX_RT_ALLOC_TRIPWIRE
+bool RtAllocTripwire::IsAvailable() {
+  return true;
+}
+
+bool RtAllocTripwire::Enter() {
+  bool previous = in_data_path;
+  in_data_path = true;
+  return previous;
+}
+
+void RtAllocTripwire::Leave(bool previous) {
+  in_data_path = previous;
+}
+
+void RtAllocTripwire::OnAllocation() {
+  if (!in_data_path || !tripwire_armed.load(std::memory_order_relaxed)) {
+    return;
+  }
+  tripwire_count.fetch_add(1, std::memory_order_relaxed);
+  if (tripwire_abort.load(std::memory_order_relaxed)) {
+    // Logging would allocate again.
+    std::fputs("livox sdk: heap allocation on the real time data path\n", stderr);
+    std::abort();
+  }
+}
+#else
+bool RtAllocTripwire::IsAvailable() {
+  return false;
+}
+
+bool RtAllocTripwire::Enter() {
+  return false;
+}
+
+void RtAllocTripwire::Leave(bool) {}
+
+void RtAllocTripwire::OnAllocation() {}
+#endif  // LIVOX_RT_ALLOC_TRIPWIRE
+
+void RtAllocTripwire::Arm(bool abort_on_alloc) {
+  tripwire_abort.store(abort_on_alloc, std::memory_order_relaxed);
+  tripwire_armed.store(true, std::memory_order_release);
+}
+
+void RtAllocTripwire::Disarm() {
+  tripwire_armed.store(false, std::memory_order_release);
+}
+
+uint64_t RtAllocTripwire::GetCount() {
+  return tripwire_count.load(std::memory_order_relaxed);
+}
+
+} // namespace lidar
+}  // namespace livox
+
+#ifdef LIVOX_RT_ALLOC_TRIPWIRE
+// The replacements below pair malloc and free on purpose, gcc cannot see that new and delete are both replaced.
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 11
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+void* operator new(std::size_t size) {
+  livox::lidar::RtAllocTripwire::OnAllocation();
+  void* ptr = std::malloc(size != 0 ? size : 1);
+  if (ptr == nullptr) {
+    throw std::bad_alloc();
+  }
+  return ptr;
+}
+
+void* operator new[](std::size_t size) {
+  return operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+  livox::lidar::RtAllocTripwire::OnAllocation();
+  return std::malloc(size != 0 ? size : 1);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t& tag) noexcept {
+  return operator new(size, tag);
+}
+
+void operator delete(void* ptr) noexcept {
+  std::free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+  std::free(ptr);
+}
+
+void operator delete(void* ptr, const std::nothrow_t&) noexcept {
+  std::free(ptr);
+}
+
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept {
+  std::free(ptr);
+}
+
+#if defined(__cpp_sized_deallocation)
+void operator delete(void* ptr, std::size_t) noexcept {
+  std::free(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t) noexcept {
+  std::free(ptr);
+}
+#endif  // __cpp_sized_deallocation
+
+#if defined(__cpp_aligned_new)
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+  livox::lidar::RtAllocTripwire::OnAllocation();
+  std::size_t align = static_cast<std::size_t>(alignment);
+  align = align < sizeof(void*) ? sizeof(void*) : align;
+  size = size != 0 ? size : 1;
+#ifdef WIN32
+  return _aligned_malloc(size, align);
+#else
+  void* ptr = nullptr;
+  return posix_memalign(&ptr, align, size) == 0 ? ptr : nullptr;
+#endif
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+  void* ptr = operator new(size, alignment, std::nothrow);
+  if (ptr == nullptr) {
+    throw std::bad_alloc();
+  }
+  return ptr;
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment) {
+  return operator new(size, alignment);
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t& tag) noexcept {
+  return operator new(size, alignment, tag);
+}
+
+void operator delete(void* ptr, std::align_val_t) noexcept {
+#ifdef WIN32
+  _aligned_free(ptr);
+#else
+  std::free(ptr);
+#endif
+}
+
+void operator delete[](void* ptr, std::align_val_t alignment) noexcept {
+  operator delete(ptr, alignment);
+}
+
+void operator delete(void* ptr, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+  operator delete(ptr, alignment);
+}
+
+void operator delete[](void* ptr, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+  operator delete(ptr, alignment);
+}
+
+void operator delete(void* ptr, std::size_t, std::align_val_t alignment) noexcept {
+  operator delete(ptr, alignment);
+}
+
+void operator delete[](void* ptr, std::size_t, std::align_val_t alignment) noexcept {
+  operator delete(ptr, alignment);
+}
+#endif  // __cpp_aligned_new
+
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 11
+#pragma GCC diagnostic pop
+#endif
+#endif  // LIVOX_RT_ALLOC_TRIPWIRE
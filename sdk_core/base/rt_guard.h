@@ -0,0 +1,73 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2022 Livox. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifndef LIVOX_RT_GUARD_H_
+#define LIVOX_RT_GUARD_H_
+
+#include <stdint.h>
+
+namespace livox {
+namespace lidar {
+
+/** Lock the current and future pages of the process in memory, return false if the system refuses. */
+bool LockProcessMemory();
+
+/**
+ * Watches the heap allocations of the real time data path. They are only seen when the sdk is built
+ * with LIVOX_RT_ALLOC_TRIPWIRE, which replaces the global operator new, and counted while the tripwire
+ * is armed and the allocating thread is inside a Scope.
+ */
+class RtAllocTripwire {
+ public:
+  /** Marks the calling thread as running the data path for its lifetime. */
+  class Scope {
+   public:
+#ifdef LIVOX_RT_ALLOC_TRIPWIRE
+    Scope() : previous_(Enter()) {}
+    ~Scope() { Leave(previous_); }
+   private:
+    bool previous_;
+#else
+    Scope() {}
+#endif
+  };
+
+  static bool IsAvailable();
+  /** Count the allocations from now on, abort the process on the first one with abort_on_alloc. */
+  static void Arm(bool abort_on_alloc);
+  static void Disarm();
+  /** Allocations counted since the process started. */
+  static uint64_t GetCount();
+  /** Called by operator new. */
+  static void OnAllocation();
+
+ private:
+  static bool Enter();
+  static void Leave(bool previous);
+};
+
+} // namespace lidar
+}  // namespace livox
+
+#endif  // LIVOX_RT_GUARD_H_
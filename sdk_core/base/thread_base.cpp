@@ -26,19 +26,112 @@
 #include <thread>
 #include <iostream>
 #include <memory>
+#include <limits>
+#ifdef WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <sched.h>
+#endif
+#include "logging.h"
 
 namespace livox {
 namespace lidar {
 
 
+static thread_local void* thread_context = nullptr;
+
 ThreadBase::ThreadBase() : quit_(false) {}
 
+void* ThreadBase::GetThreadContext() {
+  return thread_context;
+}
+
+void* ThreadBase::SetThreadContext(void* context) {
+  void* previous = thread_context;
+  thread_context = context;
+  return previous;
+}
+
+std::shared_ptr<std::thread> ThreadBase::CreateThread(const std::function<void()>& func) {
+  void* context = thread_context;
+  return std::make_shared<std::thread>([context, func]() {
+    thread_context = context;
+    func();
+  });
+}
+
 bool ThreadBase::Start() {
   quit_ = false;
-  thread_ = std::make_shared<std::thread>(&ThreadBase::ThreadFunc, this);
+  thread_ = CreateThread([this]() { ThreadFunc(); });
+  ApplySchedule(*thread_, schedule_);
   return true;
 }
 
+int ThreadBase::MaxCpuNum() {
+#ifdef WIN32
+  return static_cast<int>(sizeof(DWORD_PTR) * 8);
+#elif defined(CPU_SETSIZE)
+  return CPU_SETSIZE;
+#else
+  // Affinity is ignored on this platform, any index is harmless.
+  return std::numeric_limits<int>::max();
+#endif
+}
+
+void ThreadBase::ApplySchedule(std::thread& thread, const ThreadSchedule& schedule) {
+#ifdef WIN32
+  if (schedule.policy != kSchedPolicyOther &&
+      !SetThreadPriority(thread.native_handle(), THREAD_PRIORITY_TIME_CRITICAL)) {
+    LOG_WARN("Set priority of thread {} failed, error {}", schedule.name.c_str(), GetLastError());
+  }
+  DWORD_PTR mask = 0;
+  for (int cpu : schedule.cpus) {
+    if (cpu >= 0 && cpu < MaxCpuNum()) {
+      mask |= static_cast<DWORD_PTR>(1) << cpu;
+    }
+  }
+  if (mask != 0 && SetThreadAffinityMask(thread.native_handle(), mask) == 0) {
+    LOG_WARN("Set affinity of thread {} failed, error {}", schedule.name.c_str(), GetLastError());
+  }
+#else
+  if (schedule.policy != kSchedPolicyOther) {
+    struct sched_param param;
+    param.sched_priority = schedule.priority;
+    int policy = (schedule.policy == kSchedPolicyRr) ? SCHED_RR : SCHED_FIFO;
+    int ret = pthread_setschedparam(thread.native_handle(), policy, &param);
+    if (ret != 0) {
+      LOG_WARN("Set priority {} of thread {} failed, error {}, it needs CAP_SYS_NICE or an rtprio limit",
+               schedule.priority, schedule.name.c_str(), ret);
+    }
+  }
+#ifdef __linux__
+  if (!schedule.name.empty()) {
+    pthread_setname_np(thread.native_handle(), schedule.name.substr(0, 15).c_str());
+  }
+  if (!schedule.cpus.empty()) {
+    cpu_set_t cpu_set;
+    CPU_ZERO(&cpu_set);
+    for (int cpu : schedule.cpus) {
+      if (cpu >= 0 && cpu < MaxCpuNum()) {
+        CPU_SET(cpu, &cpu_set);
+      }
+    }
+    int ret = pthread_setaffinity_np(thread.native_handle(), sizeof(cpu_set), &cpu_set);
+    if (ret != 0) {
+      LOG_WARN("Set affinity of thread {} to {} cpus from cpu {} failed, error {}", schedule.name.c_str(),
+               schedule.cpus.size(), schedule.cpus[0], ret);
+    }
+  }
+#else
+  if (!schedule.cpus.empty()) {
+    LOG_WARN("Thread affinity is not supported on this platform, the cpus of thread {} are ignored",
+             schedule.name.c_str());
+  }
+#endif
+#endif
+}
+
 ThreadBase::~ThreadBase() {
   if (thread_) {
     Join();
@@ -47,7 +140,10 @@ ThreadBase::~ThreadBase() {
 
 void ThreadBase::Join() {
   quit_ = true;
-  if (thread_ && thread_->joinable()) {
+  if (!thread_) {
+    return;
+  }
+  if (thread_->joinable()) {
     thread_->join();
     thread_ = nullptr;
   } else {
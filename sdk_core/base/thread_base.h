@@ -25,13 +25,30 @@
 #ifndef LIVOX_THREAD_BASE_H_
 #define LIVOX_THREAD_BASE_H_
 #include <atomic>
+#include <functional>
 #include <thread>
 #include <memory>
+#include <string>
+#include <vector>
 #include "noncopyable.h"
 
 namespace livox {
 namespace lidar {
 
+typedef enum {
+  kSchedPolicyOther = 0,  /**< default time sharing policy. */
+  kSchedPolicyFifo,       /**< SCHED_FIFO. */
+  kSchedPolicyRr          /**< SCHED_RR. */
+} SchedPolicy;
+
+/** Name, scheduling class and cpus of a thread. */
+typedef struct {
+  std::string name;                      /**< thread name, the system keeps the first 15 characters. */
+  std::vector<int> cpus;                 /**< cpus the thread may run on, empty for all. */
+  SchedPolicy policy = kSchedPolicyOther;
+  int priority = 0;                      /**< priority of kSchedPolicyFifo and kSchedPolicyRr, 1 to 99. */
+} ThreadSchedule;
+
 class ThreadBase : public noncopyable {
  public:
   ThreadBase();
@@ -39,6 +56,26 @@ class ThreadBase : public noncopyable {
   virtual void ThreadFunc() = 0;
   bool Start();
   bool IsQuit() { return quit_; }
+  /** Schedule applied by Start, call it before. */
+  void SetSchedule(const ThreadSchedule& schedule) { schedule_ = schedule; }
+  /**
+   * Name the thread, set its scheduling class and restrict it to the cpus of schedule. Every
+   * setting the system refuses is logged and left unchanged.
+   */
+  static void ApplySchedule(std::thread& thread, const ThreadSchedule& schedule);
+  /** Number of cpus an affinity of ApplySchedule can name, the valid cpu indexes are below it. */
+  static int MaxCpuNum();
+
+  /**
+   * Start a thread running func with the context of the calling thread, for the sdk threads not
+   * derived from ThreadBase.
+   */
+  static std::shared_ptr<std::thread> CreateThread(const std::function<void()>& func);
+
+  /** Opaque context of the calling thread, threads started by Start inherit the context of their starter. */
+  static void* GetThreadContext();
+  /** Replace the context of the calling thread, return the previous one. */
+  static void* SetThreadContext(void* context);
 
  protected:
   void Join();
@@ -46,6 +83,7 @@ class ThreadBase : public noncopyable {
  private:
   std::atomic_bool quit_;
   std::shared_ptr<std::thread> thread_;
+  ThreadSchedule schedule_;
 };
 
 } //namespace lidar
@@ -0,0 +1,219 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2022 Livox. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#include "timer_wheel.h"
+#include <string.h>
+#include <algorithm>
+#include <utility>
+
+namespace livox {
+namespace lidar {
+
+TimerWheel::TimerWheel(uint32_t tick_ms)
+    : tick_(tick_ms > 0 ? tick_ms : static_cast<uint32_t>(kTimerTickMs)),
+      start_(std::chrono::steady_clock::now()),
+      current_tick_(0),
+      armed_num_(0),
+      free_head_(kNil) {
+  for (uint32_t i = 0; i < kSlotNum; ++i) {
+    slots_[i] = kNil;
+  }
+  memset(occupied_, 0, sizeof(occupied_));
+}
+
+uint64_t TimerWheel::TickOf(TimePoint t) const {
+  if (t <= start_) {
+    return 0;
+  }
+  return static_cast<uint64_t>((t - start_) / tick_);
+}
+
+TimerId TimerWheel::Add(TimePoint now, uint32_t delay_ms, const TimerTask& task, uint32_t period_ms) {
+  if (!task) {
+    return kInvalidTimerId;
+  }
+  if (armed_num_ == 0) {
+    // Nothing to run in between, skip the idle ticks instead of walking them.
+    current_tick_ = std::max(current_tick_, TickOf(now));
+  }
+
+  int32_t index = free_head_;
+  if (index != kNil) {
+    free_head_ = nodes_[index].next;
+  } else {
+    index = static_cast<int32_t>(nodes_.size());
+    TimerNode node = {};
+    nodes_.push_back(node);
+  }
+  TimerNode& node = nodes_[index];
+  node.task = task;
+  uint64_t tick_ms = static_cast<uint64_t>(tick_.count());
+  node.period_ticks = static_cast<uint32_t>(period_ms == 0 ? 0 : std::max<uint64_t>((period_ms + tick_ms - 1) / tick_ms, 1));
+  // Round up, a timer never fires early.
+  uint64_t delay_ticks = std::max<uint64_t>((delay_ms + tick_ms - 1) / tick_ms, 1);
+  Link(index, std::max(current_tick_, TickOf(now)) + delay_ticks);
+  return (static_cast<uint64_t>(node.generation) << 32) | static_cast<uint32_t>(index + 1);
+}
+
+void TimerWheel::Link(int32_t index, uint64_t deadline_tick) {
+  TimerNode& node = nodes_[index];
+  if (deadline_tick <= current_tick_) {
+    deadline_tick = current_tick_ + 1;
+  }
+  node.slot = static_cast<uint32_t>(deadline_tick & kSlotMask);
+  node.rounds = static_cast<uint32_t>((deadline_tick - current_tick_ - 1) / kSlotNum);
+  node.prev = kNil;
+  node.next = slots_[node.slot];
+  if (node.next != kNil) {
+    nodes_[node.next].prev = index;
+  }
+  slots_[node.slot] = index;
+  occupied_[node.slot / 64] |= (1ULL << (node.slot % 64));
+  node.state = kTimerArmed;
+  ++armed_num_;
+}
+
+void TimerWheel::Unlink(int32_t index) {
+  TimerNode& node = nodes_[index];
+  if (node.prev != kNil) {
+    nodes_[node.prev].next = node.next;
+  } else {
+    slots_[node.slot] = node.next;
+    if (node.next == kNil) {
+      occupied_[node.slot / 64] &= ~(1ULL << (node.slot % 64));
+    }
+  }
+  if (node.next != kNil) {
+    nodes_[node.next].prev = node.prev;
+  }
+  --armed_num_;
+}
+
+void TimerWheel::Release(int32_t index) {
+  TimerNode& node = nodes_[index];
+  node.task = nullptr;
+  node.state = kTimerFree;
+  ++node.generation;
+  node.next = free_head_;
+  free_head_ = index;
+}
+
+int32_t TimerWheel::Lookup(TimerId id) const {
+  int64_t index = static_cast<int64_t>(id & 0xFFFFFFFFULL) - 1;
+  if (index < 0 || index >= static_cast<int64_t>(nodes_.size())) {
+    return kNil;
+  }
+  const TimerNode& node = nodes_[index];
+  if (node.state == kTimerFree || node.generation != static_cast<uint32_t>(id >> 32)) {
+    return kNil;
+  }
+  return static_cast<int32_t>(index);
+}
+
+void TimerWheel::Cancel(TimerId id) {
+  int32_t index = Lookup(id);
+  if (index == kNil) {
+    return;
+  }
+  if (nodes_[index].state == kTimerArmed) {
+    Unlink(index);
+    Release(index);
+  } else if (nodes_[index].state == kTimerFiring) {
+    nodes_[index].state = kTimerCancelled;
+  }
+}
+
+void TimerWheel::Advance(TimePoint now) {
+  if (armed_num_ == 0) {
+    return;
+  }
+  uint64_t target = TickOf(now);
+  while (current_tick_ < target && armed_num_ > 0) {
+    ++current_tick_;
+    uint32_t slot = static_cast<uint32_t>(current_tick_ & kSlotMask);
+    expired_.clear();
+    for (int32_t index = slots_[slot]; index != kNil;) {
+      TimerNode& node = nodes_[index];
+      int32_t next = node.next;
+      if (node.rounds > 0) {
+        --node.rounds;
+      } else {
+        Unlink(index);
+        node.state = kTimerFiring;
+        expired_.push_back(index);
+      }
+      index = next;
+    }
+
+    for (size_t i = 0; i < expired_.size(); ++i) {
+      int32_t index = expired_[i];
+      // The task may add timers and grow nodes_, run it from a local copy of the function.
+      TimerTask task = std::move(nodes_[index].task);
+      if (nodes_[index].state == kTimerFiring) {
+        task();
+      }
+      TimerNode& node = nodes_[index];
+      if (node.state == kTimerFiring && node.period_ticks > 0) {
+        node.task = std::move(task);
+        Link(index, current_tick_ + node.period_ticks);
+      } else {
+        Release(index);
+      }
+    }
+  }
+  if (armed_num_ == 0) {
+    current_tick_ = std::max(current_tick_, target);
+  }
+}
+
+int TimerWheel::NextTimeout(TimePoint now, int max_timeout) const {
+  if (armed_num_ == 0) {
+    return max_timeout;
+  }
+  // Find the first occupied slot after the current tick, wrapping around the wheel.
+  uint32_t start = static_cast<uint32_t>((current_tick_ + 1) & kSlotMask);
+  uint32_t distance = kSlotNum;
+  for (uint32_t i = 0; i < kSlotNum; ++i) {
+    uint32_t slot = (start + i) & kSlotMask;
+    uint64_t word = occupied_[slot / 64] >> (slot % 64);
+    if (word == 0) {
+      // Jump to the next word.
+      i += 63 - (slot % 64);
+      continue;
+    }
+    if (word & 1ULL) {
+      distance = i + 1;
+      break;
+    }
+  }
+  TimePoint deadline = start_ + tick_ * static_cast<int64_t>(current_tick_ + distance);
+  if (deadline <= now) {
+    return 0;
+  }
+  auto wait = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - now).count() + 1;
+  return static_cast<int>(std::min<int64_t>(wait, max_timeout));
+}
+
+} // namespace lidar
+}  // namespace livox
@@ -0,0 +1,106 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2022 Livox. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifndef LIVOX_TIMER_WHEEL_H_
+#define LIVOX_TIMER_WHEEL_H_
+
+#include <stdint.h>
+#include <chrono>
+#include <functional>
+#include <vector>
+#include "noncopyable.h"
+
+namespace livox {
+namespace lidar {
+
+typedef uint64_t TimerId;
+static const TimerId kInvalidTimerId = 0;
+static const uint32_t kTimerTickMs = 10;
+
+/**
+ * Hashed timer wheel. Timers live in a slot map and are chained into the slot of their
+ * deadline tick with a round counter, so adding and cancelling cost O(1) and advancing
+ * costs one slot per elapsed tick. Not thread safe, owned by one IOLoop.
+ */
+class TimerWheel : public noncopyable {
+ public:
+  typedef std::chrono::steady_clock::time_point TimePoint;
+  typedef std::function<void()> TimerTask;
+
+  explicit TimerWheel(uint32_t tick_ms = kTimerTickMs);
+
+  /** Run task delay_ms after now, then every period_ms if it is not 0. */
+  TimerId Add(TimePoint now, uint32_t delay_ms, const TimerTask& task, uint32_t period_ms = 0);
+  /** Unknown or already fired ids are ignored, a timer may cancel itself from its task. */
+  void Cancel(TimerId id);
+  /** Run the tasks of all ticks elapsed up to now. */
+  void Advance(TimePoint now);
+  /** Milliseconds from now to the next tick holding a timer, capped by max_timeout. */
+  int NextTimeout(TimePoint now, int max_timeout) const;
+  bool Empty() const { return armed_num_ == 0; }
+
+ private:
+  static const uint32_t kSlotNum = 512;  /**< power of two, one round is kSlotNum ticks. */
+  static const uint32_t kSlotMask = kSlotNum - 1;
+  static const int32_t kNil = -1;
+
+  typedef enum {
+    kTimerFree = 0,
+    kTimerArmed,
+    kTimerFiring,
+    kTimerCancelled  /**< cancelled by its own task while firing. */
+  } TimerState;
+
+  typedef struct {
+    TimerTask task;
+    uint32_t generation;    /**< bumped on release so stale ids miss. */
+    uint32_t period_ticks;
+    uint32_t rounds;        /**< full turns of the wheel left before it fires. */
+    uint32_t slot;
+    int32_t prev;
+    int32_t next;           /**< next node of the slot, or of the free list. */
+    TimerState state;
+  } TimerNode;
+
+  uint64_t TickOf(TimePoint t) const;
+  void Link(int32_t index, uint64_t deadline_tick);
+  void Unlink(int32_t index);
+  void Release(int32_t index);
+  int32_t Lookup(TimerId id) const;
+
+  std::chrono::milliseconds tick_;
+  TimePoint start_;
+  uint64_t current_tick_;          /**< last tick whose slot was run. */
+  uint32_t armed_num_;
+  std::vector<TimerNode> nodes_;
+  int32_t free_head_;
+  int32_t slots_[kSlotNum];
+  uint64_t occupied_[kSlotNum / 64];  /**< bitmap of the slots holding timers. */
+  std::vector<int32_t> expired_;
+};
+
+} // namespace lidar
+}  // namespace livox
+
+#endif  // LIVOX_TIMER_WHEEL_H_
@@ -27,6 +27,10 @@
 #include <fcntl.h>
 #include <unistd.h>
 #include <stdio.h>
+#include <stdint.h>
+#ifdef __linux__
+#include <sys/eventfd.h>
+#endif
 
 namespace livox {
 namespace lidar {
@@ -36,7 +40,12 @@ WakeUpPipe::~WakeUpPipe() {
 }
 
 bool WakeUpPipe::WakeUp() {
+#ifdef __linux__
+  // An eventfd counter, one 8 byte write whatever the number of pending wake ups.
+  uint64_t ch = 1;
+#else
   char ch = '1';
+#endif
   ssize_t nbytes = sizeof(ch);
   if (pipe_in_ > 0) {
     if (nbytes != write(pipe_in_, &ch, nbytes)) {
@@ -47,7 +56,11 @@ bool WakeUpPipe::WakeUp() {
 }
 
 bool WakeUpPipe::Drain() {
+#ifdef __linux__
+  uint64_t ch[1];
+#else
   char ch[512];
+#endif
   size_t size = sizeof(ch);
   if (pipe_out_ > 0) {
     ssize_t ret = read(pipe_out_, ch, size);
@@ -62,13 +75,24 @@ bool WakeUpPipe::PipeDestroy() {
   if (pipe_in_ > 0) {
     close(pipe_in_);
   }
-  if (pipe_out_ > 0) {
+  if (pipe_out_ > 0 && pipe_out_ != pipe_in_) {
     close(pipe_out_);
   }
+  pipe_in_ = 0;
+  pipe_out_ = 0;
   return true;
 }
 
 bool WakeUpPipe::PipeCreate() {
+#ifdef __linux__
+  // A single eventfd serves as both ends.
+  int event_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+  if (event_fd > 0) {
+    pipe_out_ = event_fd;
+    pipe_in_ = event_fd;
+    return true;
+  }
+#endif
   bool status = false;
   //in filedes[0]
   //out filedes[1]
@@ -28,6 +28,7 @@
 namespace livox {
 namespace lidar {
 
+/** Wakes a poll up, an eventfd on Linux and a pipe or socket pair elsewhere. */
 class WakeUpPipe {
  public:
   WakeUpPipe(): pipe_in_(0), pipe_out_(0) {}
@@ -34,6 +34,7 @@
 #include <atomic>
 
 #include "livox_lidar_def.h"
+#include "base/thread_base.h"
 
 namespace livox {
 namespace lidar {
@@ -42,6 +43,26 @@ namespace lidar {
 
 const uint16_t KDefaultTimeOut = 1000;
 static const uint32_t kMaxCommandBufferSize = 1400;
+static const uint32_t kDefaultDataRecvBatchSize = 32;
+static const uint32_t kMaxDataIOThreadNum = 64;
+static const uint32_t kDefaultDataRcvbufSize = 16 * 1024 * 1024;
+static const uint32_t kDefaultControlRcvbufSize = 256 * 1024;
+static const uint32_t kDefaultDataDrainBudget = 256;
+static const uint32_t kMaxThreadRtPriority = 99;
+static const uint32_t kDefaultRtWarmupMs = 3000;
+static const uint32_t kDetectionIntervalMs = 1000;
+
+typedef enum {
+  kDataIngestSocket = 0,      /**< udp sockets. */
+  kDataIngestPacketMmap = 1,  /**< AF_PACKET TPACKET_V3 ring on the host interface, Linux only. */
+  kDataIngestAfXdp = 2        /**< AF_XDP socket fed by an XDP redirect program in generic mode, Linux only. */
+} DataIngestMode;
+
+typedef enum {
+  kRtAllocTripwireOff = 0,    /**< data path allocations are not watched. */
+  kRtAllocTripwireCount = 1,  /**< count them, see LivoxLidarSdkGetRtAllocationCount. */
+  kRtAllocTripwireAbort = 2   /**< abort the process on the first one. */
+} RtAllocTripwireMode;
 
 typedef struct {
   std::string lidar_ipaddr;
@@ -83,10 +104,54 @@ typedef struct {
   std::string lidar_log_path;
 } LivoxLidarLoggerCfg;
 
+#pragma pack()
+
+// The sdk configuration is not a wire format, it keeps its natural alignment.
+
+/** Threads configured together by the thread_config section. */
+typedef enum {
+  kThreadRoleDetection = 0,
+  kThreadRoleCommand,
+  kThreadRoleData,
+  kThreadRoleImu,
+  kThreadRoleLogger,
+  kThreadRoleDebugPointCloud,
+  kThreadRoleLogCleanup,
+  kThreadRoleDelivery,
+  kThreadRoleNum
+} ThreadRole;
+
 typedef struct {
   bool master_sdk;
+  uint32_t data_recv_batch_size = kDefaultDataRecvBatchSize;  /**< datagrams per receive call on data sockets, 1 disables batching. */
+  uint32_t data_io_thread_num = 1;                             /**< io threads sharing the point and imu sockets. */
+  bool data_io_uring = false;                                  /**< receive data through io_uring, falls back to the default backend. */
+  DataIngestMode data_ingest = kDataIngestSocket;              /**< how point and imu data is captured. */
+  uint32_t xdp_queue_id = 0;                                   /**< rx queue bound by the AF_XDP socket. */
+  uint32_t data_busy_poll_spin_us = 0;                         /**< data loops spin this long after the last packet, 0 always blocks. */
+  uint32_t data_socket_busy_poll_us = 0;                       /**< SO_BUSY_POLL of the data sockets, 0 leaves it unset. */
+  bool data_prefer_busy_poll = false;                          /**< set SO_PREFER_BUSY_POLL on the data sockets. */
+  bool data_latency_report = false;                            /**< log the rx to callback latency distribution. */
+  bool data_connected_sockets = false;                         /**< one connected point and imu socket per known lidar. */
+  bool data_udp_gro = false;                                   /**< receive coalesced datagrams with UDP_GRO. */
+  uint32_t data_rcvbuf_size = kDefaultDataRcvbufSize;          /**< SO_RCVBUF of point, imu and debug sockets. */
+  uint32_t data_rcvbuf_max_size = 0;                           /**< double the data SO_RCVBUF on drops up to this, 0 never grows. */
+  uint32_t control_rcvbuf_size = kDefaultControlRcvbufSize;    /**< SO_RCVBUF of detection, command, push and log sockets. */
+  bool data_edge_triggered = false;                            /**< watch data sockets edge triggered, epoll only. */
+  uint32_t data_drain_budget = kDefaultDataDrainBudget;        /**< datagrams read from one data socket per loop iteration. */
+  bool imu_io_thread = false;                                  /**< serve the imu sockets on an io thread of their own. */
+  bool data_io_per_nic = false;                                /**< data_io_thread_num threads per host interface, on its local cpus. */
+  bool embedded_mode = false;                                  /**< no io thread, the application runs the io loop by LivoxLidarSdkPoll. */
+  bool rt_mode = false;                                        /**< prepare at LivoxLidarSdkStart for an allocation free data path. */
+  bool rt_mlockall = false;                                    /**< lock the process memory at LivoxLidarSdkStart in rt mode. */
+  uint32_t rt_warmup_ms = kDefaultRtWarmupMs;                  /**< from LivoxLidarSdkStart to arming the allocation tripwire. */
+  RtAllocTripwireMode rt_alloc_tripwire = kRtAllocTripwireOff; /**< needs a LIVOX_RT_ALLOC_TRIPWIRE build. */
+  /** Schedule per ThreadRole, an empty name takes the default one. */
+  std::vector<ThreadSchedule> thread_schedules = std::vector<ThreadSchedule>(kThreadRoleNum);
 } LivoxLidarSdkFrameworkCfg;
 
+#pragma pack(1)
+
 typedef enum {
   /**
    * Lidar command set, set the working mode and sub working mode of a LiDAR.
@@ -244,7 +309,9 @@ typedef enum {
   kPointCloud = 2,
   kImuData = 3,
   kLog = 4,
-  kFault = 5
+  kFault = 5,
+  kDebugPointCloud = 6,
+  kDetection = 7
 } HostSocketType;
 
 typedef enum {
@@ -294,6 +361,8 @@ enum class Flag : uint8_t {
 };
 
 using DataCallback = std::function<void(const uint32_t handle, const uint8_t dev_type, LivoxLidarEthernetPacket *data, void *client_data)>;
+using DataCallbackEx = std::function<void(const uint32_t handle, const uint8_t dev_type, LivoxLidarEthernetPacket *data,
+                                          const LivoxLidarRxInfo *rx_info, void *client_data)>;
 using LidarInfoCallback = std::function<void(const uint32_t, const uint8_t, const char*, void*)>;
 
 typedef struct {
@@ -0,0 +1,82 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2022 Livox. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#include "route_table.h"
+
+namespace livox {
+namespace lidar {
+
+static const size_t kMinRouteSlotNum = 16;
+
+RouteTable::RouteTable(const std::vector<RouteEntry>& entries, uint32_t ignored_ip) : ignored_ip_(ignored_ip) {
+  // Keep the load factor under one half so probing stays short and always meets a free slot.
+  size_t slot_num = kMinRouteSlotNum;
+  while (slot_num < entries.size() * 2) {
+    slot_num <<= 1;
+  }
+  Slot empty = {};
+  slots_.assign(slot_num, empty);
+  mask_ = slot_num - 1;
+  for (const RouteEntry& entry : entries) {
+    Insert(entry);
+  }
+}
+
+size_t RouteTable::Hash(uint32_t ip, uint16_t port) {
+  uint64_t key = (static_cast<uint64_t>(ip) << 16) | port;
+  key ^= key >> 33;
+  key *= 0xff51afd7ed558ccdULL;
+  key ^= key >> 33;
+  return static_cast<size_t>(key);
+}
+
+void RouteTable::Insert(const RouteEntry& entry) {
+  for (size_t i = Hash(entry.ip, entry.port) & mask_; ; i = (i + 1) & mask_) {
+    Slot& slot = slots_[i];
+    if (!slot.used) {
+      slot.entry = entry;
+      slot.used = true;
+      return;
+    }
+    if (slot.entry.ip == entry.ip && slot.entry.port == entry.port) {
+      slot.entry.targets |= entry.targets;
+      return;
+    }
+  }
+}
+
+const RouteEntry* RouteTable::Find(uint32_t ip, uint16_t port) const {
+  for (size_t i = Hash(ip, port) & mask_; ; i = (i + 1) & mask_) {
+    const Slot& slot = slots_[i];
+    if (!slot.used) {
+      return nullptr;
+    }
+    if (slot.entry.ip == ip && slot.entry.port == port) {
+      return &slot.entry;
+    }
+  }
+}
+
+} // namespace lidar
+}  // namespace livox
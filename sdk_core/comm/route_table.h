@@ -0,0 +1,84 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2022 Livox. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifndef LIVOX_ROUTE_TABLE_H_
+#define LIVOX_ROUTE_TABLE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+#include "base/noncopyable.h"
+
+namespace livox {
+namespace lidar {
+
+/** Handlers a datagram is delivered to, combined as bits. */
+typedef enum {
+  kRouteData = 1 << 0,             /**< point cloud or imu data, DataHandler. */
+  kRouteCommand = 1 << 1,          /**< command, push or fault message, GeneralCommandHandler. */
+  kRouteLog = 1 << 2,              /**< lidar log, LoggerManager. */
+  kRouteDebugPointCloud = 1 << 3   /**< debug point cloud, DebugPointCloudManager. */
+} RouteTarget;
+
+/** Port of the entry matching the ports of a lidar that have no entry of their own. */
+static const uint16_t kRouteAnyPort = 0;
+
+typedef struct {
+  uint32_t ip;        /**< source ipv4 address in network order. */
+  uint16_t port;      /**< source port. */
+  uint8_t dev_type;   /**< device type of the lidar. */
+  uint8_t targets;    /**< RouteTarget bits, 0 drops the datagram. */
+} RouteEntry;
+
+/**
+ * Immutable open addressing table mapping the source (ip, port) of a datagram
+ * to its handlers. A new table is built on every topology change and published
+ * atomically, so the receive threads look routes up without locks.
+ */
+class RouteTable : public noncopyable {
+ public:
+  /** Entries with the same key are merged, datagrams from ignored_ip are dropped. */
+  RouteTable(const std::vector<RouteEntry>& entries, uint32_t ignored_ip);
+  const RouteEntry* Find(uint32_t ip, uint16_t port) const;
+  bool IsIgnored(uint32_t ip) const { return ip == ignored_ip_; }
+
+ private:
+  static size_t Hash(uint32_t ip, uint16_t port);
+  void Insert(const RouteEntry& entry);
+
+ private:
+  typedef struct {
+    RouteEntry entry;
+    bool used;
+  } Slot;
+
+  std::vector<Slot> slots_;
+  size_t mask_;
+  uint32_t ignored_ip_;
+};
+
+} // namespace lidar
+}  // namespace livox
+
+#endif  // LIVOX_ROUTE_TABLE_H_
@@ -37,6 +37,7 @@
 #include "base/logging.h"
 #include "comm/protocol.h"
 #include "comm/generate_seq.h"
+#include "sdk_context.h"
 
 #include "build_request.h"
 
@@ -55,8 +56,7 @@ GeneralCommandHandler::GeneralCommandHandler()
 }
 
 GeneralCommandHandler& GeneralCommandHandler::GetInstance() {
-  static GeneralCommandHandler general_command_handler;
-  return general_command_handler;
+  return SdkContext::Current().GetGeneralCommandHandler();
 }
 
 bool GeneralCommandHandler::Init(const std::string& host_ip, const bool is_view, DeviceManager* device_manager) {
@@ -813,37 +813,36 @@ void GeneralCommandHandler::AddCommand(const Command& command) {
     return;
   }
   
-  std::lock_guard<std::mutex> lock(commands_mutex_);
-  commands_[command.packet.seq_num] = std::make_pair(command, std::chrono::steady_clock::now() + std::chrono::milliseconds(command.time_out));
-  Command &cmd = commands_[command.packet.seq_num].first;
-  if (cmd.packet.data != NULL) {
-    cmd.packet.data = NULL;
-    cmd.packet.data_len = 0;
+  uint32_t seq = command.packet.seq_num;
+  TimePoint deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(command.time_out);
+  {
+    std::lock_guard<std::mutex> lock(commands_mutex_);
+    commands_[seq] = std::make_pair(command, deadline);
+    Command &cmd = commands_[seq].first;
+    if (cmd.packet.data != NULL) {
+      cmd.packet.data = NULL;
+      cmd.packet.data_len = 0;
+    }
+  }
+  if (device_manager_ != nullptr) {
+    device_manager_->AddCommandTimer(command.time_out, [this, seq, deadline]() { CommandTimeout(seq, deadline); });
   }
 }
 
-void GeneralCommandHandler::CommandsHandle(TimePoint now) {
-  std::list<Command> timeout_commands;
-
+void GeneralCommandHandler::CommandTimeout(const uint32_t seq, const TimePoint deadline) {
+  Command timeout_command;
   {
+    // The timer is not cancelled on ack, the deadline tells a reused seq apart.
     std::lock_guard<std::mutex> lock(commands_mutex_);
-    std::map<uint32_t, std::pair<Command, TimePoint> >::iterator ite = commands_.begin();
-    while (ite != commands_.end()) {
-      std::pair<Command, TimePoint> &command_pair = ite->second;
-      if (now > command_pair.second) {
-        timeout_commands.push_back(command_pair.first);
-        uint32_t seq = ite->first;
-        ++ite;
-        commands_.erase(seq);
-      } else {
-        ++ite;
-      }
+    auto ite = commands_.find(seq);
+    if (ite == commands_.end() || ite->second.second != deadline) {
+      return;
     }
+    timeout_command = ite->second.first;
+    commands_.erase(ite);
   }
-  for (auto& timeout_command : timeout_commands) {
-    if (timeout_command.cb) {
-      (*timeout_command.cb)(kLivoxLidarStatusTimeout, timeout_command.handle, timeout_command.packet.data);
-    }
+  if (timeout_command.cb) {
+    (*timeout_command.cb)(kLivoxLidarStatusTimeout, timeout_command.handle, timeout_command.packet.data);
   }
 }
 
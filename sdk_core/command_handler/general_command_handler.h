@@ -59,6 +59,7 @@ class HapCommandHandle;
 
 class GeneralCommandHandler : public noncopyable {
  private:
+  friend class SdkContext;
   GeneralCommandHandler();
   GeneralCommandHandler(const GeneralCommandHandler& other) = delete;
   GeneralCommandHandler& operator=(const GeneralCommandHandler& other) = delete;
@@ -86,7 +87,6 @@ class GeneralCommandHandler : public noncopyable {
   livox_status SendLoggerCommand(uint32_t handle, uint16_t command_id, uint8_t *data,
                                  uint16_t length, const std::shared_ptr<CommandCallback> &cb);
 
-  void CommandsHandle(TimePoint now);
   void AddCommand(const Command& command);
   void AddDetectedLidar(const std::shared_ptr<std::vector<LivoxLidarCfg>>& custom_lidars_cfg_ptr);
 
@@ -126,6 +126,7 @@ class GeneralCommandHandler : public noncopyable {
   void GetFirmwareType(const uint32_t handle, DeviceInfo& device_info);
   livox_status QueryFwType(const uint32_t handle);
   void UpdateFwType(const uint32_t handle, const uint8_t fw_type);
+  void CommandTimeout(const uint32_t seq, const TimePoint deadline);
  private:
   DeviceManager* device_manager_;
   std::unique_ptr<CommPort> comm_port_;
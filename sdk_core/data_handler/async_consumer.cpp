@@ -0,0 +1,231 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2022 Livox. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#include "async_consumer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <thread>
+
+#include "base/logging.h"
+
+namespace livox {
+namespace lidar {
+
+/** Packets delivered from one ring before moving to the next, so that a busy producer cannot starve the rest. */
+static const uint32_t kDeliveryBatchSize = 64;
+/** The worker sleeps at most this long without a wake up, in case one is missed. */
+static const uint32_t kDeliveryIdleWaitMs = 100;
+
+AsyncConsumer::AsyncConsumer(const DataCallback& cb, void* client_data, uint32_t ring_size,
+                             LivoxLidarDeliveryPolicy policy)
+    : callback_(cb),
+      client_data_(client_data),
+      capacity_(1),
+      policy_(policy),
+      unprepared_dropped_(0),
+      delivered_(0),
+      stopped_(false),
+      sleeping_(false) {
+  ring_size = std::min(ring_size, kMaxDeliveryRingSize);
+  while (capacity_ < ring_size) {
+    capacity_ <<= 1;
+  }
+  for (uint32_t i = 0; i < kMaxDeliveryProducers; ++i) {
+    rings_[i].store(nullptr, std::memory_order_relaxed);
+  }
+}
+
+AsyncConsumer::~AsyncConsumer() {
+  Stop();
+  for (uint32_t i = 0; i < kMaxDeliveryProducers; ++i) {
+    delete rings_[i].load(std::memory_order_relaxed);
+  }
+}
+
+void AsyncConsumer::PrepareRings(uint32_t producer_num) {
+  for (uint32_t i = 0; i < producer_num && i < kMaxDeliveryProducers; ++i) {
+    if (rings_[i].load(std::memory_order_relaxed) == nullptr) {
+      rings_[i].store(new DeliveryRing(capacity_), std::memory_order_release);
+    }
+  }
+}
+
+void AsyncConsumer::Push(uint32_t slot, uint32_t handle, uint8_t dev_type, const uint8_t* buf, uint32_t size) {
+  if (stopped_.load(std::memory_order_relaxed)) {
+    return;
+  }
+  DeliveryRing* ring = rings_[slot].load(std::memory_order_acquire);
+  if (ring == nullptr) {
+    unprepared_dropped_.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+  if (size > kMaxDeliveryPacketSize) {
+    ring->dropped.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+
+  uint64_t head = ring->head.load(std::memory_order_relaxed);
+  uint64_t tail = ring->tail.load(std::memory_order_acquire);
+  if (head - tail > ring->mask) {
+    if (policy_ == kLivoxLidarDeliveryDropNewest) {
+      ring->dropped.fetch_add(1, std::memory_order_relaxed);
+      return;
+    } else if (policy_ == kLivoxLidarDeliveryDropOldest) {
+      // Take the oldest packet back unless the worker claimed it first.
+      if (ring->tail.compare_exchange_strong(tail, tail + 1, std::memory_order_acq_rel)) {
+        ring->dropped.fetch_add(1, std::memory_order_relaxed);
+      }
+    } else {
+      while (head - ring->tail.load(std::memory_order_acquire) > ring->mask) {
+        if (stopped_.load(std::memory_order_relaxed)) {
+          return;
+        }
+        std::this_thread::yield();
+      }
+    }
+  }
+
+  if (policy_ == kLivoxLidarDeliveryDropOldest && head > ring->mask) {
+    // The slot held packet head - capacity, claimed by now but maybe still being copied out by the worker.
+    while (ring->reading.load(std::memory_order_acquire) == head - ring->mask) {
+      if (stopped_.load(std::memory_order_relaxed)) {
+        return;
+      }
+      std::this_thread::yield();
+    }
+  }
+
+  DeliveryPacket& packet = ring->packets[head & ring->mask];
+  packet.handle = handle;
+  packet.dev_type = dev_type;
+  packet.size = size;
+  memcpy(packet.data, buf, size);
+  ring->head.store(head + 1, std::memory_order_release);
+  WakeUp();
+}
+
+void AsyncConsumer::WakeUp() {
+  // Pairs with the fence of ThreadFunc: either the worker sees the packet or this sees it sleeping.
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (sleeping_.load(std::memory_order_relaxed) && sleeping_.exchange(false, std::memory_order_relaxed)) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    cv_.notify_one();
+  }
+}
+
+uint32_t AsyncConsumer::Drain(DeliveryRing& ring, uint32_t max_num) {
+  uint32_t num = 0;
+  while (num < max_num && !stopped_.load(std::memory_order_relaxed)) {
+    uint64_t tail = ring.tail.load(std::memory_order_acquire);
+    if (tail == ring.head.load(std::memory_order_acquire)) {
+      break;
+    }
+    DeliveryPacket& packet = ring.packets[tail & ring.mask];
+    if (policy_ != kLivoxLidarDeliveryDropOldest) {
+      callback_(packet.handle, packet.dev_type, reinterpret_cast<LivoxLidarEthernetPacket*>(packet.data),
+                client_data_);
+      ring.tail.store(tail + 1, std::memory_order_release);
+    } else {
+      // Announced before the claim, a producer that sees the claim also sees the announcement and keeps off
+      // the slot until the copy is done. A packet the producer took back first is not ours to copy.
+      ring.reading.store(tail + 1, std::memory_order_seq_cst);
+      if (!ring.tail.compare_exchange_strong(tail, tail + 1, std::memory_order_acq_rel)) {
+        ring.reading.store(0, std::memory_order_release);
+        continue;
+      }
+      scratch_.handle = packet.handle;
+      scratch_.dev_type = packet.dev_type;
+      scratch_.size = std::min(packet.size, kMaxDeliveryPacketSize);
+      memcpy(scratch_.data, packet.data, scratch_.size);
+      ring.reading.store(0, std::memory_order_release);
+      callback_(scratch_.handle, scratch_.dev_type, reinterpret_cast<LivoxLidarEthernetPacket*>(scratch_.data),
+                client_data_);
+    }
+    ++num;
+    delivered_.fetch_add(1, std::memory_order_relaxed);
+  }
+  return num;
+}
+
+bool AsyncConsumer::HasQueued() const {
+  for (uint32_t i = 0; i < kMaxDeliveryProducers; ++i) {
+    const DeliveryRing* ring = rings_[i].load(std::memory_order_acquire);
+    if (ring != nullptr &&
+        ring->head.load(std::memory_order_acquire) != ring->tail.load(std::memory_order_acquire)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void AsyncConsumer::ThreadFunc() {
+  while (!stopped_.load(std::memory_order_acquire)) {
+    uint32_t num = 0;
+    for (uint32_t i = 0; i < kMaxDeliveryProducers; ++i) {
+      DeliveryRing* ring = rings_[i].load(std::memory_order_acquire);
+      if (ring != nullptr) {
+        num += Drain(*ring, kDeliveryBatchSize);
+      }
+    }
+    if (num != 0) {
+      continue;
+    }
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    sleeping_.store(true, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (!HasQueued() && !stopped_.load(std::memory_order_relaxed)) {
+      cv_.wait_for(lock, std::chrono::milliseconds(kDeliveryIdleWaitMs));
+    }
+    sleeping_.store(false, std::memory_order_relaxed);
+  }
+}
+
+void AsyncConsumer::Stop() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopped_.store(true, std::memory_order_release);
+    cv_.notify_one();
+  }
+  Join();
+}
+
+void AsyncConsumer::GetStats(LivoxLidarConsumerStats* stats) const {
+  stats->delivered = delivered_.load(std::memory_order_relaxed);
+  stats->dropped = unprepared_dropped_.load(std::memory_order_relaxed);
+  stats->queued = 0;
+  for (uint32_t i = 0; i < kMaxDeliveryProducers; ++i) {
+    const DeliveryRing* ring = rings_[i].load(std::memory_order_acquire);
+    if (ring != nullptr) {
+      uint64_t tail = ring->tail.load(std::memory_order_acquire);
+      stats->dropped += ring->dropped.load(std::memory_order_relaxed);
+      stats->queued += static_cast<uint32_t>(ring->head.load(std::memory_order_acquire) - tail);
+    }
+  }
+}
+
+} // namespace lidar
+}  // namespace livox
@@ -0,0 +1,116 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2022 Livox. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifndef LIVOX_ASYNC_CONSUMER_H_
+#define LIVOX_ASYNC_CONSUMER_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+
+#include "comm/define.h"
+#include "base/thread_base.h"
+#include "livox_lidar_def.h"
+
+namespace livox {
+namespace lidar {
+
+/** Threads pushing into the rings of a consumer, every data io thread takes one slot. */
+static const uint32_t kMaxDeliveryProducers = 32;
+/** Largest packet a ring slot holds. */
+static const uint32_t kMaxDeliveryPacketSize = 1472;
+static const uint32_t kMaxDeliveryRingSize = 65536;
+
+typedef struct {
+  uint32_t handle;
+  uint8_t dev_type;
+  uint32_t size;
+  uint8_t data[kMaxDeliveryPacketSize];
+} DeliveryPacket;
+
+/**
+ * Packets queued by one producer thread for the worker of a consumer. head_ is written by the producer,
+ * tail_ by the worker, and by the producer too when it drops the oldest packet. With that policy the worker
+ * claims a packet before copying it out and announces it in reading, one past its index, so that the
+ * producer never writes the slot under the copy.
+ */
+typedef struct DeliveryRing {
+  explicit DeliveryRing(uint32_t capacity)
+      : packets(new DeliveryPacket[capacity]()), mask(capacity - 1), head(0), tail(0), reading(0), dropped(0) {}
+  std::unique_ptr<DeliveryPacket[]> packets;
+  uint64_t mask;
+  char head_pad[64];
+  std::atomic<uint64_t> head;
+  char tail_pad[64];
+  std::atomic<uint64_t> tail;
+  std::atomic<uint64_t> reading;
+  char dropped_pad[64];
+  std::atomic<uint64_t> dropped;
+} DeliveryRing;
+
+/**
+ * A point cloud observer called on a worker thread of its own. The data io threads copy each packet into
+ * a bounded single producer ring of theirs, so a slow callback costs packets rather than io time, unless
+ * the policy is kLivoxLidarDeliveryBlock.
+ */
+class AsyncConsumer : public ThreadBase {
+ public:
+  AsyncConsumer(const DataCallback& cb, void* client_data, uint32_t ring_size, LivoxLidarDeliveryPolicy policy);
+  ~AsyncConsumer();
+
+  /** Allocate the rings of slots [0, producer_num), before the consumer is published to the producers. */
+  void PrepareRings(uint32_t producer_num);
+  /** Queue a packet from the thread owning slot, a slot without a ring drops it. */
+  void Push(uint32_t slot, uint32_t handle, uint8_t dev_type, const uint8_t* buf, uint32_t size);
+  /** Join the worker, the queued packets are dropped and pushes return at once afterwards. */
+  void Stop();
+  void GetStats(LivoxLidarConsumerStats* stats) const;
+  void ThreadFunc();
+
+ private:
+  /** Deliver up to max_num packets of ring, return how many were delivered. */
+  uint32_t Drain(DeliveryRing& ring, uint32_t max_num);
+  bool HasQueued() const;
+  void WakeUp();
+
+ private:
+  DataCallback callback_;
+  void* client_data_;
+  uint32_t capacity_;
+  LivoxLidarDeliveryPolicy policy_;
+  std::atomic<DeliveryRing*> rings_[kMaxDeliveryProducers];
+  std::atomic<uint64_t> unprepared_dropped_;  /**< packets of slots which got no ring. */
+  DeliveryPacket scratch_;
+  std::atomic<uint64_t> delivered_;
+  std::atomic<bool> stopped_;
+  std::atomic<bool> sleeping_;
+  std::mutex mutex_;
+  std::condition_variable cv_;
+};
+
+} // namespace lidar
+}  // namespace livox
+
+#endif  // LIVOX_ASYNC_CONSUMER_H_
@@ -24,8 +24,12 @@
 
 #include "data_handler.h"
 #include <base/logging.h>
+#include <algorithm>
+#include <chrono>
 
 #include "livox_lidar_def.h"
+#include "device_manager.h"
+#include "sdk_context.h"
 
 namespace livox {
 
@@ -33,16 +37,42 @@ namespace lidar {
 
 static const size_t kPrefixDataSize = 18;
 
+namespace {
+
+/** Producer slot of the calling thread in the data handler whose serial matches. */
+typedef struct {
+  uint64_t serial;
+  uint32_t slot;
+} ProducerSlotCache;
+
+thread_local ProducerSlotCache producer_slot_cache = { 0, 0 };
+
+uint64_t NextProducerSerial() {
+  static std::atomic<uint64_t> serial(1);
+  return serial.fetch_add(1);
+}
+
+} // namespace
+
 DataHandler::DataHandler()
-    : point_data_callbacks_(nullptr),
-      point_client_data_(nullptr),
-      imu_data_callbacks_(nullptr),
-      imu_client_data_(nullptr) {
+    : readers_(kMaxDeliveryProducers),
+      point_data_callback_(readers_),
+      imu_data_callback_(readers_),
+      point_data_callback_ex_(readers_),
+      imu_data_callback_ex_(readers_),
+      observers_(readers_),
+      consumers_(readers_),
+      has_consumers_(false),
+      producer_serial_(NextProducerSerial()),
+      latency_report_(false) {
+  for (uint32_t i = 0; i < kMaxDeliveryProducers; ++i) {
+    producers_[i].sequence.store(0, std::memory_order_relaxed);
+  }
+  producer_ids_.reserve(kMaxDeliveryProducers);
 }
 
 DataHandler& DataHandler::GetInstance() {
-  static DataHandler data_handler;
-  return data_handler;
+  return SdkContext::Current().GetDataHandler();
 }
 
 bool DataHandler::Init() {
@@ -51,14 +81,29 @@ bool DataHandler::Init() {
 }
 
 void DataHandler::Destory() {
-  point_data_callbacks_ = nullptr;
-  point_client_data_ = nullptr;
-
-  imu_data_callbacks_ = nullptr;
-  imu_client_data_ = nullptr;
+  std::map<uint16_t, std::unique_ptr<AsyncConsumer>> async_consumers;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    async_consumers.swap(async_consumers_);
+  }
+  // Outside of mutex_, a callback waited for may call into the data handler.
+  for (auto& item : async_consumers) {
+    item.second->Stop();
+  }
 
+  // The io threads are stopped by now, no packet can hold a snapshot any more.
   std::lock_guard<std::mutex> lock(mutex_);
-  observers_.clear();
+  consumers_.Clear();
+  has_consumers_ = false;
+  producer_ids_.clear();
+  producer_serial_ = NextProducerSerial();
+  point_data_callback_.Clear();
+  imu_data_callback_.Clear();
+  point_data_callback_ex_.Clear();
+  imu_data_callback_ex_.Clear();
+  observers_.Clear();
+  latency_report_.store(false, std::memory_order_relaxed);
+  latency_stats_.Reset();
 }
 
 DataHandler::~DataHandler() {
@@ -66,50 +111,231 @@ DataHandler::~DataHandler() {
 }
 
 
-void DataHandler::Handle(const uint8_t dev_type, const uint32_t handle, uint8_t *buf, uint32_t buf_size) {
+void DataHandler::Handle(const uint8_t dev_type, const uint32_t handle, uint8_t *buf, uint32_t buf_size,
+                         uint64_t rx_timestamp_ns) {
   LivoxLidarEthernetPacket *lidar_data = (LivoxLidarEthernetPacket *)buf;
   if (lidar_data == NULL) {
     return;
   }
 
-  if (lidar_data->data_type == kLivoxLidarImuData) {
-    if (imu_data_callbacks_) {
-      imu_data_callbacks_(handle, dev_type, lidar_data, imu_client_data_);
+  // The snapshots loaded below stay alive until the section ends.
+  uint32_t slot = GetProducerSlot();
+  readers_.Enter(slot);
+  bool is_imu = lidar_data->data_type == kLivoxLidarImuData;
+  const DataCallbackEntry<DataCallback>* callback = is_imu ? imu_data_callback_.Load() : point_data_callback_.Load();
+  const DataCallbackEntry<DataCallbackEx>* callback_ex =
+      is_imu ? imu_data_callback_ex_.Load() : point_data_callback_ex_.Load();
+  LivoxLidarRxInfo rx_info = { rx_timestamp_ns, 0 };
+  bool latency_report = latency_report_.load(std::memory_order_acquire);
+  if (latency_report || callback_ex != nullptr) {
+    rx_info.dispatch_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    if (latency_report) {
+      latency_stats_.Record(rx_timestamp_ns, rx_info.dispatch_ns);
     }
-  } else {  
-    if (point_data_callbacks_) {
-      point_data_callbacks_(handle, dev_type, lidar_data, point_client_data_);
+  }
+
+  if (callback != nullptr) {
+    callback->callback(handle, dev_type, lidar_data, callback->client_data);
+  }
+  if (callback_ex != nullptr) {
+    callback_ex->callback(handle, dev_type, lidar_data, &rx_info, callback_ex->client_data);
+  }
+
+  const std::vector<DataObserver>* observers = observers_.Load();
+  if (observers != nullptr) {
+    for (const DataObserver& observer : *observers) {
+      observer.callback(handle, dev_type, lidar_data, observer.client_data);
     }
   }
 
+  if (has_consumers_.load(std::memory_order_relaxed) && slot < kMaxDeliveryProducers) {
+    Deliver(slot, dev_type, handle, buf, buf_size);
+  }
+  readers_.Leave(slot);
+}
+
+void DataHandler::Deliver(uint32_t slot, const uint8_t dev_type, const uint32_t handle, const uint8_t* buf,
+                          uint32_t buf_size) {
+  std::atomic<uint64_t>& sequence = producers_[slot].sequence;
+  uint64_t value = sequence.load(std::memory_order_relaxed);
+  sequence.store(value + 1, std::memory_order_relaxed);
+  // Pairs with the fence of RemoveAsyncConsumer: either it sees the sequence odd or this sees the new list.
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  const std::vector<AsyncConsumer*>* consumers = consumers_.Load();
+  if (consumers != nullptr) {
+    for (AsyncConsumer* consumer : *consumers) {
+      consumer->Push(slot, handle, dev_type, buf, buf_size);
+    }
+  }
+  sequence.store(value + 2, std::memory_order_release);
+}
+
+uint32_t DataHandler::GetProducerSlot() {
+  if (producer_slot_cache.serial == producer_serial_) {
+    return producer_slot_cache.slot;
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::thread::id id = std::this_thread::get_id();
+  auto it = std::find(producer_ids_.begin(), producer_ids_.end(), id);
+  uint32_t slot = static_cast<uint32_t>(it - producer_ids_.begin());
+  if (it == producer_ids_.end()) {
+    if (producer_ids_.size() < kMaxDeliveryProducers) {
+      producer_ids_.push_back(id);
+    } else {
+      LOG_WARN("More than {} threads deliver data, async consumers miss the packets of this one.",
+               kMaxDeliveryProducers);
+      slot = kMaxDeliveryProducers;
+    }
+  }
+  producer_slot_cache.serial = producer_serial_;
+  producer_slot_cache.slot = slot;
+  return slot;
+}
+
+uint16_t DataHandler::AddAsyncConsumer(const DataCallback& cb, void* client_data, uint32_t ring_size,
+                                       LivoxLidarDeliveryPolicy policy) {
+  bool known_policy = policy == kLivoxLidarDeliveryDropNewest || policy == kLivoxLidarDeliveryDropOldest ||
+                      policy == kLivoxLidarDeliveryBlock;
+  if (!cb || ring_size == 0 || !known_policy) {
+    LOG_ERROR("Add async consumer failed, ring_size:{}, policy:{}.", ring_size, static_cast<int>(policy));
+    return 0;
+  }
+  uint16_t consumer_id = GenerateObserverId();
+  std::unique_ptr<AsyncConsumer> consumer(new AsyncConsumer(cb, client_data, ring_size, policy));
+  ThreadSchedule schedule = DeviceManager::GetInstance().GetThreadSchedule(kThreadRoleDelivery);
+  schedule.name += std::to_string(consumer_id);
+  consumer->SetSchedule(schedule);
+  uint32_t producer_num = DeviceManager::GetInstance().GetDataThreadNum();
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (async_consumers_.count(consumer_id) != 0) {
+    LOG_ERROR("Add async consumer failed, id {} is in use.", consumer_id);
+    return 0;
+  }
+  // Every ring is allocated here, a data io thread never allocates on its packet path.
+  producer_num = std::max(producer_num, static_cast<uint32_t>(producer_ids_.size()));
+  if (producer_num > kMaxDeliveryProducers) {
+    LOG_WARN("{} threads deliver data, async consumer {} misses the packets of all but {}.", producer_num,
+             consumer_id, kMaxDeliveryProducers);
+  }
+  consumer->PrepareRings(producer_num);
+  if (!consumer->Start()) {
+    LOG_ERROR("Add async consumer failed, start the worker failed.");
+    return 0;
+  }
+  const std::vector<AsyncConsumer*>* current = consumers_.Load();
+  std::unique_ptr<std::vector<AsyncConsumer*>> consumers(
+      current ? new std::vector<AsyncConsumer*>(*current) : new std::vector<AsyncConsumer*>());
+  consumers->push_back(consumer.get());
+  consumers_.Store(std::move(consumers));
+  async_consumers_[consumer_id] = std::move(consumer);
+  has_consumers_ = true;
+  LOG_INFO("Add async consumer {}, ring_size:{}, policy:{}.", consumer_id, ring_size, static_cast<int>(policy));
+  return consumer_id;
+}
+
+void DataHandler::RemoveAsyncConsumer(uint16_t id) {
+  std::unique_ptr<AsyncConsumer> consumer;
+  uint32_t producer_num = 0;
   {
     std::lock_guard<std::mutex> lock(mutex_);
-    for (const auto& observer : observers_) {
-      auto callback = observer.second.first;
-      auto client_data = observer.second.second;
-      if (callback) {
-        callback(handle, dev_type, lidar_data, client_data);
+    auto it = async_consumers_.find(id);
+    if (it == async_consumers_.end()) {
+      return;
+    }
+    consumer = std::move(it->second);
+    async_consumers_.erase(it);
+    std::unique_ptr<std::vector<AsyncConsumer*>> consumers(new std::vector<AsyncConsumer*>());
+    for (AsyncConsumer* other : *consumers_.Load()) {
+      if (other != consumer.get()) {
+        consumers->push_back(other);
       }
     }
+    has_consumers_ = !consumers->empty();
+    consumers_.Store(std::move(consumers));
+    producer_num = static_cast<uint32_t>(producer_ids_.size());
+  }
+
+  // Stopped first so that a push blocked on its full ring returns.
+  consumer->Stop();
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  for (uint32_t i = 0; i < producer_num; ++i) {
+    uint64_t sequence = producers_[i].sequence.load(std::memory_order_acquire);
+    if (sequence % 2 == 0) {
+      continue;
+    }
+    // The producer may have loaded the old list, wait for its delivery to end.
+    while (producers_[i].sequence.load(std::memory_order_acquire) == sequence) {
+      std::this_thread::yield();
+    }
   }
+  LOG_INFO("Remove async consumer {}.", id);
+}
+
+bool DataHandler::GetAsyncConsumerStats(uint16_t id, LivoxLidarConsumerStats* stats) {
+  if (stats == nullptr) {
+    return false;
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = async_consumers_.find(id);
+  if (it == async_consumers_.end()) {
+    return false;
+  }
+  it->second->GetStats(stats);
+  return true;
 }
 
 uint16_t DataHandler::AddPointCloudObserver(const DataCallback &cb, void *client_data) {
   uint16_t observer_id = GenerateObserverId();
-  {
-    std::lock_guard<std::mutex> lock(mutex_);
-    observers_[observer_id] = std::make_pair(cb, client_data);
+  std::lock_guard<std::mutex> lock(mutex_);
+  const std::vector<DataObserver>* current = observers_.Load();
+  std::unique_ptr<std::vector<DataObserver>> observers(new std::vector<DataObserver>());
+  if (current != nullptr) {
+    // An id wrapped around replaces its stale observer.
+    for (const DataObserver& observer : *current) {
+      if (observer.id != observer_id) {
+        observers->push_back(observer);
+      }
+    }
+  }
+  if (cb) {
+    DataObserver observer = { observer_id, cb, client_data };
+    observers->push_back(observer);
   }
+  observers_.Store(std::move(observers));
   return observer_id;
 }
 
 void DataHandler::RemovePointCloudObserver(uint16_t id) {
   std::lock_guard<std::mutex> lock(mutex_);
-  if (observers_.find(id) != observers_.end()) {
-    observers_.erase(id);
+  const std::vector<DataObserver>* current = observers_.Load();
+  if (current == nullptr) {
+    return;
+  }
+  std::unique_ptr<std::vector<DataObserver>> observers(new std::vector<DataObserver>());
+  for (const DataObserver& observer : *current) {
+    if (observer.id != id) {
+      observers->push_back(observer);
+    }
+  }
+  if (observers->size() != current->size()) {
+    observers_.Store(std::move(observers));
   }
 }
 
+template <typename Callback>
+void DataHandler::SetCallback(RcuValue<DataCallbackEntry<Callback>>& entry, const Callback& cb, void* client_data) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::unique_ptr<DataCallbackEntry<Callback>> value;
+  if (cb) {
+    value.reset(new DataCallbackEntry<Callback>());
+    value->callback = cb;
+    value->client_data = client_data;
+  }
+  entry.Store(std::move(value));
+}
+
 uint16_t DataHandler::GenerateObserverId() {
   static std::atomic<std::uint16_t> observer_id(1);
   uint16_t value = observer_id.load();
@@ -125,13 +351,25 @@ uint16_t DataHandler::GenerateObserverId() {
 }
 
 void DataHandler::SetPointDataCallback(const DataCallback& cb, void *client_data) {
-  point_data_callbacks_ = cb;
-  point_client_data_ = client_data;
+  SetCallback(point_data_callback_, cb, client_data);
+}
+
+void DataHandler::SetLatencyReport(bool enable, const std::string& label) {
+  latency_stats_.Reset();
+  latency_stats_.SetLabel(label);
+  latency_report_.store(enable, std::memory_order_release);
 }
 
 void DataHandler::SetImuDataCallback(const DataCallback& cb, void* client_data) {
-  imu_data_callbacks_ = cb;
-  imu_client_data_ = client_data;
+  SetCallback(imu_data_callback_, cb, client_data);
+}
+
+void DataHandler::SetPointDataCallbackEx(const DataCallbackEx& cb, void *client_data) {
+  SetCallback(point_data_callback_ex_, cb, client_data);
+}
+
+void DataHandler::SetImuDataCallbackEx(const DataCallbackEx& cb, void* client_data) {
+  SetCallback(imu_data_callback_ex_, cb, client_data);
 }
 
 } // namespace lidar
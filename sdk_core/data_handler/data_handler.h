@@ -26,19 +26,47 @@
 #define LIVOX_DATA_HANDLER_H_
 
 #include <array>
+#include <atomic>
 #include <functional>
+#include <map>
 #include <memory>
 #include <mutex>
+#include <thread>
 #include <utility>
+#include <vector>
 
 #include "comm/define.h"
 #include "base/io_loop.h"
+#include "base/latency_stats.h"
+#include "base/rcu_value.h"
+#include "async_consumer.h"
 
 namespace livox {
 namespace lidar {
 
+/** A data callback with the client data it is called with. */
+template <typename Callback>
+struct DataCallbackEntry {
+  Callback callback;
+  void* client_data;
+};
+
+/** A point cloud observer and its id. */
+typedef struct {
+  uint16_t id;
+  DataCallback callback;
+  void* client_data;
+} DataObserver;
+
+/** Delivery state of a producer thread, its sequence is odd while it pushes into the async consumers. */
+typedef struct {
+  std::atomic<uint64_t> sequence;
+  char pad[64 - sizeof(std::atomic<uint64_t>)];
+} DeliveryProducer;
+
 class DataHandler : public noncopyable {
  private:
+  friend class SdkContext;
   DataHandler();
   DataHandler(const DataHandler& other) = delete;
   DataHandler& operator=(const DataHandler& other) = delete;
@@ -49,25 +77,59 @@ class DataHandler : public noncopyable {
 
   bool Init();
 
-  void Handle(const uint8_t dev_type, const uint32_t handle, uint8_t *buf, uint32_t buf_size);
+  void Handle(const uint8_t dev_type, const uint32_t handle, uint8_t *buf, uint32_t buf_size,
+              uint64_t rx_timestamp_ns = 0);
+
+  /**
+   * Periodically log the kernel rx to callback latency of the stamped packets, label names the io mode.
+   * Called before any io loop delivers packets, the stats are not guarded against Handle.
+   */
+  void SetLatencyReport(bool enable, const std::string& label);
 
   uint16_t AddPointCloudObserver(const DataCallback &cb, void *client_data);
   void RemovePointCloudObserver(uint16_t id);
 
+  /** Observer called on a worker thread of its own through per producer rings, return 0 on failure. */
+  uint16_t AddAsyncConsumer(const DataCallback& cb, void* client_data, uint32_t ring_size,
+                            LivoxLidarDeliveryPolicy policy);
+  /** Stop the worker of a consumer, then free it once no producer may still be pushing into it. */
+  void RemoveAsyncConsumer(uint16_t id);
+  bool GetAsyncConsumerStats(uint16_t id, LivoxLidarConsumerStats* stats);
+
   void SetPointDataCallback(const DataCallback& cb, void *client_data);
   void SetImuDataCallback(const DataCallback& cb, void* client_data);
+  void SetPointDataCallbackEx(const DataCallbackEx& cb, void *client_data);
+  void SetImuDataCallbackEx(const DataCallbackEx& cb, void* client_data);
 
  private:
   uint16_t GenerateObserverId();
+  /** Push a packet into the async consumers from the producer owning slot. */
+  void Deliver(uint32_t slot, const uint8_t dev_type, const uint32_t handle, const uint8_t* buf, uint32_t buf_size);
+  /** Ring slot of the calling thread, kMaxDeliveryProducers if every slot is taken. */
+  uint32_t GetProducerSlot();
+  template <typename Callback>
+  void SetCallback(RcuValue<DataCallbackEntry<Callback>>& entry, const Callback& cb, void* client_data);
  private:
-  DataCallback point_data_callbacks_;
-  void* point_client_data_;
+  // The packet path reads these snapshots wait free inside a section of readers_ per producer slot, the
+  // setters replace them under mutex_.
+  RcuReaders readers_;
+  RcuValue<DataCallbackEntry<DataCallback>> point_data_callback_;
+  RcuValue<DataCallbackEntry<DataCallback>> imu_data_callback_;
+  RcuValue<DataCallbackEntry<DataCallbackEx>> point_data_callback_ex_;
+  RcuValue<DataCallbackEntry<DataCallbackEx>> imu_data_callback_ex_;
+  RcuValue<std::vector<DataObserver>> observers_;
+  std::mutex mutex_;
 
-  DataCallback imu_data_callbacks_;
-  void* imu_client_data_;
+  // Consumers are pushed to from the published list, async_consumers_ owns them under mutex_.
+  RcuValue<std::vector<AsyncConsumer*>> consumers_;
+  std::map<uint16_t, std::unique_ptr<AsyncConsumer>> async_consumers_;
+  std::atomic<bool> has_consumers_;
+  DeliveryProducer producers_[kMaxDeliveryProducers];
+  std::vector<std::thread::id> producer_ids_;  /**< thread of each slot, under mutex_. */
+  uint64_t producer_serial_;                   /**< changes when the slots are reset, invalidating cached slots. */
 
-  std::map<uint16_t, std::pair<DataCallback, void*>> observers_;
-  std::mutex mutex_;
+  std::atomic<bool> latency_report_;
+  LatencyStats latency_stats_;
 };
 
 } // namespace lidar
@@ -23,6 +23,7 @@
 //
 
 #include "debug_point_cloud_handler.h"
+#include "device_manager.h"
 
 #include "FastCRC/FastCRC.h"
 #include "spdlog/fmt/fmt.h"
@@ -145,7 +146,9 @@ bool DebugPointCloudHandler::Enable(bool enable) {
       thread_ptr_->join();
       thread_ptr_ = nullptr;
     }
-    thread_ptr_ = std::make_shared<std::thread>(&DebugPointCloudHandler::WriteData, this);
+    thread_ptr_ = ThreadBase::CreateThread(std::bind(&DebugPointCloudHandler::WriteData, this));
+    ThreadBase::ApplySchedule(*thread_ptr_,
+        DeviceManager::GetInstance().GetThreadSchedule(kThreadRoleDebugPointCloud));
   } else {
     cv_.notify_all();
   }
@@ -1,4 +1,5 @@
 #include "debug_point_cloud_manager.h"
+#include "sdk_context.h"
 
 #include "spdlog/fmt/fmt.h"
 
@@ -15,8 +16,7 @@ DebugPointCloudManager::~DebugPointCloudManager() {
 }
 
 DebugPointCloudManager& DebugPointCloudManager::GetInstance() {
-  static DebugPointCloudManager singleton;
-  return singleton;
+  return SdkContext::Current().GetDebugPointCloudManager();
 }
 
 void DebugPointCloudManager::AddDevice(const uint32_t handle, const DetectionData* detection_data) {
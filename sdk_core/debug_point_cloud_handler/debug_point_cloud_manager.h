@@ -56,6 +56,7 @@ class DebugPointCloudManager {
   static DebugPointCloudManager& GetInstance();
 
  private:
+  friend class SdkContext;
   DebugPointCloudManager();
 
  private:
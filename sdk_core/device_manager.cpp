@@ -29,7 +29,9 @@
 #endif
 #include "device_manager.h"
 
+#include <algorithm>
 #include <iostream>
+#include <limits>
 
 #include "comm/define.h"
 #include "comm/generate_seq.h"
@@ -39,10 +41,32 @@
 #include "data_handler/data_handler.h"
 #include "logger_handler/logger_manager.h"
 #include "debug_point_cloud_handler/debug_point_cloud_manager.h"
+#include "sdk_context.h"
+#include "base/rt_guard.h"
 
 namespace livox {
 namespace lidar {
 
+namespace {
+
+/** Threads that dispatch packets through the route table with a read slot of their own. */
+const uint32_t kMaxRouteReaders = 32;
+
+/** Route reader slot of the calling thread in the device manager whose serial matches. */
+typedef struct {
+  uint64_t serial;
+  uint32_t slot;
+} RouteReaderSlotCache;
+
+thread_local RouteReaderSlotCache route_reader_slot_cache = { 0, 0 };
+
+uint64_t NextRouteReaderSerial() {
+  static std::atomic<uint64_t> serial(1);
+  return serial.fetch_add(1);
+}
+
+} // namespace
+
 DeviceManager::DeviceManager()
     : sdk_framework_cfg_ptr_(nullptr),
       lidars_cfg_ptr_(nullptr),
@@ -51,25 +75,29 @@ DeviceManager::DeviceManager()
       detection_socket_(0),
       detection_broadcast_socket_(0),
       cmd_io_thread_(nullptr),
-      data_io_thread_(nullptr),
       detection_io_thread_(nullptr),
+      imu_io_thread_(nullptr),
+      route_readers_(kMaxRouteReaders),
+      route_table_(route_readers_),
+      route_reader_serial_(NextRouteReaderSerial()),
       comm_port_(nullptr),
-      is_stop_detection_(false),
-      detection_thread_(nullptr),
       is_view_(false),
       detection_host_ip_(""),
       enable_save_log_(false) {
+  route_reader_ids_.reserve(kMaxRouteReaders);
 }
 
 DeviceManager& DeviceManager::GetInstance() {
-  static DeviceManager device_manager;
-  return device_manager;
+  return SdkContext::Current().GetDeviceManager();
 }
 
 bool DeviceManager::Init(const std::string& host_ip, const LivoxLidarLoggerCfgInfo* log_cfg_info) {
   is_view_ = true;
   detection_host_ip_ = host_ip;
+  RebuildRouteTable();
   comm_port_.reset(new CommPort());
+  sdk_framework_cfg_ptr_.reset(new LivoxLidarSdkFrameworkCfg());
+  sdk_framework_cfg_ptr_->master_sdk = true;
 
   std::shared_ptr<LivoxLidarLoggerCfg> lidar_logger_cfg_ptr(new LivoxLidarLoggerCfg());
   if (log_cfg_info != nullptr) {
@@ -108,8 +136,7 @@ bool DeviceManager::Init(const std::string& host_ip, const LivoxLidarLoggerCfgIn
     return false;
   }
 
-  detection_thread_ = std::make_shared<std::thread>(&DeviceManager::DetectionLidars, this);
-  is_stop_detection_.store(false);
+  StartDetection();
   return true;
 }
 
@@ -159,6 +186,7 @@ bool DeviceManager::Init(std::shared_ptr<std::vector<LivoxLidarCfg>>& lidars_cfg
   }
 
   GetLidarConfigMap();
+  RebuildRouteTable();
 
   if (!CreateIOThread()) {
     LOG_ERROR("Create IO thread failed.");
@@ -171,8 +199,7 @@ bool DeviceManager::Init(std::shared_ptr<std::vector<LivoxLidarCfg>>& lidars_cfg
   }
 
   if (!(lidars_cfg_ptr_->empty()) || !(custom_lidars_cfg_ptr->empty())) {
-    detection_thread_ = std::make_shared<std::thread>(&DeviceManager::DetectionLidars, this);
-    is_stop_detection_.store(false);
+    StartDetection();
   }
 
   LOG_INFO("Init livox lidars succ.");
@@ -193,6 +220,10 @@ void DeviceManager::GetLidarConfigMap() {
 }
 
 bool DeviceManager::CreateIOThread() {
+  if (sdk_framework_cfg_ptr_->embedded_mode) {
+    return CreateEmbeddedIOLoop();
+  }
+
   if (!CreateDetectionIOThread()) {
     LOG_ERROR("Device manager init failed, create detection io thread failed.");
     return false;
@@ -216,6 +247,8 @@ bool DeviceManager::CreateDetectionIOThread() {
     LOG_ERROR("Create command io thread failed, thread_ptr is nullptr or thread init failed");
     return false;
   }
+  detection_io_thread_->GetLoop().lock()->GetRecvBufferPool().Init(kMaxBufferSize, 1);
+  detection_io_thread_->SetSchedule(GetThreadSchedule(kThreadRoleDetection));
   return detection_io_thread_->Start();
 }
 
@@ -225,16 +258,215 @@ bool DeviceManager::CreateCommandIOThread() {
     LOG_ERROR("Create command io thread failed, thread_ptr is nullptr or thread init failed");
     return false;
   }
+  cmd_io_thread_->GetLoop().lock()->GetRecvBufferPool().Init(kMaxBufferSize, 1);
+  cmd_io_thread_->SetSchedule(GetThreadSchedule(kThreadRoleCommand));
   return cmd_io_thread_->Start();
 }
 
 bool DeviceManager::CreateDataIOThread() {
-  data_io_thread_ = std::make_shared<IOThread>();
-  if (data_io_thread_ == nullptr || !(data_io_thread_->Init(true, false))) {
-    LOG_ERROR("Create command io thread failed, thread_ptr is nullptr or thread init failed");
+  // Before any data io thread starts, Handle reads the stats unguarded.
+  DataHandler::GetInstance().SetLatencyReport(sdk_framework_cfg_ptr_->data_latency_report,
+      sdk_framework_cfg_ptr_->data_busy_poll_spin_us > 0 ? "busy poll" : "blocking");
+  {
+    std::lock_guard<std::mutex> lock(data_io_groups_mutex_);
+    data_io_group_.host_ip.clear();
+    data_io_group_.if_name.clear();
+    data_io_group_.cpus.clear();
+    nic_data_io_groups_.clear();
+    if (!CreateDataIOGroup(data_io_group_)) {
+      return false;
+    }
+  }
+
+  imu_io_thread_ = nullptr;
+  if (sdk_framework_cfg_ptr_->imu_io_thread) {
+    imu_io_thread_ = CreateDataLoopThread();
+    if (imu_io_thread_ == nullptr) {
+      return false;
+    }
+    imu_io_thread_->SetSchedule(GetThreadSchedule(kThreadRoleImu));
+    if (!imu_io_thread_->Start()) {
+      return false;
+    }
+  }
+  if (sdk_framework_cfg_ptr_->data_io_per_nic) {
+    LOG_INFO("Data io threads are grouped per host interface, detection, command and imu io threads are shared.");
+  }
+  return true;
+}
+
+bool DeviceManager::CreateEmbeddedIOLoop() {
+  // Before the loop exists, so before Poll can deliver a packet.
+  DataHandler::GetInstance().SetLatencyReport(sdk_framework_cfg_ptr_->data_latency_report, "embedded");
+  std::shared_ptr<IOThread> io_thread = std::make_shared<IOThread>();
+  if (io_thread == nullptr || !(io_thread->Init(true, false))) {
+    LOG_ERROR("Create embedded io loop failed, thread_ptr is nullptr or loop init failed");
     return false;
   }
-  return data_io_thread_->Start();
+  uint32_t batch_size = std::min<uint32_t>(sdk_framework_cfg_ptr_->data_recv_batch_size, util::kMaxRecvBatchSize);
+  std::shared_ptr<IOLoop> loop = io_thread->GetLoop().lock();
+  loop->GetRecvBufferPool().Init(UseUdpGro() ? kMaxGroBufferSize : kMaxBufferSize, batch_size);
+  loop->SetExternalWait(true);
+
+  // The thread is never started, every role shares its loop.
+  detection_io_thread_ = io_thread;
+  cmd_io_thread_ = io_thread;
+  {
+    std::lock_guard<std::mutex> lock(data_io_groups_mutex_);
+    data_io_group_.host_ip.clear();
+    data_io_group_.if_name.clear();
+    data_io_group_.cpus.clear();
+    data_io_group_.threads.assign(1, io_thread);
+    data_io_group_.next_thread = 0;
+    nic_data_io_groups_.clear();
+  }
+  imu_io_thread_ = nullptr;
+  LOG_INFO("Embedded mode, no io thread is started, poll fd:{}. data_io_thread_num, data_io_uring, "
+           "data_busy_poll_spin_us, data_edge_triggered, imu_io_thread and data_io_per_nic are ignored.",
+           loop->GetPollFd());
+  return true;
+}
+
+std::shared_ptr<IOLoop> DeviceManager::GetEmbeddedIOLoop() {
+  if (!sdk_framework_cfg_ptr_ || !sdk_framework_cfg_ptr_->embedded_mode) {
+    return nullptr;
+  }
+  std::shared_ptr<IOThread> io_thread = cmd_io_thread_;
+  return io_thread ? io_thread->GetLoop().lock() : nullptr;
+}
+
+int DeviceManager::GetPollFd() {
+  std::shared_ptr<IOLoop> loop = GetEmbeddedIOLoop();
+  return loop ? loop->GetPollFd() : -1;
+}
+
+int DeviceManager::Poll(uint32_t max_events, int timeout_ms) {
+  std::shared_ptr<IOLoop> loop = GetEmbeddedIOLoop();
+  if (!loop) {
+    return -1;
+  }
+  // A negative timeout waits for an event, the loop still wakes up for its timers.
+  int timeout = timeout_ms < 0 ? std::numeric_limits<int>::max() : timeout_ms;
+  uint32_t handled = 0;
+  do {
+    int events = loop->Loop(timeout);
+    if (events <= 0) {
+      break;
+    }
+    handled += events;
+    timeout = 0;
+  } while (handled < max_events);
+  return static_cast<int>(handled);
+}
+
+int DeviceManager::GetPollTimeout() {
+  std::shared_ptr<IOLoop> loop = GetEmbeddedIOLoop();
+  return loop ? loop->NextTimeout(std::numeric_limits<int>::max()) : -1;
+}
+
+bool DeviceManager::CreateDataIOGroup(DataIOGroup& group) {
+  uint32_t thread_num = std::max<uint32_t>(sdk_framework_cfg_ptr_->data_io_thread_num, 1);
+  ThreadSchedule schedule = GetThreadSchedule(kThreadRoleData);
+  std::string name = schedule.name;
+  if (schedule.cpus.empty()) {
+    schedule.cpus = group.cpus;
+  }
+  group.threads.clear();
+  group.next_thread = 0;
+  for (uint32_t i = 0; i < thread_num; ++i) {
+    std::shared_ptr<IOThread> data_io_thread = CreateDataLoopThread();
+    if (data_io_thread == nullptr) {
+      return false;
+    }
+    schedule.name = name + std::to_string(nic_data_io_groups_.size()) + "_" + std::to_string(i);
+    data_io_thread->SetSchedule(schedule);
+    if (!data_io_thread->Start()) {
+      return false;
+    }
+    group.threads.push_back(data_io_thread);
+  }
+  return true;
+}
+
+DataIOGroup& DeviceManager::GetDataIOGroup(const std::string& host_ip) {
+  if (!sdk_framework_cfg_ptr_->data_io_per_nic || sdk_framework_cfg_ptr_->embedded_mode ||
+      host_ip.empty() || host_ip == "local") {
+    return data_io_group_;
+  }
+  auto it = nic_data_io_groups_.find(host_ip);
+  if (it != nic_data_io_groups_.end()) {
+    return it->second;
+  }
+
+  DataIOGroup& group = nic_data_io_groups_[host_ip];
+  group.host_ip = host_ip;
+  if (!util::GetInterfaceTopology(host_ip, group.if_name, group.cpus)) {
+    LOG_WARN("Find the interface of host ip {} failed, its data io threads are not pinned", host_ip.c_str());
+  }
+  if (!CreateDataIOGroup(group)) {
+    LOG_WARN("Create data io group of host ip {} failed, use the default data io threads", host_ip.c_str());
+    nic_data_io_groups_.erase(host_ip);
+    return data_io_group_;
+  }
+  std::string cpus;
+  for (int cpu : group.cpus) {
+    cpus += (cpus.empty() ? "" : ",") + std::to_string(cpu);
+  }
+  LOG_INFO("Data io group, host_ip:{}, interface:{}, threads:{}, cpus:{}", host_ip.c_str(),
+           group.if_name.empty() ? "unknown" : group.if_name.c_str(), group.threads.size(),
+           cpus.empty() ? "any" : cpus.c_str());
+  return group;
+}
+
+std::vector<std::shared_ptr<IOThread>> DeviceManager::GetDataIOThreads(const std::string& host_ip) {
+  std::lock_guard<std::mutex> lock(data_io_groups_mutex_);
+  return GetDataIOGroup(host_ip).threads;
+}
+
+ThreadSchedule DeviceManager::GetThreadSchedule(const ThreadRole role) const {
+  static const char* const kDefaultNames[kThreadRoleNum] = {
+    "livox_detect", "livox_cmd", "livox_data", "livox_imu", "livox_logger", "livox_dbg_pcl", "livox_log_clean",
+    "livox_dlv"
+  };
+  ThreadSchedule schedule;
+  if (sdk_framework_cfg_ptr_ && role < static_cast<ThreadRole>(sdk_framework_cfg_ptr_->thread_schedules.size())) {
+    schedule = sdk_framework_cfg_ptr_->thread_schedules[role];
+  }
+  if (schedule.name.empty()) {
+    schedule.name = kDefaultNames[role];
+  }
+  return schedule;
+}
+
+std::shared_ptr<IOThread> DeviceManager::CreateDataLoopThread() {
+  uint32_t batch_size = std::min<uint32_t>(sdk_framework_cfg_ptr_->data_recv_batch_size, util::kMaxRecvBatchSize);
+  MultipleIOType io_type = sdk_framework_cfg_ptr_->data_io_uring ? kMultipleIOUring : kMultipleIODefault;
+  std::shared_ptr<IOThread> data_io_thread = std::make_shared<IOThread>();
+  if (data_io_thread == nullptr || !(data_io_thread->Init(false, false, io_type))) {
+    LOG_ERROR("Create data io thread failed, thread_ptr is nullptr or thread init failed");
+    return nullptr;
+  }
+  std::shared_ptr<IOLoop> loop = data_io_thread->GetLoop().lock();
+  loop->GetRecvBufferPool().Init(UseUdpGro() ? kMaxGroBufferSize : kMaxBufferSize, batch_size);
+  loop->SetBusyPoll(sdk_framework_cfg_ptr_->data_busy_poll_spin_us);
+  loop->SetEdgeTriggered(sdk_framework_cfg_ptr_->data_edge_triggered);
+  return data_io_thread;
+}
+
+std::shared_ptr<IOThread> DeviceManager::NextDataIOThread(const std::string& host_ip) {
+  std::lock_guard<std::mutex> lock(data_io_groups_mutex_);
+  DataIOGroup& group = GetDataIOGroup(host_ip);
+  if (group.threads.empty()) {
+    return nullptr;
+  }
+  return group.threads[group.next_thread++ % group.threads.size()];
+}
+
+std::shared_ptr<IOThread> DeviceManager::DataIOThreadFor(const HostSocketType type, const std::string& host_ip) {
+  if (type == kImuData && imu_io_thread_) {
+    return imu_io_thread_;
+  }
+  return NextDataIOThread(host_ip);
 }
 
 bool DeviceManager::CreateChannel() {
@@ -249,6 +481,10 @@ bool DeviceManager::CreateChannel() {
       LOG_ERROR("Create data channel failed.");
       return false;
     }
+    CreateLidarDataChannel(host_net_info.host_ip, host_net_info.multicast_ip,
+                           inet_addr(it->lidar_net_info.lidar_ipaddr.c_str()), it->device_type,
+                           host_net_info.point_data_port, it->lidar_net_info.point_data_port,
+                           host_net_info.imu_data_port, it->lidar_net_info.imu_data_port);
 
     if (!CreateCommandChannel(it->device_type, host_net_info)) {
       LOG_ERROR("Create command channel failed.");
@@ -261,21 +497,23 @@ bool DeviceManager::CreateChannel() {
 bool DeviceManager::CreateDetectionChannel() {
 #ifdef WIN32
 #else
-  detection_broadcast_socket_ = util::CreateSocket(kDetectionPort, true, true, true, "255.255.255.255", "");
+  detection_broadcast_socket_ = util::CreateSocket(kDetectionPort, true, true, true, "255.255.255.255", "", false,
+                                                    sdk_framework_cfg_ptr_->control_rcvbuf_size);
   if (detection_broadcast_socket_ < 0) {
     LOG_ERROR("Create detection broadcast socket failed.");
     return false;
   }
-  detection_io_thread_->GetLoop().lock()->AddDelegate(detection_broadcast_socket_, this, nullptr);
+  AddSocketDelegate(detection_io_thread_, detection_broadcast_socket_, kDetection);
 #endif
 
   std::string key = detection_host_ip_ + ":" + std::to_string(kDetectionPort);
-  detection_socket_ = util::CreateSocket(kDetectionPort, true, true, true, detection_host_ip_, "");
+  detection_socket_ = util::CreateSocket(kDetectionPort, true, true, true, detection_host_ip_, "", false,
+                                         sdk_framework_cfg_ptr_->control_rcvbuf_size);
   if (detection_socket_ < 0) {
     LOG_ERROR("Create detection socket failed.");
     return false;
   }
-  detection_io_thread_->GetLoop().lock()->AddDelegate(detection_socket_, this, nullptr);
+  AddSocketDelegate(detection_io_thread_, detection_socket_, kDetection);
 
   channel_info_[key] = detection_socket_;
   if (custom_command_channel_.find(key) == custom_command_channel_.end()) {
@@ -286,20 +524,25 @@ bool DeviceManager::CreateDetectionChannel() {
 }
 
 bool DeviceManager::CreateDataChannel(const HostNetInfo& host_net_info) {
-  if (!CreateDataSocketAndAddDelegate(host_net_info.host_ip, host_net_info.point_data_port, host_net_info.multicast_ip)) {
+  if (!CreateDataSocketAndAddDelegate(host_net_info.host_ip, host_net_info.point_data_port, host_net_info.multicast_ip, kPointCloud)) {
     LOG_ERROR("Create socket and add delegate failed.");
     return false;
   }
 
-  if (!CreateDataSocketAndAddDelegate(host_net_info.host_ip, host_net_info.imu_data_port, host_net_info.multicast_ip)) {
+  if (!CreateDataSocketAndAddDelegate(host_net_info.host_ip, host_net_info.imu_data_port, host_net_info.multicast_ip, kImuData)) {
     LOG_ERROR("Create socket and add delegate failed.");
     return false;
   }
 
-  if (!CreateDataSocketAndAddDelegate(host_net_info.host_ip, kHostDebugPointCloudPort, host_net_info.multicast_ip)) {
+  if (!CreateDataSocketAndAddDelegate(host_net_info.host_ip, kHostDebugPointCloudPort, host_net_info.multicast_ip, kDebugPointCloud)) {
     LOG_ERROR("Create debug point cloud socket and add delegate failed.");
     return false;
   }
+
+  // The sockets above stay in place, they receive whatever the XDP program passes on to the stack.
+  if (sdk_framework_cfg_ptr_->data_ingest == kDataIngestAfXdp && !CreateXdpChannel(host_net_info)) {
+    LOG_WARN("Create AF_XDP channel failed, receive from the sockets, the ip {}", host_net_info.host_ip.c_str());
+  }
   return true;
 }
 
@@ -327,13 +570,14 @@ bool DeviceManager::CreateCommandChannel(const uint8_t dev_type, const HostNetIn
 #ifdef WIN32
 #else
   if (dev_type == kLivoxLidarTypeMid360 || dev_type == kLivoxLidarTypeMid360s || dev_type == kLivoxLidarTypeAvia2) {
-    socket_t broadcast_socket = util::CreateSocket(host_net_info.push_msg_port, true, true, true, "255.255.255.255", "");
+    socket_t broadcast_socket = util::CreateSocket(host_net_info.push_msg_port, true, true, true, "255.255.255.255", "",
+                                                   false, sdk_framework_cfg_ptr_->control_rcvbuf_size);
     if (broadcast_socket < 0) {
       LOG_ERROR("Create broadcast socket failed.");
       return false;
     }
     vec_broadcast_socket_.push_back(broadcast_socket);
-    cmd_io_thread_->GetLoop().lock()->AddDelegate(broadcast_socket, this, nullptr);
+    AddSocketDelegate(cmd_io_thread_, broadcast_socket, kPush);
   }
 #endif
 
@@ -364,9 +608,9 @@ bool DeviceManager::CreateCmdSocketAndAddDelegate(const uint8_t dev_type, const
 
   socket_t sock = -1;
   if (host_ip == "local") {
-    sock = util::CreateSocket(port, true, true, true, "", "");
+    sock = util::CreateSocket(port, true, true, true, "", "", false, sdk_framework_cfg_ptr_->control_rcvbuf_size);
   } else {
-    sock = util::CreateSocket(port, true, true, true, host_ip, "");
+    sock = util::CreateSocket(port, true, true, true, host_ip, "", false, sdk_framework_cfg_ptr_->control_rcvbuf_size);
   }
 
   if (sock < 0) {
@@ -380,11 +624,12 @@ bool DeviceManager::CreateCmdSocketAndAddDelegate(const uint8_t dev_type, const
   command_channel_.insert(sock); 
   custom_command_channel_[key] = sock;
 
-  cmd_io_thread_->GetLoop().lock()->AddDelegate(sock, this, nullptr);
+  AddSocketDelegate(cmd_io_thread_, sock, type);
   return true;
 }
 
-bool DeviceManager::CreateDataSocketAndAddDelegate(const std::string& host_ip, const uint16_t port, const std::string& multicast_ip) {
+bool DeviceManager::CreateDataSocketAndAddDelegate(const std::string& host_ip, const uint16_t port,
+                                                   const std::string& multicast_ip, const HostSocketType type) {
   if (host_ip.empty() || port == 0 || port == kLogPort || port == kDetectionPort) {
     return true;
   }
@@ -394,12 +639,27 @@ bool DeviceManager::CreateDataSocketAndAddDelegate(const std::string& host_ip, c
     return true;
   }
 
-  socket_t sock = -1;
-  if (host_ip == "local") {
-    sock = util::CreateSocket(port, true, true, false, "", multicast_ip);
-  } else {
-    sock = util::CreateSocket(port, true, true, false, host_ip, multicast_ip);
+  std::string netif = (host_ip == "local") ? "" : host_ip;
+  if (sdk_framework_cfg_ptr_->data_ingest == kDataIngestPacketMmap && (type == kPointCloud || type == kImuData)) {
+    if (CreatePacketRingChannel(netif, port, multicast_ip, type)) {
+      channel_info_[key] = socket_vec_.back();
+      return true;
+    }
+    LOG_WARN("Create packet ring failed, receive from the socket, the ip {} port {}", host_ip.c_str(), port);
   }
+
+  // Multicast datagrams are delivered to every socket of a reuseport group, so only unicast streams are sharded.
+  // The imu stream has a thread of its own when imu_io_thread is set, there is nothing to shard it over.
+  if (GetDataIOThreads(netif).size() > 1 && multicast_ip.empty() &&
+      (type == kPointCloud || (type == kImuData && !imu_io_thread_))) {
+    if (CreateShardedDataSockets(netif, port, type)) {
+      channel_info_[key] = socket_vec_.back();
+      return true;
+    }
+    LOG_WARN("Shard data channel failed, use a single socket, the ip {} port {}", host_ip.c_str(), port);
+  }
+
+  socket_t sock = util::CreateSocket(port, true, true, false, netif, multicast_ip, false, sdk_framework_cfg_ptr_->data_rcvbuf_size);
   if (sock < 0) {
     LOG_ERROR("Add command channel faileld, can not create socket, the ip {} port {} ", host_ip.c_str(), port);
     return false;
@@ -408,15 +668,215 @@ bool DeviceManager::CreateDataSocketAndAddDelegate(const std::string& host_ip, c
   channel_info_[key] = sock;  
 
   data_channel_.insert(sock);
-  data_io_thread_->GetLoop().lock()->AddDelegate(sock, this, nullptr);
+  // The debug point cloud manager is not thread safe, keep its channel on the first data io thread.
+  std::shared_ptr<IOThread> io_thread;
+  if (type == kDebugPointCloud) {
+    std::vector<std::shared_ptr<IOThread>> threads = GetDataIOThreads("");
+    io_thread = threads.empty() ? nullptr : threads[0];
+  } else {
+    io_thread = DataIOThreadFor(type, netif);
+  }
+  AddSocketDelegate(io_thread, sock, type);
   return true;
 }
 
-void DeviceManager::DetectionLidars() {
-  while (!is_stop_detection_) {
-    Detection();
-    std::this_thread::sleep_for(std::chrono::seconds(1));
+bool DeviceManager::CreatePacketRingChannel(const std::string& netif, const uint16_t port,
+                                            const std::string& multicast_ip, const HostSocketType type) {
+  std::unique_ptr<PacketRing> packet_ring(new PacketRing());
+  if (!packet_ring->Open(netif, port)) {
+    return false;
   }
+
+  // The socket only keeps the port bound and the multicast group joined, the ring receives the data.
+  socket_t sock = util::CreateSocket(port, true, true, false, netif, multicast_ip, false, sdk_framework_cfg_ptr_->control_rcvbuf_size);
+  if (sock < 0) {
+    return false;
+  }
+  util::AttachDropFilter(sock);
+  socket_vec_.push_back(sock);
+
+  socket_t ring_fd = packet_ring->GetFd();
+  data_channel_.insert(ring_fd);
+  AddSocketDelegate(DataIOThreadFor(type, netif), ring_fd, type, packet_ring.get());
+  packet_captures_.push_back(std::move(packet_ring));
+  return true;
+}
+
+bool DeviceManager::CreateXdpChannel(const HostNetInfo& host_net_info) {
+  if (host_net_info.host_ip == "local") {
+    return false;
+  }
+  // Only the point stream is redirected, the imu port stays on its socket and is accounted under its own role.
+  const uint16_t port = host_net_info.point_data_port;
+  auto it = xdp_sockets_.find(host_net_info.host_ip);
+  if (it != xdp_sockets_.end()) {
+    return it->second->HasPort(port);
+  }
+
+  const uint32_t queue_id = sdk_framework_cfg_ptr_->xdp_queue_id;
+  std::unique_ptr<XdpSocket> xdp_socket(new XdpSocket());
+  if (!xdp_socket->Open(host_net_info.host_ip, queue_id, std::vector<uint16_t>(1, port))) {
+    return false;
+  }
+  // The program passes the datagrams of every other rx queue on to the socket of the port.
+  uint32_t queue_num = xdp_socket->GetRxQueueNum();
+  LOG_INFO("AF_XDP socket of {} redirects the point data port {} on rx queue {} of {}", host_net_info.host_ip,
+           port, queue_id, queue_num);
+  if (queue_num > 1) {
+    LOG_WARN("Point data hashed to the {} other rx queues of {} is received from the socket, steer the lidars to "
+             "rx queue {} to redirect all of it", queue_num - 1, host_net_info.host_ip, queue_id);
+  }
+
+  socket_t xsk_fd = xdp_socket->GetFd();
+  data_channel_.insert(xsk_fd);
+  AddSocketDelegate(NextDataIOThread(host_net_info.host_ip), xsk_fd, kPointCloud, xdp_socket.get());
+  xdp_sockets_[host_net_info.host_ip] = xdp_socket.get();
+  packet_captures_.push_back(std::move(xdp_socket));
+  return true;
+}
+
+void DeviceManager::CreateLidarDataChannel(const std::string& host_ip, const std::string& multicast_ip,
+                                           const uint32_t handle, const uint8_t dev_type,
+                                           const uint16_t host_point_port, const uint16_t lidar_point_port,
+                                           const uint16_t host_imu_port, const uint16_t lidar_imu_port) {
+  // Multicast datagrams reach every matching socket and captures bypass the sockets, keep the shared socket then.
+  if (!sdk_framework_cfg_ptr_->data_connected_sockets || sdk_framework_cfg_ptr_->data_ingest != kDataIngestSocket ||
+      !multicast_ip.empty() || host_ip.empty() || handle == 0 || handle == INADDR_NONE) {
+    return;
+  }
+  if (!CreateConnectedDataSocket(host_ip, host_point_port, handle, lidar_point_port, dev_type, kPointCloud)) {
+    LOG_WARN("Create connected point data socket failed, use the shared socket, the handle {}", handle);
+  }
+  if (!CreateConnectedDataSocket(host_ip, host_imu_port, handle, lidar_imu_port, dev_type, kImuData)) {
+    LOG_WARN("Create connected imu data socket failed, use the shared socket, the handle {}", handle);
+  }
+}
+
+bool DeviceManager::CreateConnectedDataSocket(const std::string& host_ip, const uint16_t host_port,
+                                              const uint32_t handle, const uint16_t lidar_port,
+                                              const uint8_t dev_type, const HostSocketType type) {
+  if (host_port == 0 || lidar_port == 0) {
+    return true;
+  }
+  std::pair<uint32_t, uint16_t> key(handle, host_port);
+  if (lidar_data_channel_.find(key) != lidar_data_channel_.end()) {
+    return true;
+  }
+
+  // SO_REUSEADDR lets it share the port with the unconnected socket, which keeps serving unknown sources.
+  std::string netif = (host_ip == "local") ? "" : host_ip;
+  socket_t sock = util::CreateSocket(host_port, true, true, false, netif, "", false, sdk_framework_cfg_ptr_->data_rcvbuf_size);
+  if (sock < 0) {
+    return false;
+  }
+  if (!util::ConnectSocket(sock, handle, lidar_port)) {
+    util::CloseSock(sock);
+    return false;
+  }
+  socket_vec_.push_back(sock);
+  data_channel_.insert(sock);
+  lidar_data_channel_.insert(key);
+  AddSocketDelegate(DataIOThreadFor(type, netif), sock, type, nullptr, handle, dev_type);
+  return true;
+}
+
+bool DeviceManager::CreateShardedDataSockets(const std::string& netif, const uint16_t port, const HostSocketType type) {
+  std::vector<std::shared_ptr<IOThread>> threads = GetDataIOThreads(netif);
+  std::vector<socket_t> socks;
+  for (size_t i = 0; i < threads.size(); ++i) {
+    socket_t sock = util::CreateSocket(port, true, true, false, netif, "", true, sdk_framework_cfg_ptr_->data_rcvbuf_size);
+    if (sock < 0) {
+      for (socket_t created : socks) {
+        util::CloseSock(created);
+      }
+      return false;
+    }
+    socks.push_back(sock);
+  }
+
+  // Without the steering program the kernel still hashes every lidar flow onto one socket.
+  if (!util::AttachReusePortSteering(socks[0], static_cast<uint32_t>(socks.size()))) {
+    LOG_INFO("Attach reuseport steering failed, fall back to flow hash, the port {}", port);
+  }
+
+  for (size_t i = 0; i < socks.size(); ++i) {
+    socket_vec_.push_back(socks[i]);
+    data_channel_.insert(socks[i]);
+    AddSocketDelegate(threads[i], socks[i], type);
+  }
+  return true;
+}
+
+bool DeviceManager::AddSocketDelegate(const std::shared_ptr<IOThread>& io_thread, const socket_t sock,
+                                      const HostSocketType type, PacketCapture* capture, const uint32_t handle,
+                                      const uint8_t dev_type) {
+  if (!io_thread) {
+    return false;
+  }
+  std::shared_ptr<IOLoop> loop = io_thread->GetLoop().lock();
+  if (!loop) {
+    return false;
+  }
+  std::lock_guard<std::mutex> lock(socket_contexts_mutex_);
+  std::unique_ptr<SocketContext>& context = socket_contexts_[sock];
+  context.reset(new SocketContext());
+  context->sock = sock;
+  context->type = type;
+  context->recv_buffer_pool = &loop->GetRecvBufferPool();
+  context->loop = loop;
+  context->capture = capture;
+  if (capture != nullptr) {
+    context->capture_callback = [this](uint32_t handle, uint16_t port, uint8_t* buf, uint32_t size,
+                                       uint64_t timestamp) {
+      DispatchPacket(handle, port, buf, size, timestamp);
+    };
+  }
+  context->handle = handle;
+  context->dev_type = dev_type;
+  context->kernel_drops.store(0);
+  context->recv_buffer_size.store(util::GetRecvBufferSize(sock));
+  context->recv_buffer_capped = false;
+  bool direct_recv = capture == nullptr && (type == kPointCloud || type == kImuData || type == kDebugPointCloud);
+  if (direct_recv) {
+    SetDataSocketOption(sock);
+  }
+  loop->AddDelegate(sock, this, context.get(), direct_recv);
+  return true;
+}
+
+bool DeviceManager::UseUdpGro() const {
+  // io_uring provided buffers are sized for single datagrams, a coalesced one would be truncated.
+  return sdk_framework_cfg_ptr_->data_udp_gro && !sdk_framework_cfg_ptr_->data_io_uring;
+}
+
+void DeviceManager::SetDataSocketOption(const socket_t sock) {
+  if (!util::EnableRxDropCount(sock)) {
+    LOG_INFO("Enable SO_RXQ_OVFL failed, kernel drops of socket {} are not counted", sock);
+  }
+  if (!util::EnableRxTimestamp(sock)) {
+    LOG_INFO("Enable rx timestamp failed, the packets of socket {} carry no kernel receive time", sock);
+  }
+  if (UseUdpGro() && !util::EnableUdpGro(sock)) {
+    LOG_INFO("Enable UDP_GRO failed, socket {} receives one datagram at a time", sock);
+  }
+  if ((sdk_framework_cfg_ptr_->data_socket_busy_poll_us > 0 || sdk_framework_cfg_ptr_->data_prefer_busy_poll) &&
+      !util::SetBusyPoll(sock, sdk_framework_cfg_ptr_->data_socket_busy_poll_us,
+                         sdk_framework_cfg_ptr_->data_prefer_busy_poll)) {
+    LOG_WARN("Set busy poll failed on socket {}, it may need CAP_NET_ADMIN", sock);
+  }
+}
+
+void DeviceManager::StartDetection() {
+  std::shared_ptr<IOLoop> loop = detection_io_thread_->GetLoop().lock();
+  if (!loop) {
+    return;
+  }
+  // Broadcast a search right away, then once per interval from the detection loop timer.
+  IOLoop* detection_loop = loop.get();
+  loop->PostTask([this, detection_loop]() {
+    Detection();
+    detection_loop->AddTimer(kDetectionIntervalMs, [this]() { Detection(); }, kDetectionIntervalMs);
+  });
 }
 
 void DeviceManager::Detection() {
@@ -432,16 +892,16 @@ void DeviceManager::Detection() {
   packet.data = req_buff;
   packet.data_len = 0;
 
-  std::vector<uint8_t> buf(kMaxCommandBufferSize + 1);
+  uint8_t buf[kMaxCommandBufferSize + 1];
   int size = 0;
-  comm_port_->Pack(buf.data(), kMaxCommandBufferSize, (uint32_t *)&size, packet);
+  comm_port_->Pack(buf, kMaxCommandBufferSize, (uint32_t *)&size, packet);
 
   struct sockaddr_in servaddr;
   servaddr.sin_family = AF_INET;
   servaddr.sin_addr.s_addr = inet_addr("255.255.255.255");
   servaddr.sin_port = htons(kDetectionPort);
 
-  int byte_send = sendto(detection_socket_, (const char*)buf.data(), size, 0,
+  int byte_send = sendto(detection_socket_, (const char*)buf, size, 0,
       (const struct sockaddr *) &servaddr, sizeof(servaddr));
   if (byte_send < 0) {
     LOG_INFO("Detection lidars failed, Send to lidar failed.");
@@ -449,81 +909,303 @@ void DeviceManager::Detection() {
 }
 
 void DeviceManager::OnData(socket_t sock, void *client_data) {
-  struct sockaddr addr;
-  int addrlen = sizeof(addr);
+  SocketContext* context = static_cast<SocketContext*>(client_data);
+  if (context == nullptr || context->recv_buffer_pool == nullptr) {
+    return;
+  }
+  if (context->capture != nullptr) {
+    RtAllocTripwire::Scope rt_scope;
+    context->capture->Read(context->capture_callback);
+    return;
+  }
+  RecvBufferPool& recv_buffer_pool = *context->recv_buffer_pool;
 
-  std::unique_ptr<char[]> buf = nullptr;
-  if (buf.get() == NULL) {
-    buf.reset(new char[kMaxBufferSize]);
+  if (context->type == kPointCloud || context->type == kImuData || context->type == kDebugPointCloud) {
+    RtAllocTripwire::Scope rt_scope;
+    OnDataBatch(sock, *context);
+    return;
   }
 
-  int size = util::RecvFrom(sock, reinterpret_cast<char *>(buf.get()), kMaxBufferSize, 0, &addr, &addrlen);
+  struct sockaddr addr;
+  int addrlen = sizeof(addr);
+  uint8_t* buf = recv_buffer_pool.GetBuffer(0);
+  int size = util::RecvFrom(sock, buf, recv_buffer_pool.GetBufferSize(), 0, &addr, &addrlen);
   if (size <= 0) {
     return;
   }
 
   uint32_t handle = ((struct sockaddr_in *)&addr)->sin_addr.s_addr;
   uint16_t port = ntohs(((struct sockaddr_in *)&addr)->sin_port);
+  DispatchPacket(handle, port, buf, size);
+}
 
-  struct in_addr tmp_addr;
-  tmp_addr.s_addr = handle;
-  std::string lidar_ip = inet_ntoa(tmp_addr);
+void DeviceManager::OnRecv(socket_t, void *client_data, const util::RecvMsg& msg) {
+  SocketContext* context = static_cast<SocketContext*>(client_data);
+  if (context == nullptr) {
+    return;
+  }
+  RtAllocTripwire::Scope rt_scope;
+  HandleRecvMsg(*context, msg);
+}
+
+bool DeviceManager::OnDrain(socket_t sock, void *client_data) {
+  SocketContext* context = static_cast<SocketContext*>(client_data);
+  if (context == nullptr || context->recv_buffer_pool == nullptr || context->capture != nullptr) {
+    OnData(sock, client_data);
+    return false;
+  }
+  RtAllocTripwire::Scope rt_scope;
+  return OnDataBatch(sock, *context);
+}
+
+bool DeviceManager::OnDataBatch(socket_t sock, SocketContext& context) {
+  // Drain the socket, a short batch means the receive queue is empty. The budget keeps one busy
+  // socket from starving the others served by the loop, return true if it ran out first.
+  util::RecvMsg* msgs = context.recv_buffer_pool->GetRecvMsgs();
+  uint32_t budget = sdk_framework_cfg_ptr_->data_drain_budget;
+  uint32_t consumed = 0;
+  while (consumed < budget) {
+    int count = static_cast<int>(std::min<uint32_t>(context.recv_buffer_pool->GetBufferNum(), budget - consumed));
+    int received = util::RecvBatchFrom(sock, msgs, count);
+    for (int i = 0; i < received; ++i) {
+      HandleRecvMsg(context, msgs[i]);
+    }
+    if (received < count) {
+      return false;
+    }
+    consumed += static_cast<uint32_t>(received);
+  }
+  return true;
+}
 
-  if (lidar_ip == detection_host_ip_) {
+void DeviceManager::HandleRecvMsg(SocketContext& context, const util::RecvMsg& msg) {
+  // The kernel reports the cumulative drop counter of the socket with every datagram once it is non zero.
+  if (msg.drops != 0 && msg.drops != context.kernel_drops.load(std::memory_order_relaxed)) {
+    uint32_t previous = context.kernel_drops.exchange(msg.drops, std::memory_order_relaxed);
+    OnKernelDrops(context, msg.drops - previous);
+  }
+  if (msg.size <= 0) {
     return;
   }
 
-  if (port == kMid360LidarDebugPointCloudPort || port == kHAPDebugPointCloudPort) {
-    DebugPointCloudManager::GetInstance().Handler(handle, port, (uint8_t*)(buf.get()), size);
+  // Split a UDP_GRO coalesced buffer back into the datagrams sent by the lidar.
+  uint32_t size = static_cast<uint32_t>(msg.size);
+  uint32_t segment_size = msg.gso_size > 0 ? msg.gso_size : size;
+  for (uint32_t offset = 0; offset < size; offset += segment_size) {
+    DispatchData(context, msg.addr.sin_addr.s_addr, ntohs(msg.addr.sin_port), (uint8_t*)(msg.buf) + offset,
+                 std::min(segment_size, size - offset), msg.timestamp);
   }
+}
 
-  if (port == kHAPLogPort || port == kPaLidarLogPort || port == kMid360LidarLogPort) {
-    LoggerManager::GetInstance().Handler(handle, port, (uint8_t*)(buf.get()), size);
+void DeviceManager::OnKernelDrops(SocketContext& context, const uint32_t drops) {
+  uint32_t max_size = sdk_framework_cfg_ptr_->data_rcvbuf_max_size;
+  uint32_t granted = context.recv_buffer_size.load(std::memory_order_relaxed);
+  // The kernel reports twice the requested size to account for its bookkeeping overhead.
+  uint32_t requested = granted / 2;
+  bool grown = false;
+  if (!context.recv_buffer_capped && max_size > requested) {
+    uint32_t size = (requested > max_size / 2) ? max_size : requested * 2;
+    // Without CAP_NET_ADMIN SO_RCVBUF succeeds but silently clamps to net.core.rmem_max.
+    uint32_t previous = granted;
+    if (util::SetRecvBufferSize(context.sock, size)) {
+      granted = util::GetRecvBufferSize(context.sock);
+      context.recv_buffer_size.store(granted, std::memory_order_relaxed);
+    }
+    grown = granted > previous;
+    context.recv_buffer_capped = !grown;
   }
 
-  if (is_view_) {
-    std::shared_ptr<ViewLidarIpInfo> view_lidar_info_ptr = nullptr;
-    {
-      std::lock_guard<std::mutex> lock(view_lidars_info_mutex_);
-      if (view_lidars_info_.find(handle) != view_lidars_info_.end()) {
-        view_lidar_info_ptr = view_lidars_info_[handle];
-      }
+  TimePoint now = std::chrono::steady_clock::now();
+  if (now - context.last_drop_log >= std::chrono::seconds(1)) {
+    context.last_drop_log = now;
+    if (grown) {
+      LOG_INFO("Grow the receive buffer of socket {} to {} bytes after kernel drops", context.sock, granted);
+    }
+    LOG_WARN("Socket {} overflowed, the kernel dropped {} more datagrams, {} in total, receive buffer {} bytes{}",
+             context.sock, drops, context.kernel_drops.load(std::memory_order_relaxed),
+             context.recv_buffer_size.load(std::memory_order_relaxed),
+             context.recv_buffer_capped ? ", capped by the kernel" : "");
+  }
+}
+
+uint32_t DeviceManager::GetDataSocketStats(LivoxLidarSocketStats* stats, uint32_t max_num) {
+  if (stats == nullptr) {
+    return 0;
+  }
+  uint32_t num = 0;
+  std::lock_guard<std::mutex> lock(socket_contexts_mutex_);
+  for (const auto& item : socket_contexts_) {
+    const SocketContext& context = *item.second;
+    if (num >= max_num) {
+      break;
+    }
+    if (context.capture != nullptr ||
+        (context.type != kPointCloud && context.type != kImuData && context.type != kDebugPointCloud)) {
+      continue;
+    }
+    struct sockaddr_in addr;
+    socklen_t addr_len = sizeof(addr);
+    memset(&addr, 0, sizeof(addr));
+    getsockname(context.sock, (struct sockaddr*)&addr, &addr_len);
+
+    LivoxLidarSocketStats& stat = stats[num++];
+    stat.host_port = ntohs(addr.sin_port);
+    stat.lidar_handle = context.handle;
+    stat.recv_buffer_size = context.recv_buffer_size.load(std::memory_order_relaxed);
+    stat.kernel_drops = context.kernel_drops.load(std::memory_order_relaxed);
+  }
+  return num;
+}
+
+void DeviceManager::DispatchData(const SocketContext& context, const uint32_t handle, const uint16_t port,
+                                 uint8_t* buf, const uint32_t size, const uint64_t timestamp) {
+  // A connected socket only receives from its lidar, the kernel has already done the routing.
+  if (context.handle != 0) {
+    DataHandler::GetInstance().Handle(context.dev_type, context.handle, buf, size, timestamp);
+    return;
+  }
+  DispatchPacket(handle, port, buf, size, timestamp);
+}
+
+static bool IsDebugPointCloudPort(const uint16_t port) {
+  return port == kMid360LidarDebugPointCloudPort || port == kHAPDebugPointCloudPort;
+}
+
+static bool IsLogPort(const uint16_t port) {
+  return port == kHAPLogPort || port == kPaLidarLogPort || port == kMid360LidarLogPort;
+}
+
+static void AddRoute(std::vector<RouteEntry>& entries, const uint32_t ip, const uint16_t port, const uint8_t dev_type,
+                     uint8_t targets) {
+  if (port != kRouteAnyPort) {
+    if (IsDebugPointCloudPort(port)) {
+      targets |= kRouteDebugPointCloud;
     }
+    if (IsLogPort(port)) {
+      targets |= kRouteLog;
+    }
+  }
+  RouteEntry entry = { ip, port, dev_type, targets };
+  entries.push_back(entry);
+}
 
-    if (view_lidar_info_ptr != nullptr) {
-      if (port == view_lidar_info_ptr->lidar_point_port || port == view_lidar_info_ptr->lidar_imu_data_port) {
-        DataHandler::GetInstance().Handle(view_lidar_info_ptr->dev_type, handle, (uint8_t*)(buf.get()), size);
-      } else {
-        GeneralCommandHandler::GetInstance().Handler(view_lidar_info_ptr->dev_type, handle, port, (uint8_t*)(buf.get()), size);
+void DeviceManager::RebuildRouteTable() {
+  std::lock_guard<std::mutex> lock(route_table_mutex_);
+  std::vector<RouteEntry> entries;
+  for (const auto& item : custom_lidars_cfg_map_) {
+    const uint32_t ip = item.first;
+    const LivoxLidarCfg& lidar_cfg = item.second;
+    const LivoxLidarNetInfo& net_info = lidar_cfg.lidar_net_info;
+    AddRoute(entries, ip, kRouteAnyPort, lidar_cfg.device_type, 0);
+    AddRoute(entries, ip, net_info.point_data_port, lidar_cfg.device_type, kRouteData);
+    AddRoute(entries, ip, net_info.imu_data_port, lidar_cfg.device_type, kRouteData);
+    AddRoute(entries, ip, kDetectionPort, lidar_cfg.device_type, kRouteCommand);
+    AddRoute(entries, ip, net_info.cmd_data_port, lidar_cfg.device_type, kRouteCommand);
+    AddRoute(entries, ip, net_info.push_msg_port, lidar_cfg.device_type, kRouteCommand);
+    AddRoute(entries, ip, net_info.log_data_port, lidar_cfg.device_type, kRouteCommand);
+    AddRoute(entries, ip, kPaLidarFaultPort, lidar_cfg.device_type, kRouteCommand);
+  }
+  {
+    std::lock_guard<std::mutex> view_lock(view_lidars_info_mutex_);
+    for (const auto& item : view_lidars_info_) {
+      const std::shared_ptr<ViewLidarIpInfo>& view_lidar_info_ptr = item.second;
+      if (view_lidar_info_ptr == nullptr) {
+        continue;
       }
+      AddRoute(entries, item.first, kRouteAnyPort, view_lidar_info_ptr->dev_type, kRouteCommand);
+      AddRoute(entries, item.first, view_lidar_info_ptr->lidar_point_port, view_lidar_info_ptr->dev_type, kRouteData);
+      AddRoute(entries, item.first, view_lidar_info_ptr->lidar_imu_data_port, view_lidar_info_ptr->dev_type, kRouteData);
+    }
+  }
+
+  std::unique_ptr<RouteTable> route_table(new RouteTable(entries, inet_addr(detection_host_ip_.c_str())));
+  route_table_.Store(std::move(route_table));
+}
+
+uint32_t DeviceManager::GetRouteReaderSlot() {
+  if (route_reader_slot_cache.serial == route_reader_serial_) {
+    return route_reader_slot_cache.slot;
+  }
+  std::lock_guard<std::mutex> lock(route_table_mutex_);
+  std::thread::id id = std::this_thread::get_id();
+  auto it = std::find(route_reader_ids_.begin(), route_reader_ids_.end(), id);
+  uint32_t slot = static_cast<uint32_t>(it - route_reader_ids_.begin());
+  if (it == route_reader_ids_.end()) {
+    if (route_reader_ids_.size() < kMaxRouteReaders) {
+      route_reader_ids_.push_back(id);
     } else {
-      GeneralCommandHandler::GetInstance().Handler(handle, port, (uint8_t*)(buf.get()), size);
+      // Still safe, the threads past the slots share a counter and only delay freeing replaced tables.
+      slot = kMaxRouteReaders;
     }
+  }
+  route_reader_slot_cache.serial = route_reader_serial_;
+  route_reader_slot_cache.slot = slot;
+  return slot;
+}
+
+void DeviceManager::DispatchPacket(const uint32_t handle, const uint16_t port, uint8_t* buf, const uint32_t size,
+                                   const uint64_t timestamp) {
+  RcuReadScope read_scope(route_readers_, GetRouteReaderSlot());
+  const RouteTable* route_table = route_table_.Load();
+  if (route_table == nullptr || route_table->IsIgnored(handle)) {
     return;
   }
 
-  if (custom_lidars_cfg_map_.find(handle) != custom_lidars_cfg_map_.end()) {
-    const LivoxLidarCfg& lidar_cfg = custom_lidars_cfg_map_[handle];
-    if (port == lidar_cfg.lidar_net_info.imu_data_port || port == lidar_cfg.lidar_net_info.point_data_port) {
-      DataHandler::GetInstance().Handle(lidar_cfg.device_type, handle, (uint8_t*)(buf.get()), size);
-      return;
-    }
-    if (port == kDetectionPort || port == lidar_cfg.lidar_net_info.cmd_data_port || port == lidar_cfg.lidar_net_info.push_msg_port ||
-        port == lidar_cfg.lidar_net_info.log_data_port || port == kPaLidarFaultPort) {
-      GeneralCommandHandler::GetInstance().Handler(lidar_cfg.device_type, handle, port, (uint8_t*)(buf.get()), size);
-      return;
+  const RouteEntry* route = route_table->Find(handle, port);
+  if (route != nullptr) {
+    DispatchRoute(*route, handle, port, buf, size, timestamp);
+    return;
+  }
+
+  if (IsDebugPointCloudPort(port)) {
+    DebugPointCloudManager::GetInstance().Handler(handle, port, buf, size);
+  }
+
+  if (IsLogPort(port)) {
+    LoggerManager::GetInstance().Handler(handle, port, buf, size);
+  }
+
+  // A known lidar sending from a port without a route of its own.
+  route = route_table->Find(handle, kRouteAnyPort);
+  if (route != nullptr) {
+    if (route->targets & kRouteCommand) {
+      GeneralCommandHandler::GetInstance().Handler(route->dev_type, handle, port, buf, size);
     }
     return;
   }
 
-  // parse the device type info from config_ptr and add to custom_lidars_cfg_map_
-  if (port != kDetectionPort) {
+  if (is_view_) {
+    GeneralCommandHandler::GetInstance().Handler(handle, port, buf, size);
     return;
   }
 
+  if (port == kDetectionPort) {
+    HandleDetectionPacket(handle, buf, size);
+  }
+}
+
+void DeviceManager::DispatchRoute(const RouteEntry& route, const uint32_t handle, const uint16_t port, uint8_t* buf,
+                                  const uint32_t size, const uint64_t timestamp) {
+  if (route.targets & kRouteDebugPointCloud) {
+    DebugPointCloudManager::GetInstance().Handler(handle, port, buf, size);
+  }
+
+  if (route.targets & kRouteLog) {
+    LoggerManager::GetInstance().Handler(handle, port, buf, size);
+  }
+
+  if (route.targets & kRouteData) {
+    DataHandler::GetInstance().Handle(route.dev_type, handle, buf, size, timestamp);
+  } else if (route.targets & kRouteCommand) {
+    GeneralCommandHandler::GetInstance().Handler(route.dev_type, handle, port, buf, size);
+  }
+}
+
+void DeviceManager::HandleDetectionPacket(const uint32_t handle, uint8_t* buf, const uint32_t size) {
+  // parse the device type info from config_ptr and add to custom_lidars_cfg_map_
   CommPacket packet;
   memset(&packet, 0, sizeof(packet));
-  if (!(comm_port_->ParseCommStream((uint8_t*)(buf.get()), size, &packet))) {
+  if (!(comm_port_->ParseCommStream(buf, size, &packet))) {
     LOG_INFO("Parse Command Stream failed.");
     return;
   }
@@ -547,6 +1229,7 @@ void DeviceManager::OnData(socket_t sock, void *client_data) {
   binary_ip.s_addr = handle;
   lidar_cfg.lidar_net_info.lidar_ipaddr = inet_ntoa(binary_ip);
   custom_lidars_cfg_map_[handle] = lidar_cfg;
+  RebuildRouteTable();
   custom_lidars_cfg_ptr_->push_back(lidar_cfg);
   GeneralCommandHandler::GetInstance().Init(custom_lidars_cfg_ptr_, this);
   GeneralCommandHandler::GetInstance().CreateCommandHandler(detection_data->dev_type);
@@ -557,6 +1240,10 @@ void DeviceManager::OnData(socket_t sock, void *client_data) {
       LOG_ERROR("Create data channel failed.");
       return;
     }
+    CreateLidarDataChannel(host_net_info.host_ip, host_net_info.multicast_ip,
+                           inet_addr(it->lidar_net_info.lidar_ipaddr.c_str()), it->device_type,
+                           host_net_info.point_data_port, it->lidar_net_info.point_data_port,
+                           host_net_info.imu_data_port, it->lidar_net_info.imu_data_port);
 
     if (!CreateCommandChannel(it->device_type, host_net_info)) {
       LOG_ERROR("Create command channel failed.");
@@ -711,6 +1398,7 @@ void DeviceManager::AddViewLidar(const uint32_t handle, LivoxLidarDiagInternalIn
     std::lock_guard<std::mutex> lock(view_lidars_info_mutex_);
     view_lidars_info_[handle] = view_lidar_info_ptr;
   }
+  RebuildRouteTable();
   view_device.is_get.store(true);
   GeneralCommandHandler::GetInstance().UpdateLidarCfg(*view_lidar_info_ptr);
 }
@@ -719,7 +1407,8 @@ void DeviceManager::CreateViewDataChannel(const ViewLidarIpInfo& view_lidar_info
   std::string point_key = view_lidar_info.host_ip + ":" + std::to_string(view_lidar_info.host_point_port);
   if (channel_info_.find(point_key) == channel_info_.end()) {
     socket_t sock = -1;
-    sock = util::CreateSocket(view_lidar_info.host_point_port, true, true, true, view_lidar_info.host_ip, "");
+    sock = util::CreateSocket(view_lidar_info.host_point_port, true, true, true, view_lidar_info.host_ip, "", false,
+                              sdk_framework_cfg_ptr_->data_rcvbuf_size);
     if (sock < 0) {
       LOG_ERROR("Create View point data channel faileld, can not create socket, the ip {} port {} ",
           view_lidar_info.host_ip.c_str(), view_lidar_info.host_point_port);
@@ -727,13 +1416,15 @@ void DeviceManager::CreateViewDataChannel(const ViewLidarIpInfo& view_lidar_info
     }
     socket_vec_.push_back(sock);
     channel_info_[point_key] = sock;
-    data_io_thread_->GetLoop().lock()->AddDelegate(sock, this, nullptr);
+    data_channel_.insert(sock);
+    AddSocketDelegate(NextDataIOThread(view_lidar_info.host_ip), sock, kPointCloud);
   }
 
   std::string imu_key = view_lidar_info.host_ip + ":" + std::to_string(view_lidar_info.host_imu_data_port);
   if (channel_info_.find(imu_key) == channel_info_.end()) {
     socket_t sock = -1;
-    sock = util::CreateSocket(view_lidar_info.host_imu_data_port, true, true, true, view_lidar_info.host_ip, "");
+    sock = util::CreateSocket(view_lidar_info.host_imu_data_port, true, true, true, view_lidar_info.host_ip, "", false,
+                              sdk_framework_cfg_ptr_->data_rcvbuf_size);
     if (sock < 0) {
       LOG_ERROR("Create View point data channel faileld, can not create socket, the ip {} port {} ",
           view_lidar_info.host_ip.c_str(), view_lidar_info.host_imu_data_port);
@@ -741,8 +1432,13 @@ void DeviceManager::CreateViewDataChannel(const ViewLidarIpInfo& view_lidar_info
     }
     socket_vec_.push_back(sock);
     channel_info_[imu_key] = sock;
-    data_io_thread_->GetLoop().lock()->AddDelegate(sock, this, nullptr);
+    data_channel_.insert(sock);
+    AddSocketDelegate(DataIOThreadFor(kImuData, view_lidar_info.host_ip), sock, kImuData);
   }
+
+  CreateLidarDataChannel(view_lidar_info.host_ip, "", view_lidar_info.handle, view_lidar_info.dev_type,
+                         view_lidar_info.host_point_port, view_lidar_info.lidar_point_port,
+                         view_lidar_info.host_imu_data_port, view_lidar_info.lidar_imu_data_port);
 }
 
 void DeviceManager::UpdateViewLidarCfgCallback(const uint32_t handle) {
@@ -765,8 +1461,89 @@ uint8_t DeviceManager::GetDeviceType(const uint32_t handle) {
   return dev_type;
 }
 
-void DeviceManager::OnTimer(TimePoint now) {
-  GeneralCommandHandler::GetInstance().CommandsHandle(now);
+bool DeviceManager::HasLidar(const uint32_t handle) {
+  {
+    std::lock_guard<std::mutex> lock(lidars_dev_type_mutex_);
+    if (lidars_dev_type_.find(handle) != lidars_dev_type_.end()) {
+      return true;
+    }
+  }
+  // A view context only records the lidars it sees in view_devices_.
+  std::lock_guard<std::mutex> lock(view_device_mutex_);
+  return view_devices_.find(handle) != view_devices_.end();
+}
+
+uint32_t DeviceManager::GetDataThreadNum() {
+  if (!sdk_framework_cfg_ptr_) {
+    return 0;
+  }
+  if (sdk_framework_cfg_ptr_->embedded_mode) {
+    return 1;
+  }
+  uint32_t group_num = 1;
+  if (sdk_framework_cfg_ptr_->data_io_per_nic) {
+    std::set<std::string> host_ips;
+    for (const auto& cfg_ptr : { lidars_cfg_ptr_, custom_lidars_cfg_ptr_ }) {
+      if (cfg_ptr == nullptr) {
+        continue;
+      }
+      for (const LivoxLidarCfg& lidar_cfg : *cfg_ptr) {
+        const std::string& host_ip = lidar_cfg.host_net_info.host_ip;
+        if (!host_ip.empty() && host_ip != "local") {
+          host_ips.insert(host_ip);
+        }
+      }
+    }
+    group_num += static_cast<uint32_t>(host_ips.size());
+  }
+  uint32_t imu_thread_num = sdk_framework_cfg_ptr_->imu_io_thread ? 1 : 0;
+  uint32_t thread_num = std::max<uint32_t>(sdk_framework_cfg_ptr_->data_io_thread_num, 1) * group_num +
+                        imu_thread_num;
+
+  // Groups of host ips learnt from detection come on top of the configured ones.
+  uint32_t created_num = imu_thread_num;
+  std::lock_guard<std::mutex> lock(data_io_groups_mutex_);
+  created_num += static_cast<uint32_t>(data_io_group_.threads.size());
+  for (const auto& item : nic_data_io_groups_) {
+    created_num += static_cast<uint32_t>(item.second.threads.size());
+  }
+  return std::max(thread_num, created_num);
+}
+
+bool DeviceManager::Start() {
+  if (!sdk_framework_cfg_ptr_ || !sdk_framework_cfg_ptr_->rt_mode) {
+    return true;
+  }
+  // The io loops, their zeroed receive buffers and the sockets of the configured lidars exist since
+  // Init and the data path reuses them for every packet, what is left is keeping their pages resident.
+  if (sdk_framework_cfg_ptr_->rt_mlockall && !LockProcessMemory()) {
+    LOG_WARN("Rt mode, the process memory is not locked and may page fault on the data path");
+  }
+  if (sdk_framework_cfg_ptr_->data_latency_report) {
+    LOG_WARN("Rt mode, data_latency_report logs from the data path, which allocates");
+  }
+  if (sdk_framework_cfg_ptr_->rt_alloc_tripwire != kRtAllocTripwireOff) {
+    if (!RtAllocTripwire::IsAvailable()) {
+      LOG_WARN("Rt mode, the sdk is built without LIVOX_RT_ALLOC_TRIPWIRE, rt_alloc_tripwire is ignored");
+    } else {
+      bool abort_on_alloc = sdk_framework_cfg_ptr_->rt_alloc_tripwire == kRtAllocTripwireAbort;
+      AddCommandTimer(sdk_framework_cfg_ptr_->rt_warmup_ms, [abort_on_alloc]() {
+        RtAllocTripwire::Arm(abort_on_alloc);
+        LOG_INFO("Rt mode, the allocation tripwire is armed");
+      });
+    }
+  }
+  LOG_INFO("Rt mode started, mlockall:{}, tripwire:{}, warm up {}ms", sdk_framework_cfg_ptr_->rt_mlockall,
+           static_cast<int>(sdk_framework_cfg_ptr_->rt_alloc_tripwire), sdk_framework_cfg_ptr_->rt_warmup_ms);
+  return true;
+}
+
+void DeviceManager::AddCommandTimer(uint32_t delay_ms, const IOLoop::IOLoopTask& task) {
+  std::shared_ptr<IOThread> cmd_io_thread = cmd_io_thread_;
+  std::shared_ptr<IOLoop> loop = cmd_io_thread ? cmd_io_thread->GetLoop().lock() : nullptr;
+  if (loop) {
+    loop->PostTimer(delay_ms, task);
+  }
 }
 
 int DeviceManager::SendCommand(const uint8_t dev_type, const uint32_t handle, const std::vector<uint8_t>& buf, 
@@ -818,25 +1595,28 @@ bool DeviceManager::GetLoggerCmdChannel(const uint8_t dev_type, const uint32_t h
 
 void DeviceManager::Destory() {
   detection_host_ip_ = "";
+  if (sdk_framework_cfg_ptr_ && sdk_framework_cfg_ptr_->rt_mode) {
+    RtAllocTripwire::Disarm();
+  }
 
-  if (detection_socket_ > 0) {
+  if (detection_socket_ > 0 && detection_io_thread_) {
     detection_io_thread_->GetLoop().lock()->RemoveDelegate(detection_socket_, this);
   }
 
-  if (detection_broadcast_socket_ > 0) {
+  if (detection_broadcast_socket_ > 0 && detection_io_thread_) {
     detection_io_thread_->GetLoop().lock()->RemoveDelegate(detection_broadcast_socket_, this);
   }
 
   for (auto it = command_channel_.begin(); it != command_channel_.end(); ++it) {
     socket_t sock = *it;
-    if (sock > 0) {
+    if (sock > 0 && cmd_io_thread_) {
       cmd_io_thread_->GetLoop().lock()->RemoveDelegate(sock, this);
     }
   }
 
   for (auto it = vec_broadcast_socket_.begin(); it != vec_broadcast_socket_.end(); ++it) {
     socket_t sock = *it;
-    if (sock > 0) {
+    if (sock > 0 && cmd_io_thread_) {
       cmd_io_thread_->GetLoop().lock()->RemoveDelegate(sock, this);
     }
   }
@@ -844,10 +1624,36 @@ void DeviceManager::Destory() {
   for (auto it = data_channel_.begin(); it != data_channel_.end(); ++it) {
     socket_t sock = *it;
     if (sock > 0) {
-      data_io_thread_->GetLoop().lock()->RemoveDelegate(sock, this);
+      auto context = socket_contexts_.find(sock);
+      std::shared_ptr<IOLoop> loop = (context != socket_contexts_.end()) ? context->second->loop.lock() : nullptr;
+      if (loop) {
+        loop->RemoveDelegate(sock, this);
+      }
     }
   }
 
+  // Stop the io threads before the sockets and their contexts are released.
+  detection_io_thread_ = nullptr;
+  cmd_io_thread_ = nullptr;
+  {
+    // Joined outside of the mutex.
+    std::vector<std::shared_ptr<IOThread>> data_io_threads;
+    std::map<std::string, DataIOGroup> nic_data_io_groups;
+    {
+      std::lock_guard<std::mutex> lock(data_io_groups_mutex_);
+      data_io_threads.swap(data_io_group_.threads);
+      nic_data_io_groups.swap(nic_data_io_groups_);
+    }
+  }
+  imu_io_thread_ = nullptr;
+  {
+    std::lock_guard<std::mutex> lock(socket_contexts_mutex_);
+    socket_contexts_.clear();
+  }
+  lidar_data_channel_.clear();
+  packet_captures_.clear();
+  xdp_sockets_.clear();
+
   for (socket_t& sock : socket_vec_) {
     util::CloseSock(sock);
     sock = -1;
@@ -860,20 +1666,14 @@ void DeviceManager::Destory() {
   }
   vec_broadcast_socket_.clear();
 
-  if (detection_thread_) {
-    is_stop_detection_.store(true);
-    detection_thread_->join();
-    detection_thread_ = nullptr;
-
-    if (detection_socket_ > 0) {
-      util::CloseSock(detection_socket_);
-      detection_socket_ = -1;
-    }
+  if (detection_socket_ > 0) {
+    util::CloseSock(detection_socket_);
+    detection_socket_ = -1;
+  }
 
-    if (detection_broadcast_socket_ > 0) {
-      util::CloseSock(detection_broadcast_socket_);
-      detection_broadcast_socket_ = -1;
-    }
+  if (detection_broadcast_socket_ > 0) {
+    util::CloseSock(detection_broadcast_socket_);
+    detection_broadcast_socket_ = -1;
   }
 
   lidars_cfg_ptr_ = nullptr;
@@ -890,8 +1690,6 @@ void DeviceManager::Destory() {
 
   comm_port_.reset(nullptr);
 
-  is_stop_detection_.store(true);
-
   {
     std::lock_guard<std::mutex> lock(lidars_dev_type_mutex_);
     lidars_dev_type_.clear();
@@ -909,6 +1707,13 @@ void DeviceManager::Destory() {
     std::lock_guard<std::mutex> lock(view_lidars_info_mutex_);
     view_lidars_info_.clear();
   }
+
+  {
+    std::lock_guard<std::mutex> lock(route_table_mutex_);
+    route_table_.Clear();
+    route_reader_ids_.clear();
+    route_reader_serial_ = NextRouteReaderSerial();
+  }
 }
 
 DeviceManager::~DeviceManager() {
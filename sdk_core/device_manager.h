@@ -29,8 +29,12 @@
 
 #include "comm/define.h"
 #include "comm/comm_port.h"
+#include "comm/route_table.h"
+#include "base/rcu_value.h"
 #include "base/io_thread.h"
 #include "base/network/network_util.h"
+#include "base/network/packet_ring.h"
+#include "base/network/xdp_socket.h"
 
 #include <string>
 #include <memory>
@@ -38,6 +42,8 @@
 #include <set>
 #include <map>
 #include <mutex>
+#include <thread>
+#include <atomic>
 #include <string.h>
 
 #ifdef WIN32
@@ -55,7 +61,17 @@
 namespace livox {
 namespace lidar {
 
+/** Data io threads serving the data sockets of one host interface. */
+typedef struct {
+  std::string host_ip;
+  std::string if_name;    /* empty for the default group. */
+  std::vector<int> cpus;  /* cpus local to the interface device, empty if unknown. */
+  std::vector<std::shared_ptr<IOThread>> threads;
+  size_t next_thread;
+} DataIOGroup;
+
 static const size_t kMaxBufferSize = 8192;
+static const size_t kMaxGroBufferSize = 65536;
 const uint8_t kSdkVer = 3;
 
 class Protector {};
@@ -89,8 +105,24 @@ struct Command {
   std::shared_ptr<CommandCallback> cb;
 };
 
+typedef struct {
+  socket_t sock;
+  HostSocketType type;
+  RecvBufferPool* recv_buffer_pool;  /**< receive buffers of the io loop serving the socket. */
+  std::weak_ptr<IOLoop> loop;        /**< io loop serving the socket. */
+  PacketCapture* capture;            /**< capture behind the descriptor, nullptr for a socket. */
+  PacketCapture::PacketCallback capture_callback;  /**< built once, Read is called for every wake up. */
+  uint32_t handle;                   /**< lidar a connected data socket receives from, 0 otherwise. */
+  uint8_t dev_type;                  /**< device type of that lidar. */
+  std::atomic<uint32_t> kernel_drops;      /**< datagrams dropped by the kernel so far, from SO_RXQ_OVFL. */
+  std::atomic<uint32_t> recv_buffer_size;  /**< SO_RCVBUF granted by the kernel. */
+  bool recv_buffer_capped;                 /**< the kernel stopped granting a larger SO_RCVBUF, growth is not retried. */
+  std::chrono::steady_clock::time_point last_drop_log;
+} SocketContext;
+
 class DeviceManager : public IOLoop::IOLoopDelegate {
  private:
+  friend class SdkContext;
   DeviceManager();
   DeviceManager(const DeviceManager& other) = delete;
   DeviceManager& operator=(const DeviceManager& other) = delete;
@@ -119,7 +151,33 @@ class DeviceManager : public IOLoop::IOLoopDelegate {
   void UpdateViewLidarCfgCallback(const uint32_t handle);
 
   void OnData(socket_t sock, void *);
-  void OnTimer(TimePoint now);
+  void OnRecv(socket_t sock, void *, const util::RecvMsg& msg);
+  bool OnDrain(socket_t sock, void *client_data);
+  /** Run task on the command io loop after delay_ms, thread safe. */
+  void AddCommandTimer(uint32_t delay_ms, const IOLoop::IOLoopTask& task);
+  /** Prepare the real time data path in rt mode, see LivoxLidarSdkStart. */
+  bool Start();
+  /** The thread_config schedule of role, named after the role when the config leaves the name empty. */
+  ThreadSchedule GetThreadSchedule(const ThreadRole role) const;
+
+  /** Descriptor readable when the io loop of embedded mode has events, -1 otherwise. */
+  int GetPollFd();
+  /**
+   * Run the io loop of embedded mode on the calling thread, always the same one. Wait up to timeout_ms,
+   * then keep dispatching the ready events until max_events are handled. Return them, -1 if not embedded.
+   */
+  int Poll(uint32_t max_events, int timeout_ms);
+  /** Milliseconds until a timer of the embedded io loop is due, -1 if not embedded. Polling thread only. */
+  int GetPollTimeout();
+
+  uint32_t GetDataSocketStats(LivoxLidarSocketStats* stats, uint32_t max_num);
+  /** Whether the lidar handle has been discovered. */
+  bool HasLidar(const uint32_t handle);
+  /**
+   * Threads which may deliver point cloud and imu data: the data io threads of every group, including the
+   * groups of configured host ips not created yet, and the imu io thread. The calling thread in embedded mode.
+   */
+  uint32_t GetDataThreadNum();
   
   std::shared_ptr<LivoxLidarSdkFrameworkCfg> sdk_framework_cfg_ptr_;
 
@@ -135,17 +193,59 @@ class DeviceManager : public IOLoop::IOLoopDelegate {
   bool CreateDetectionIOThread();
   bool CreateCommandIOThread();
   bool CreateDataIOThread();
+  /** Embedded mode, a single loop no thread runs serves every socket and timer. */
+  bool CreateEmbeddedIOLoop();
+  std::shared_ptr<IOLoop> GetEmbeddedIOLoop();
+  bool CreateDataIOGroup(DataIOGroup& group);
+  std::shared_ptr<IOThread> CreateDataLoopThread();
+  /**
+   * The group of host_ip when data_io_per_nic is set, created on first use, the default group otherwise.
+   * Call with data_io_groups_mutex_ held.
+   */
+  DataIOGroup& GetDataIOGroup(const std::string& host_ip);
+  /** Copy of the data io threads of the group of host_ip, see GetDataIOGroup. */
+  std::vector<std::shared_ptr<IOThread>> GetDataIOThreads(const std::string& host_ip);
 
   bool CreateChannel();
   bool CreateDetectionChannel();
   bool CreateDataChannel(const HostNetInfo& host_net_info);
   bool CreateCommandChannel(const uint8_t dev_type, const HostNetInfo& host_net_info);
   bool CreateCmdSocketAndAddDelegate(const uint8_t dev_type, const std::string& host_ip, const uint16_t port, const HostSocketType type);
-  bool CreateDataSocketAndAddDelegate(const std::string& host_ip, const uint16_t port, const std::string& multicast_ip);
-
-  void DetectionLidars();
+  bool CreateDataSocketAndAddDelegate(const std::string& host_ip, const uint16_t port, const std::string& multicast_ip, const HostSocketType type);
+  bool CreateShardedDataSockets(const std::string& netif, const uint16_t port, const HostSocketType type);
+  bool CreatePacketRingChannel(const std::string& netif, const uint16_t port, const std::string& multicast_ip,
+                               const HostSocketType type);
+  bool CreateXdpChannel(const HostNetInfo& host_net_info);
+  void CreateLidarDataChannel(const std::string& host_ip, const std::string& multicast_ip, const uint32_t handle,
+                              const uint8_t dev_type, const uint16_t host_point_port, const uint16_t lidar_point_port,
+                              const uint16_t host_imu_port, const uint16_t lidar_imu_port);
+  bool CreateConnectedDataSocket(const std::string& host_ip, const uint16_t host_port, const uint32_t handle,
+                                 const uint16_t lidar_port, const uint8_t dev_type, const HostSocketType type);
+  std::shared_ptr<IOThread> NextDataIOThread(const std::string& host_ip);
+  /** The imu io thread for imu sockets when configured, the next data io thread of host_ip otherwise. */
+  std::shared_ptr<IOThread> DataIOThreadFor(const HostSocketType type, const std::string& host_ip);
+  bool AddSocketDelegate(const std::shared_ptr<IOThread>& io_thread, const socket_t sock, const HostSocketType type,
+                         PacketCapture* capture = nullptr, const uint32_t handle = 0, const uint8_t dev_type = 0);
+  void SetDataSocketOption(const socket_t sock);
+  bool UseUdpGro() const;
+
+  void StartDetection();
   void Detection();
 
+  bool OnDataBatch(socket_t sock, SocketContext& context);
+  void HandleRecvMsg(SocketContext& context, const util::RecvMsg& msg);
+  void OnKernelDrops(SocketContext& context, const uint32_t drops);
+  void DispatchData(const SocketContext& context, const uint32_t handle, const uint16_t port, uint8_t* buf,
+                    const uint32_t size, const uint64_t timestamp);
+  void DispatchPacket(const uint32_t handle, const uint16_t port, uint8_t* buf, const uint32_t size,
+                      const uint64_t timestamp = 0);
+  void DispatchRoute(const RouteEntry& route, const uint32_t handle, const uint16_t port, uint8_t* buf,
+                     const uint32_t size, const uint64_t timestamp);
+  void HandleDetectionPacket(const uint32_t handle, uint8_t* buf, const uint32_t size);
+  void RebuildRouteTable();
+  /** Read slot of the calling io thread, kMaxRouteReaders if every slot is taken. */
+  uint32_t GetRouteReaderSlot();
+
   uint8_t GetDeviceType(const uint32_t handle);
   void IsLidarData(const uint32_t handle, const uint16_t lidar_port, uint8_t& dev_type);
  private:
@@ -177,14 +277,29 @@ class DeviceManager : public IOLoop::IOLoopDelegate {
   std::vector<socket_t> vec_broadcast_socket_;
 
   std::shared_ptr<IOThread> cmd_io_thread_;
-  std::shared_ptr<IOThread> data_io_thread_;
+  // Channels are created from the command loop and the caller of the sdk, the groups are shared under the mutex.
+  std::mutex data_io_groups_mutex_;
+  DataIOGroup data_io_group_;
+  std::map<std::string, DataIOGroup> nic_data_io_groups_;  /**< host ip -> group, with data_io_per_nic. */
   std::shared_ptr<IOThread> detection_io_thread_;
+  std::shared_ptr<IOThread> imu_io_thread_;  /**< keeps imu packets from queuing behind the point stream. */
+
+  std::mutex socket_contexts_mutex_;
+  std::map<socket_t, std::unique_ptr<SocketContext>> socket_contexts_;
+  std::set<std::pair<uint32_t, uint16_t>> lidar_data_channel_;  /**< (handle, host port) with a connected socket. */
+
+  // The io threads dispatch through the published table inside a section of route_readers_, a table replaced
+  // on a topology change is freed by a later rebuild once no section may still hold it.
+  std::mutex route_table_mutex_;
+  RcuReaders route_readers_;
+  RcuValue<RouteTable> route_table_;
+  std::vector<std::thread::id> route_reader_ids_;  /**< thread of each slot, under route_table_mutex_. */
+  uint64_t route_reader_serial_;                   /**< changes when the slots are reset, invalidating cached slots. */
+  std::vector<std::unique_ptr<PacketCapture>> packet_captures_;
+  std::map<std::string, XdpSocket*> xdp_sockets_;
 
   std::unique_ptr<CommPort> comm_port_;
 
-  std::atomic<bool> is_stop_detection_{false};
-  std::shared_ptr<std::thread> detection_thread_;
-
   std::mutex lidars_dev_type_mutex_;
   std::map<uint32_t, uint16_t> lidars_dev_type_;
 
@@ -26,7 +26,9 @@
 #include "livox_lidar_def.h"
 
 #include "base/command_callback.h"
+#include "base/thread_base.h"
 #include "base/logging.h"
+#include "base/rt_guard.h"
 #include "comm/define.h"
 
 #include "command_handler/command_impl.h"
@@ -39,17 +41,48 @@
 #include "parse_cfg_file.h"
 #include "params_check.h"
 #include "device_manager.h"
+#include "sdk_context.h"
 
 #ifdef WIN32
 #include<winsock2.h>
 #endif // WIN32
 
+#include <algorithm>
 #include <memory>
+#include <mutex>
 #include <vector>
 
 using namespace livox::lidar;
 
-static bool is_initialized = false;
+static std::mutex context_mutex;
+static uint32_t initialized_context_num = 0;  /* the logger is released with the last context. */
+
+// Initialized contexts searched by the lidar commands, under a lock of its own so that a callback
+// may send a command while its context is being uninitialized under context_mutex.
+static std::mutex lidar_contexts_mutex;
+static std::vector<SdkContext*> lidar_contexts;
+
+static SdkContext* ResolveContext(LivoxLidarSdkContext* context) {
+  return context != nullptr ? reinterpret_cast<SdkContext*>(context) : &SdkContext::Default();
+}
+
+/**
+ * The context that discovered the lidar, the default context if none did. The context of the calling
+ * thread wins when it knows the lidar, as in its own callbacks.
+ */
+static SdkContext* LidarContext(const uint32_t handle) {
+  SdkContext& current = SdkContext::Current();
+  if (current.IsInitialized() && current.GetDeviceManager().HasLidar(handle)) {
+    return &current;
+  }
+  std::lock_guard<std::mutex> lock(lidar_contexts_mutex);
+  for (SdkContext* context : lidar_contexts) {
+    if (context->GetDeviceManager().HasLidar(handle)) {
+      return context;
+    }
+  }
+  return &SdkContext::Default();
+}
 
 void GetLivoxLidarSdkVer(LivoxLidarSdkVer *version) {
   if (version != NULL) {
@@ -59,10 +92,25 @@ void GetLivoxLidarSdkVer(LivoxLidarSdkVer *version) {
   }
 }
 
-bool LivoxLidarSdkInit(const char* path, const char* host_ip, const LivoxLidarLoggerCfgInfo* log_cfg_info) {
-  if (is_initialized) {
+static void DestoryContext(SdkContext& context) {
+  SdkContextScope scope(&context);
+  LoggerManager::GetInstance().Destory();
+  // The reason for using WSACleanup() after previous statement is that Destory() still needs to send socket messages.
+#ifdef WIN32
+    WSACleanup();
+#endif // WIN32
+  DeviceManager::GetInstance().Destory();
+  DataHandler::GetInstance().Destory();
+  GeneralCommandHandler::GetInstance().Destory();
+}
+
+static bool InitContext(SdkContext& context, const char* path, const char* host_ip,
+                        const LivoxLidarLoggerCfgInfo* log_cfg_info) {
+  std::lock_guard<std::mutex> lock(context_mutex);
+  if (context.IsInitialized()) {
     return false;
   }
+  SdkContextScope scope(&context);
 
 #ifdef WIN32
   WORD sockVersion = MAKEWORD(2, 0);
@@ -74,57 +122,207 @@ bool LivoxLidarSdkInit(const char* path, const char* host_ip, const LivoxLidarLo
 
   InitLogger();
 
-  if (path == NULL && host_ip == NULL) {
-    return false;
-  }
-
+  bool result = false;
   if (path) {
     std::shared_ptr<std::vector<LivoxLidarCfg>> lidars_cfg_ptr = nullptr;
     std::shared_ptr<std::vector<LivoxLidarCfg>> custom_lidars_cfg_ptr = nullptr;
     std::shared_ptr<LivoxLidarLoggerCfg> lidar_logger_cfg_ptr = nullptr;
     std::shared_ptr<LivoxLidarSdkFrameworkCfg> sdk_framework_cfg_ptr = nullptr;
 
-    if (!ParseCfgFile(path).Parse(lidars_cfg_ptr, custom_lidars_cfg_ptr, lidar_logger_cfg_ptr, sdk_framework_cfg_ptr)) {
-      return false;
-    }
+    result = ParseCfgFile(path).Parse(lidars_cfg_ptr, custom_lidars_cfg_ptr, lidar_logger_cfg_ptr,
+                                      sdk_framework_cfg_ptr) &&
+             ParamsCheck(lidars_cfg_ptr, custom_lidars_cfg_ptr).Check() &&
+             DeviceManager::GetInstance().Init(lidars_cfg_ptr, custom_lidars_cfg_ptr, lidar_logger_cfg_ptr,
+                                               sdk_framework_cfg_ptr);
+  } else if (host_ip) {
+    result = DeviceManager::GetInstance().Init(host_ip, log_cfg_info);
+  }
+  if (!result) {
+    // Init may fail after some io threads are started.
+    DestoryContext(context);
+    return false;
+  }
 
-    if (!ParamsCheck(lidars_cfg_ptr, custom_lidars_cfg_ptr).Check()) {
-      return false;
-    }
+  context.SetInitialized(true);
+  ++initialized_context_num;
+  std::lock_guard<std::mutex> contexts_lock(lidar_contexts_mutex);
+  lidar_contexts.push_back(&context);
+  return true;
+}
 
-    if (!DeviceManager::GetInstance().Init(lidars_cfg_ptr, custom_lidars_cfg_ptr, lidar_logger_cfg_ptr, sdk_framework_cfg_ptr)) {
-      return false;
-    }
-  } else {
-    if (!DeviceManager::GetInstance().Init(host_ip, log_cfg_info)) {
-      return false;
-    }
+static void UninitContext(SdkContext& context) {
+  std::lock_guard<std::mutex> lock(context_mutex);
+  if (!context.IsInitialized()) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> contexts_lock(lidar_contexts_mutex);
+    lidar_contexts.erase(std::remove(lidar_contexts.begin(), lidar_contexts.end(), &context), lidar_contexts.end());
   }
+  DestoryContext(context);
 
-  is_initialized = true;
-  return true;
+  context.SetInitialized(false);
+  if (--initialized_context_num == 0) {
+    UninitLogger();
+  }
+}
+
+bool LivoxLidarSdkInit(const char* path, const char* host_ip, const LivoxLidarLoggerCfgInfo* log_cfg_info) {
+  return InitContext(SdkContext::Default(), path, host_ip, log_cfg_info);
 }
 
 void LivoxLidarSdkUninit() {
-  if (!is_initialized) {
+  UninitContext(SdkContext::Default());
+}
+
+LivoxLidarSdkContext* LivoxLidarSdkCreateContext(const char* path, const char* host_ip,
+                                                 const LivoxLidarLoggerCfgInfo* log_cfg_info) {
+  std::unique_ptr<SdkContext> context(new SdkContext());
+  if (!InitContext(*context, path, host_ip, log_cfg_info)) {
+    return nullptr;
+  }
+  return reinterpret_cast<LivoxLidarSdkContext*>(context.release());
+}
+
+void LivoxLidarSdkDestroyContext(LivoxLidarSdkContext* context) {
+  SdkContext* sdk_context = reinterpret_cast<SdkContext*>(context);
+  if (sdk_context == nullptr || sdk_context == &SdkContext::Default()) {
     return;
   }
+  UninitContext(*sdk_context);
+  delete sdk_context;
+}
 
-  LoggerManager::GetInstance().Destory();
-  // The reason for using WSACleanup() after previous statement is that Destory() still needs to send socket messages.
-#ifdef WIN32
-    WSACleanup();
-#endif // WIN32
-  DeviceManager::GetInstance().Destory();
-  DataHandler::GetInstance().Destory();
-  GeneralCommandHandler::GetInstance().Destory();
+bool LivoxLidarSdkContextStart(LivoxLidarSdkContext* context) {
+  SdkContextScope scope(ResolveContext(context));
+  return DeviceManager::GetInstance().Start();
+}
+
+int LivoxLidarSdkContextGetPollFd(LivoxLidarSdkContext* context) {
+  SdkContextScope scope(ResolveContext(context));
+  return DeviceManager::GetInstance().GetPollFd();
+}
+
+int LivoxLidarSdkContextPoll(LivoxLidarSdkContext* context, uint32_t max_events, int timeout_ms) {
+  SdkContextScope scope(ResolveContext(context));
+  return DeviceManager::GetInstance().Poll(max_events, timeout_ms);
+}
+
+int LivoxLidarSdkContextGetPollTimeout(LivoxLidarSdkContext* context) {
+  SdkContextScope scope(ResolveContext(context));
+  return DeviceManager::GetInstance().GetPollTimeout();
+}
+
+void LivoxLidarSdkContextSetPointCloudCallBack(LivoxLidarSdkContext* context, LivoxLidarPointCloudCallBack cb,
+                                               void* client_data) {
+  SdkContextScope scope(ResolveContext(context));
+  DataHandler::GetInstance().SetPointDataCallback(cb, client_data);
+}
+
+void LivoxLidarSdkContextSetPointCloudCallBackEx(LivoxLidarSdkContext* context, LivoxLidarPointCloudCallBackEx cb,
+                                                 void* client_data) {
+  SdkContextScope scope(ResolveContext(context));
+  DataHandler::GetInstance().SetPointDataCallbackEx(cb, client_data);
+}
+
+void LivoxLidarSdkContextSetImuDataCallback(LivoxLidarSdkContext* context, LivoxLidarImuDataCallback cb,
+                                            void* client_data) {
+  SdkContextScope scope(ResolveContext(context));
+  DataHandler::GetInstance().SetImuDataCallback(cb, client_data);
+}
+
+void LivoxLidarSdkContextSetImuDataCallbackEx(LivoxLidarSdkContext* context, LivoxLidarImuDataCallbackEx cb,
+                                              void* client_data) {
+  SdkContextScope scope(ResolveContext(context));
+  DataHandler::GetInstance().SetImuDataCallbackEx(cb, client_data);
+}
+
+void LivoxLidarSdkContextSetInfoCallback(LivoxLidarSdkContext* context, LivoxLidarInfoCallback cb, void* client_data) {
+  SdkContextScope scope(ResolveContext(context));
+  GeneralCommandHandler::GetInstance().SetLivoxLidarInfoCallback(cb, client_data);
+}
+
+void LivoxLidarSdkContextSetInfoChangeCallback(LivoxLidarSdkContext* context, LivoxLidarInfoChangeCallback cb,
+                                               void* client_data) {
+  SdkContextScope scope(ResolveContext(context));
+  GeneralCommandHandler::GetInstance().SetLivoxLidarInfoChangeCallback(cb, client_data);
+}
+
+void LivoxLidarSdkContextAddCmdObserver(LivoxLidarSdkContext* context, LivoxLidarCmdObserverCallBack cb,
+                                        void* client_data) {
+  SdkContextScope scope(ResolveContext(context));
+  GeneralCommandHandler::GetInstance().LivoxLidarAddCmdObserver(cb, client_data);
+}
+
+void LivoxLidarSdkContextRemoveCmdObserver(LivoxLidarSdkContext* context) {
+  SdkContextScope scope(ResolveContext(context));
+  GeneralCommandHandler::GetInstance().LivoxLidarRemoveCmdObserver();
+}
+
+uint16_t LivoxLidarSdkContextAddPointCloudObserver(LivoxLidarSdkContext* context, LivoxLidarPointCloudObserver cb,
+                                                   void* client_data) {
+  SdkContextScope scope(ResolveContext(context));
+  return DataHandler::GetInstance().AddPointCloudObserver(cb, client_data);
+}
+
+void LivoxLidarSdkContextRemovePointCloudObserver(LivoxLidarSdkContext* context, uint16_t id) {
+  SdkContextScope scope(ResolveContext(context));
+  DataHandler::GetInstance().RemovePointCloudObserver(id);
+}
+
+uint16_t LivoxLidarSdkContextAddAsyncPointCloudConsumer(LivoxLidarSdkContext* context, LivoxLidarPointCloudObserver cb,
+                                                        void* client_data, uint32_t ring_size,
+                                                        LivoxLidarDeliveryPolicy policy) {
+  SdkContextScope scope(ResolveContext(context));
+  return DataHandler::GetInstance().AddAsyncConsumer(cb, client_data, ring_size, policy);
+}
+
+void LivoxLidarSdkContextRemoveAsyncPointCloudConsumer(LivoxLidarSdkContext* context, uint16_t id) {
+  SdkContextScope scope(ResolveContext(context));
+  DataHandler::GetInstance().RemoveAsyncConsumer(id);
+}
+
+bool LivoxLidarSdkContextGetAsyncConsumerStats(LivoxLidarSdkContext* context, uint16_t id,
+                                               LivoxLidarConsumerStats* stats) {
+  SdkContextScope scope(ResolveContext(context));
+  return DataHandler::GetInstance().GetAsyncConsumerStats(id, stats);
+}
+
+uint32_t LivoxLidarSdkContextGetDataSocketStats(LivoxLidarSdkContext* context, LivoxLidarSocketStats* stats,
+                                                uint32_t max_num) {
+  SdkContextScope scope(ResolveContext(context));
+  return DeviceManager::GetInstance().GetDataSocketStats(stats, max_num);
+}
+
+bool LivoxLidarSdkContextSetUpgradeFirmwarePath(LivoxLidarSdkContext* context, const char* firmware_path) {
+  SdkContextScope scope(ResolveContext(context));
+  return UpgradeManager::GetInstance().SetLivoxLidarUpgradeFirmwarePath(firmware_path);
+}
+
+void LivoxLidarSdkContextSetUpgradeProgressCallback(LivoxLidarSdkContext* context,
+                                                    OnLivoxLidarUpgradeProgressCallback cb, void* client_data) {
+  SdkContextScope scope(ResolveContext(context));
+  UpgradeManager::GetInstance().SetLivoxLidarUpgradeProgressCallback(cb, client_data);
+}
 
-  UninitLogger();
-  is_initialized = false;
+int LivoxLidarSdkGetPollFd() {
+  return LivoxLidarSdkContextGetPollFd(nullptr);
+}
+
+int LivoxLidarSdkPoll(uint32_t max_events, int timeout_ms) {
+  return LivoxLidarSdkContextPoll(nullptr, max_events, timeout_ms);
+}
+
+int LivoxLidarSdkGetPollTimeout() {
+  return LivoxLidarSdkContextGetPollTimeout(nullptr);
 }
 
 bool LivoxLidarSdkStart() {
-  return true;
+  return LivoxLidarSdkContextStart(nullptr);
+}
+
+uint64_t LivoxLidarSdkGetRtAllocationCount() {
+  return RtAllocTripwire::GetCount();
 }
 
 void SaveLivoxLidarSdkLoggerFile() {
@@ -136,50 +334,79 @@ void DisableLivoxSdkConsoleLogger() {
 }
 
 uint16_t LivoxLidarAddPointCloudObserver(LivoxLidarPointCloudObserver cb, void *client_data) {
-  return DataHandler::GetInstance().AddPointCloudObserver(cb, client_data);
+  return LivoxLidarSdkContextAddPointCloudObserver(nullptr, cb, client_data);
 }
 
 void LivoxLidarRemovePointCloudObserver(uint16_t id) {
-  DataHandler::GetInstance().RemovePointCloudObserver(id);
+  LivoxLidarSdkContextRemovePointCloudObserver(nullptr, id);
 }
 
 void SetLivoxLidarPointCloudCallBack(LivoxLidarPointCloudCallBack cb, void *client_data) {
-  DataHandler::GetInstance().SetPointDataCallback(cb, client_data);
+  LivoxLidarSdkContextSetPointCloudCallBack(nullptr, cb, client_data);
+}
+
+void SetLivoxLidarPointCloudCallBackEx(LivoxLidarPointCloudCallBackEx cb, void *client_data) {
+  LivoxLidarSdkContextSetPointCloudCallBackEx(nullptr, cb, client_data);
 }
 
 void LivoxLidarAddCmdObserver(LivoxLidarCmdObserverCallBack cb, void *client_data) {
-  GeneralCommandHandler::GetInstance().LivoxLidarAddCmdObserver(cb, client_data);
+  LivoxLidarSdkContextAddCmdObserver(nullptr, cb, client_data);
 }
 
 void LivoxLidarRemoveCmdObserver() {
-  GeneralCommandHandler::GetInstance().LivoxLidarRemoveCmdObserver();
+  LivoxLidarSdkContextRemoveCmdObserver(nullptr);
 }
 
 void SetLivoxLidarImuDataCallback(LivoxLidarImuDataCallback cb, void* client_data) {
-  DataHandler::GetInstance().SetImuDataCallback(cb, client_data);
+  LivoxLidarSdkContextSetImuDataCallback(nullptr, cb, client_data);
+}
+
+void SetLivoxLidarImuDataCallbackEx(LivoxLidarImuDataCallbackEx cb, void* client_data) {
+  LivoxLidarSdkContextSetImuDataCallbackEx(nullptr, cb, client_data);
+}
+
+uint32_t GetLivoxLidarDataSocketStats(LivoxLidarSocketStats* stats, uint32_t max_num) {
+  return LivoxLidarSdkContextGetDataSocketStats(nullptr, stats, max_num);
+}
+
+uint16_t LivoxLidarAddAsyncPointCloudConsumer(LivoxLidarPointCloudObserver cb, void* client_data, uint32_t ring_size,
+                                              LivoxLidarDeliveryPolicy policy) {
+  return LivoxLidarSdkContextAddAsyncPointCloudConsumer(nullptr, cb, client_data, ring_size, policy);
+}
+
+void LivoxLidarRemoveAsyncPointCloudConsumer(uint16_t id) {
+  LivoxLidarSdkContextRemoveAsyncPointCloudConsumer(nullptr, id);
+}
+
+bool GetLivoxLidarAsyncConsumerStats(uint16_t id, LivoxLidarConsumerStats* stats) {
+  return LivoxLidarSdkContextGetAsyncConsumerStats(nullptr, id, stats);
 }
 
 void SetLivoxLidarInfoCallback(LivoxLidarInfoCallback cb, void* client_data) {
-  GeneralCommandHandler::GetInstance().SetLivoxLidarInfoCallback(cb, client_data);
+  LivoxLidarSdkContextSetInfoCallback(nullptr, cb, client_data);
 }
 
 void SetLivoxLidarInfoChangeCallback(LivoxLidarInfoChangeCallback cb, void* client_data) {
-  GeneralCommandHandler::GetInstance().SetLivoxLidarInfoChangeCallback(cb, client_data);
+  LivoxLidarSdkContextSetInfoChangeCallback(nullptr, cb, client_data);
 }
 
 livox_status QueryLivoxLidarInternalInfo(uint32_t handle, QueryLivoxLidarInternalInfoCallback cb, void* client_data) {
+  SdkContextScope scope(LidarContext(handle));
   return CommandImpl::QueryLivoxLidarInternalInfo(handle, cb, client_data);
 }
 
 livox_status QueryLivoxLidarFwType(uint32_t handle, QueryLivoxLidarInternalInfoCallback cb, void* client_data) {
+  SdkContextScope scope(LidarContext(handle));
   return CommandImpl::QueryLivoxLidarFwType(handle, cb, client_data);
 }
 
 livox_status QueryLivoxLidarFirmwareVer(uint32_t handle, QueryLivoxLidarInternalInfoCallback cb, void* client_data) {
+  SdkContextScope scope(LidarContext(handle));
   return CommandImpl::QueryLivoxLidarFirmwareVer(handle, cb, client_data);
 }
 
 livox_status SetLivoxLidarPclDataType(uint32_t handle, LivoxLidarPointDataType data_type, LivoxLidarAsyncControlCallback cb, void* client_data) {
+  SdkContextScope scope(LidarContext(handle));
   if (data_type == kLivoxLidarImuData) {
     return EnableLivoxLidarImuData(handle, cb, client_data);
   }
@@ -187,181 +414,232 @@ livox_status SetLivoxLidarPclDataType(uint32_t handle, LivoxLidarPointDataType d
 }
 
 livox_status SetLivoxLidarScanPattern(uint32_t handle, LivoxLidarScanPattern scan_pattern, LivoxLidarAsyncControlCallback cb, void* client_data) {
+  SdkContextScope scope(LidarContext(handle));
   return CommandImpl::SetLivoxLidarScanPattern(handle, scan_pattern, cb, client_data);
 }
 
 livox_status SetLivoxLidarDualEmit(uint32_t handle, bool enable, LivoxLidarAsyncControlCallback cb, void* client_data) {
+  SdkContextScope scope(LidarContext(handle));
   return CommandImpl::SetLivoxLidarDualEmit(handle, enable, cb, client_data);
 }
 
 livox_status EnableLivoxLidarPointSend(uint32_t handle, LivoxLidarAsyncControlCallback cb, void* client_data) {
+  SdkContextScope scope(LidarContext(handle));
   return CommandImpl::EnableLivoxLidarPointSend(handle, cb, client_data);
 }
 livox_status DisableLivoxLidarPointSend(uint32_t handle, LivoxLidarAsyncControlCallback cb, void* client_data) {
+  SdkContextScope scope(LidarContext(handle));
   return CommandImpl::DisableLivoxLidarPointSend(handle, cb, client_data);
 }
 
 livox_status SetLivoxLidarIp(uint32_t handle, LivoxLidarIpInfo* ip_config,
     LivoxLidarAsyncControlCallback cb, void* client_data) {
+  SdkContextScope scope(LidarContext(handle));
   return CommandImpl::SetLivoxLidarIp(handle, ip_config, cb, client_data);
 }
 
 livox_status SetLivoxLidarStateInfoHostIPCfg(uint32_t handle, HostStateInfoIpInfo* host_state_info_ipcfg,
     LivoxLidarAsyncControlCallback cb, void* client_data) {
+  SdkContextScope scope(LidarContext(handle));
   return CommandImpl::SetLivoxLidarStateInfoHostIPCfg(handle, *host_state_info_ipcfg, cb, client_data);
 }
 
 livox_status SetLivoxLidarPointDataHostIPCfg(uint32_t handle, HostPointIPInfo* host_point_ipcfg,
     LivoxLidarAsyncControlCallback cb, void* client_data) {
+  SdkContextScope scope(LidarContext(handle));
   return CommandImpl::SetLivoxLidarPointDataHostIPCfg(handle, *host_point_ipcfg, cb, client_data);
 }
 
 livox_status SetLivoxLidarImuDataHostIPCfg(uint32_t handle, HostImuDataIPInfo* host_imu_ipcfg,
   LivoxLidarAsyncControlCallback cb, void* client_data) {
+  SdkContextScope scope(LidarContext(handle));
   return CommandImpl::SetLivoxLidarImuDataHostIPCfg(handle, *host_imu_ipcfg, cb, client_data);
 }
 
 livox_status SetLivoxLidarInstallAttitude(uint32_t handle, LivoxLidarInstallAttitude* install_attitude,
     LivoxLidarAsyncControlCallback cb, void* client_data) {
+  SdkContextScope scope(LidarContext(handle));
   return CommandImpl::SetLivoxLidarInstallAttitude(handle, *install_attitude, cb, client_data);
 }
 
 livox_status SetLivoxLidarFovCfg0(uint32_t handle, FovCfg* fov_cfg0, LivoxLidarAsyncControlCallback cb, void* client_data) {
+  SdkContextScope scope(LidarContext(handle));
   return CommandImpl::SetLivoxLidarFovCfg0(handle, *fov_cfg0, cb, client_data);
 }
 
 livox_status SetLivoxLidarFovCfg1(uint32_t handle, FovCfg* fov_cfg1, LivoxLidarAsyncControlCallback cb, void* client_data) {
+  SdkContextScope scope(LidarContext(handle));
   return CommandImpl::SetLivoxLidarFovCfg1(handle, *fov_cfg1, cb, client_data);
 }
 
 livox_status EnableLivoxLidarFov(uint32_t handle, uint8_t fov_en, LivoxLidarAsyncControlCallback cb, void* client_data) {
+  SdkContextScope scope(LidarContext(handle));
   return CommandImpl::EnableLivoxLidarFov(handle, fov_en, cb, client_data);
 }
 
 livox_status DisableLivoxLidarFov(uint32_t handle, LivoxLidarAsyncControlCallback cb, void* client_data) {
+  SdkContextScope scope(LidarContext(handle));
   return CommandImpl::DisableLivoxLidarFov(handle, cb, client_data);
 }
 
 livox_status SetLivoxLidarDetectMode(uint32_t handle, LivoxLidarDetectMode mode, LivoxLidarAsyncControlCallback cb, void* client_data) {
+  SdkContextScope scope(LidarContext(handle));
   return CommandImpl::SetLivoxLidarDetectMode(handle, mode, cb, client_data);
 }
 
 livox_status SetLivoxLidarFuncIOCfg(uint32_t handle, FuncIOCfg* func_io_cfg, LivoxLidarAsyncControlCallback cb, void* client_data) {
+  SdkContextScope scope(LidarContext(handle));
   return CommandImpl::SetLivoxLidarFuncIOCfg(handle, *func_io_cfg, cb, client_data);
 }
 
 livox_status SetLivoxLidarBlindSpot(uint32_t handle, uint32_t blind_spot, LivoxLidarAsyncControlCallback cb, void* client_data) {
+  SdkContextScope scope(LidarContext(handle));
   return CommandImpl::SetLivoxLidarBlindSpot(handle, blind_spot, cb, client_data);
 }
 
 livox_status SetLivoxLidarWorkMode(uint32_t handle, LivoxLidarWorkMode work_mode, LivoxLidarAsyncControlCallback cb, void* client_data) {
+  SdkContextScope scope(LidarContext(handle));
   return CommandImpl::SetLivoxLidarWorkMode(handle, work_mode, cb, client_data);
 }
 
 livox_status EnableLivoxLidarGlassHeat(uint32_t handle, LivoxLidarAsyncControlCallback cb, void* client_data) {
+  SdkContextScope scope(LidarContext(handle));
   return CommandImpl::EnableLivoxLidarGlassHeat(handle, cb, client_data);
 }
 livox_status DisableLivoxLidarGlassHeat(uint32_t handle, LivoxLidarAsyncControlCallback cb, void* client_data) {
+  SdkContextScope scope(LidarContext(handle));
   return CommandImpl::DisableLivoxLidarGlassHeat(handle, cb, client_data);
 }
 livox_status SetLivoxLidarGlassHeat(uint32_t handle, LivoxLidarGlassHeat glass_heat, LivoxLidarAsyncControlCallback cb, void* client_data) {
+  SdkContextScope scope(LidarContext(handle));
   return CommandImpl::SetLivoxLidarGlassHeat(handle, glass_heat, cb, client_data);
 }
 
 livox_status StartForcedHeating(uint32_t handle, LivoxLidarAsyncControlCallback cb, void* client_data) {
+  SdkContextScope scope(LidarContext(handle));
   return CommandImpl::StartForcedHeating(handle, cb, client_data);
 }
 
 livox_status StopForcedHeating(uint32_t handle, LivoxLidarAsyncControlCallback cb, void* client_data) {
+  SdkContextScope scope(LidarContext(handle));
   return CommandImpl::StopForcedHeating(handle, cb, client_data);
 }
 
 livox_status SetLivoxLidarPpsSyncMode(uint32_t handle, LivoxLidarPpsSyncMode pps_sync_mode, LivoxLidarAsyncControlCallback cb, void* client_data) {
+  SdkContextScope scope(LidarContext(handle));
   return CommandImpl::SetLivoxLidarPpsSyncMode(handle, pps_sync_mode, cb, client_data);
 }
 
 livox_status SetLidarFogNoiseFilterMode(uint32_t handle, LivoxFogNoiseFilterMode fog_filter_mode, LivoxLidarAsyncControlCallback cb, void* client_data) {
+  SdkContextScope scope(LidarContext(handle));
   return CommandImpl::SetLidarFogNoiseFilterMode(handle, fog_filter_mode, cb, client_data);
 }
 
 livox_status SetLivoxLidarITOCtrlMode(uint32_t handle, LivoxLidarItoCtrlMode ito_mode, LivoxLidarAsyncControlCallback cb, void* client_data) {
+  SdkContextScope scope(LidarContext(handle));
   return CommandImpl::SetLivoxLidarITOCtrlMode(handle, ito_mode, cb, client_data);
 }
 
 livox_status SetNTPServerIp(uint32_t handle, NTPServerIpInfo* server_ip, LivoxLidarAsyncControlCallback cb, void* client_data) {
+  SdkContextScope scope(LidarContext(handle));
   return CommandImpl::SetNTPServerIp(handle, server_ip, cb, client_data);
 }
 
 livox_status SetLivoxLidarEscMode(uint32_t handle, LivoxLidarEscMode esc_mode, LivoxLidarAsyncControlCallback cb, void* client_data) {
+  SdkContextScope scope(LidarContext(handle));
   return CommandImpl::SetLivoxLidarEscMode(handle, esc_mode, cb, client_data);
 }
 
 livox_status SetLivoxLidarFovMode(uint32_t handle, LivoxLidarFovMode fov_mode, LivoxLidarAsyncControlCallback cb, void* client_data) {
+  SdkContextScope scope(LidarContext(handle));
   return CommandImpl::SetLivoxLidarFovMode(handle, fov_mode, cb, client_data);
 }
 
 livox_status SetLivoxLidarEchoMode(uint32_t handle, LivoxLidarEchoMode echo_mode, LivoxLidarAsyncControlCallback cb, void* client_data) {
+  SdkContextScope scope(LidarContext(handle));
   return CommandImpl::SetLivoxLidarEchoMode(handle, echo_mode, cb, client_data);
 }
 
 livox_status SetLivoxLidarImuRange(uint32_t handle, LivoxLidarImuOutRate imu_out_rate,
     LivoxLidarAccelRange accel_range, LivoxLidarGyroRange gyro_range,
     LivoxLidarAsyncControlCallback cb, void* client_data) {
+  SdkContextScope scope(LidarContext(handle));
   return CommandImpl::SetLivoxLidarImuRange(handle, imu_out_rate, accel_range, gyro_range, cb, client_data);
 }
 
 livox_status EnableLivoxLidarImuData(uint32_t handle, LivoxLidarAsyncControlCallback cb, void* client_data) {
+  SdkContextScope scope(LidarContext(handle));
   return CommandImpl::EnableLivoxLidarImuData(handle, cb, client_data);
 }
 livox_status DisableLivoxLidarImuData(uint32_t handle, LivoxLidarAsyncControlCallback cb, void* client_data) {
+  SdkContextScope scope(LidarContext(handle));
   return CommandImpl::DisableLivoxLidarImuData(handle, cb, client_data);
 }
 
 livox_status EnableLivoxLidarFusaFunciont(uint32_t handle, LivoxLidarAsyncControlCallback cb, void* client_data) {
+  SdkContextScope scope(LidarContext(handle));
   return CommandImpl::EnableLivoxLidarFusaFunciont(handle, cb, client_data);
 }
 livox_status DisableLivoxLidarFusaFunciont(uint32_t handle, LivoxLidarAsyncControlCallback cb, void* client_data) {
+  SdkContextScope scope(LidarContext(handle));
   return CommandImpl::DisableLivoxLidarFusaFunciont(handle, cb, client_data);
 }
 
 livox_status SetLivoxLidarDebugPointCloud(uint32_t handle, bool enable, LivoxLidarLoggerCallback cb, void* client_data) {
+  SdkContextScope scope(LidarContext(handle));
   return CommandImpl::SetLivoxLidarDebugPointCloud(handle, enable, cb, client_data);
 }
 
 livox_status SetLivoxLidarRmcSyncTime(uint32_t handle, const char* rmc, uint16_t rmc_length, LivoxLidarRmcSyncTimeCallBack cb, void* client_data) {
+  SdkContextScope scope(LidarContext(handle));
   return CommandImpl::SetLivoxLidarRmcSyncTime(handle, rmc, rmc_length, cb, client_data);
 }
 
 livox_status SetLivoxLidarWorkModeAfterBoot(const uint32_t handle,const LivoxLidarWorkModeAfterBoot work_mode, LivoxLidarAsyncControlCallback cb, void* client_data){
+  SdkContextScope scope(LidarContext(handle));
   return CommandImpl::SetLivoxLidarWorkModeAfterBoot(handle, work_mode, cb, client_data);
 }
 
 // reset lidar
 livox_status LivoxLidarRequestReset(uint32_t handle, LivoxLidarResetCallback cb, void* client_data) {
+  SdkContextScope scope(LidarContext(handle));
   return CommandImpl::LivoxLidarRequestReset(handle, cb, client_data);
 }
 
 livox_status LivoxLidarRequestReboot(uint32_t handle, LivoxLidarRebootCallback cb, void* client_data) {
+  SdkContextScope scope(LidarContext(handle));
   return CommandImpl::LivoxLidarRequestReboot(handle, cb, client_data);
 }
 
 // upgrade
 bool SetLivoxLidarUpgradeFirmwarePath(const char* firmware_path) {
-  return UpgradeManager::GetInstance().SetLivoxLidarUpgradeFirmwarePath(firmware_path);
+  return LivoxLidarSdkContextSetUpgradeFirmwarePath(nullptr, firmware_path);
 }
 
 void SetLivoxLidarUpgradeProgressCallback(OnLivoxLidarUpgradeProgressCallback cb, void* client_data) {
-  UpgradeManager::GetInstance().SetLivoxLidarUpgradeProgressCallback(cb, client_data);
+  LivoxLidarSdkContextSetUpgradeProgressCallback(nullptr, cb, client_data);
 }
 
 void UpgradeLivoxLidars(const uint32_t* handle, const uint8_t lidar_num) {
+  SdkContext* context = handle != nullptr && lidar_num > 0 ? LidarContext(handle[0]) : &SdkContext::Default();
+  // The firmware path and progress callback belong to one context, so do the lidars of an upgrade.
+  for (uint8_t i = 1; handle != nullptr && i < lidar_num; ++i) {
+    if (LidarContext(handle[i]) != context) {
+      LOG_ERROR("Upgrade livox lidars failed, the lidars {} and {} belong to different contexts.", handle[0],
+                handle[i]);
+      return;
+    }
+  }
+  SdkContextScope scope(context);
   UpgradeManager::GetInstance().UpgradeLivoxLidars(handle, lidar_num);
 }
 
 livox_status LivoxLidarStartLogger(const uint32_t handle, const LivoxLidarLogType log_type, LivoxLidarLoggerCallback cb, void* client_data) {
+  SdkContextScope scope(LidarContext(handle));
   return LoggerManager::GetInstance().StartLogger(handle, log_type, cb, client_data);
 }
 
 livox_status LivoxLidarStopLogger(const uint32_t handle, const LivoxLidarLogType log_type, LivoxLidarLoggerCallback cb, void* client_data) {
+  SdkContextScope scope(LidarContext(handle));
   return LoggerManager::GetInstance().StopLogger(handle, log_type, cb, client_data);
 }
@@ -51,7 +51,8 @@ std::string GetCurFormatTime() {
 
 void LoggerHandler::Init() {
   is_stop_write_.store(false);
-  thread_ptr_ = std::make_shared<std::thread>(&LoggerHandler::SaveToFile, this);
+  thread_ptr_ = ThreadBase::CreateThread(std::bind(&LoggerHandler::SaveToFile, this));
+  ThreadBase::ApplySchedule(*thread_ptr_, DeviceManager::GetInstance().GetThreadSchedule(kThreadRoleLogger));
 }
 
 void LoggerHandler::Destory() {
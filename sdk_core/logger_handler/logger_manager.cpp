@@ -30,6 +30,8 @@
 #include "base/logging.h"
 #include "comm/protocol.h"
 #include "comm/generate_seq.h"
+#include "device_manager.h"
+#include "sdk_context.h"
 
 #include <map>
 #include <iomanip>
@@ -62,8 +64,7 @@ LoggerManager::LoggerManager()
 }
 
 LoggerManager& LoggerManager::GetInstance() {
-  static LoggerManager logger_manager;
-  return logger_manager;
+  return SdkContext::Current().GetLoggerManager();
 }
 
 bool LoggerManager::Init(std::shared_ptr<LivoxLidarLoggerCfg> lidar_logger_cfg_ptr) {
@@ -105,7 +106,8 @@ bool LoggerManager::Init(std::shared_ptr<LivoxLidarLoggerCfg> lidar_logger_cfg_p
   }
 
   log_cycle_delete_enable_.store(true);
-  cycle_delete_thread_ = std::make_shared<std::thread>(&LoggerManager::CycleDelete, this);
+  cycle_delete_thread_ = ThreadBase::CreateThread(std::bind(&LoggerManager::CycleDelete, this));
+  ThreadBase::ApplySchedule(*cycle_delete_thread_, DeviceManager::GetInstance().GetThreadSchedule(kThreadRoleLogCleanup));
 
   return true;
 }
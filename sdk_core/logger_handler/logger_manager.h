@@ -62,6 +62,7 @@ struct LogInfo {
 
 class LoggerManager {
  private:
+  friend class SdkContext;
   LoggerManager();
   LoggerManager(const LoggerManager& other) = delete;
   LoggerManager& operator=(const LoggerManager& other) = delete;
@@ -47,7 +47,8 @@ bool ParseCfgFile::Parse(std::shared_ptr<std::vector<LivoxLidarCfg>>& lidars_cfg
                          std::shared_ptr<LivoxLidarSdkFrameworkCfg>& sdk_framework_cfg_ptr) {
   FILE* raw_file = std::fopen(path_.c_str(), "rb");
   if (!raw_file) {
-    LOG_INFO("Parse lidar config failed, can not open json config file!");
+    LOG_ERROR("Parse lidar config failed, can not open json config file!");
+    return false;
   }
   char read_buffer[32768];
   rapidjson::FileReadStream config_file(raw_file, read_buffer, sizeof(read_buffer));  
@@ -85,6 +86,14 @@ bool ParseCfgFile::Parse(std::shared_ptr<std::vector<LivoxLidarCfg>>& lidars_cfg
     sdk_framework_cfg_ptr->master_sdk = true;
   }
 
+  if (!ParseIoCfg(doc, *sdk_framework_cfg_ptr) || !ParseThreadCfg(doc, *sdk_framework_cfg_ptr) ||
+      !ParseRtCfg(doc, *sdk_framework_cfg_ptr)) {
+    if (raw_file) {
+      std::fclose(raw_file);
+    }
+    return false;
+  }
+
   if (doc.HasMember("lidar_log_enable")) {
     if (doc["lidar_log_enable"].IsBool()) {
       lidar_logger_cfg_ptr->lidar_log_enable = doc["lidar_log_enable"].GetBool();
@@ -385,6 +394,329 @@ bool ParseCfgFile::ParseHostNetInfo(const rapidjson::Value &host_net_info_object
 }
 
 
+bool ParseCfgFile::ParseIoCfg(const rapidjson::Value &object, LivoxLidarSdkFrameworkCfg& sdk_framework_cfg) {
+  if (object.HasMember("data_recv_batch_size")) {
+    if (!object["data_recv_batch_size"].IsUint() || object["data_recv_batch_size"].GetUint() == 0) {
+      LOG_ERROR("Parse io cfg failed, data_recv_batch_size is not a positive uint.");
+      return false;
+    }
+    sdk_framework_cfg.data_recv_batch_size = object["data_recv_batch_size"].GetUint();
+  }
+  if (object.HasMember("data_io_thread_num")) {
+    if (!object["data_io_thread_num"].IsUint() || object["data_io_thread_num"].GetUint() == 0 ||
+        object["data_io_thread_num"].GetUint() > kMaxDataIOThreadNum) {
+      LOG_ERROR("Parse io cfg failed, data_io_thread_num should be in [1, {}].", kMaxDataIOThreadNum);
+      return false;
+    }
+    sdk_framework_cfg.data_io_thread_num = object["data_io_thread_num"].GetUint();
+  }
+  if (object.HasMember("data_io_backend")) {
+    if (!object["data_io_backend"].IsString()) {
+      LOG_ERROR("Parse io cfg failed, data_io_backend is not a string.");
+      return false;
+    }
+    std::string backend = object["data_io_backend"].GetString();
+    if (backend != "default" && backend != "io_uring") {
+      LOG_ERROR("Parse io cfg failed, unknown data_io_backend {}, expect default or io_uring.", backend.c_str());
+      return false;
+    }
+    sdk_framework_cfg.data_io_uring = (backend == "io_uring");
+  }
+  if (object.HasMember("data_ingest")) {
+    if (!object["data_ingest"].IsString()) {
+      LOG_ERROR("Parse io cfg failed, data_ingest is not a string.");
+      return false;
+    }
+    std::string ingest = object["data_ingest"].GetString();
+    if (ingest == "socket") {
+      sdk_framework_cfg.data_ingest = kDataIngestSocket;
+    } else if (ingest == "packet_mmap") {
+      sdk_framework_cfg.data_ingest = kDataIngestPacketMmap;
+    } else if (ingest == "af_xdp") {
+      sdk_framework_cfg.data_ingest = kDataIngestAfXdp;
+    } else {
+      LOG_ERROR("Parse io cfg failed, unknown data_ingest {}, expect socket, packet_mmap or af_xdp.", ingest.c_str());
+      return false;
+    }
+  }
+  if (object.HasMember("xdp_queue_id")) {
+    if (!object["xdp_queue_id"].IsUint()) {
+      LOG_ERROR("Parse io cfg failed, xdp_queue_id is not a uint.");
+      return false;
+    }
+    sdk_framework_cfg.xdp_queue_id = object["xdp_queue_id"].GetUint();
+  }
+  if (object.HasMember("data_busy_poll_spin_us")) {
+    if (!object["data_busy_poll_spin_us"].IsUint()) {
+      LOG_ERROR("Parse io cfg failed, data_busy_poll_spin_us is not a uint.");
+      return false;
+    }
+    sdk_framework_cfg.data_busy_poll_spin_us = object["data_busy_poll_spin_us"].GetUint();
+  }
+  if (object.HasMember("data_socket_busy_poll_us")) {
+    if (!object["data_socket_busy_poll_us"].IsUint()) {
+      LOG_ERROR("Parse io cfg failed, data_socket_busy_poll_us is not a uint.");
+      return false;
+    }
+    sdk_framework_cfg.data_socket_busy_poll_us = object["data_socket_busy_poll_us"].GetUint();
+  }
+  if (object.HasMember("data_prefer_busy_poll")) {
+    if (!object["data_prefer_busy_poll"].IsBool()) {
+      LOG_ERROR("Parse io cfg failed, data_prefer_busy_poll is not a bool.");
+      return false;
+    }
+    sdk_framework_cfg.data_prefer_busy_poll = object["data_prefer_busy_poll"].GetBool();
+  }
+  if (object.HasMember("data_latency_report")) {
+    if (!object["data_latency_report"].IsBool()) {
+      LOG_ERROR("Parse io cfg failed, data_latency_report is not a bool.");
+      return false;
+    }
+    sdk_framework_cfg.data_latency_report = object["data_latency_report"].GetBool();
+  }
+  if (object.HasMember("data_connected_sockets")) {
+    if (!object["data_connected_sockets"].IsBool()) {
+      LOG_ERROR("Parse io cfg failed, data_connected_sockets is not a bool.");
+      return false;
+    }
+    sdk_framework_cfg.data_connected_sockets = object["data_connected_sockets"].GetBool();
+  }
+  if (object.HasMember("data_udp_gro")) {
+    if (!object["data_udp_gro"].IsBool()) {
+      LOG_ERROR("Parse io cfg failed, data_udp_gro is not a bool.");
+      return false;
+    }
+    sdk_framework_cfg.data_udp_gro = object["data_udp_gro"].GetBool();
+  }
+  if (object.HasMember("data_rcvbuf_size")) {
+    if (!object["data_rcvbuf_size"].IsUint() || object["data_rcvbuf_size"].GetUint() == 0) {
+      LOG_ERROR("Parse io cfg failed, data_rcvbuf_size is not a positive uint.");
+      return false;
+    }
+    sdk_framework_cfg.data_rcvbuf_size = object["data_rcvbuf_size"].GetUint();
+  }
+  if (object.HasMember("data_rcvbuf_max_size")) {
+    if (!object["data_rcvbuf_max_size"].IsUint()) {
+      LOG_ERROR("Parse io cfg failed, data_rcvbuf_max_size is not a uint.");
+      return false;
+    }
+    sdk_framework_cfg.data_rcvbuf_max_size = object["data_rcvbuf_max_size"].GetUint();
+  }
+  if (object.HasMember("control_rcvbuf_size")) {
+    if (!object["control_rcvbuf_size"].IsUint() || object["control_rcvbuf_size"].GetUint() == 0) {
+      LOG_ERROR("Parse io cfg failed, control_rcvbuf_size is not a positive uint.");
+      return false;
+    }
+    sdk_framework_cfg.control_rcvbuf_size = object["control_rcvbuf_size"].GetUint();
+  }
+  if (object.HasMember("data_edge_triggered")) {
+    if (!object["data_edge_triggered"].IsBool()) {
+      LOG_ERROR("Parse io cfg failed, data_edge_triggered is not a bool.");
+      return false;
+    }
+    sdk_framework_cfg.data_edge_triggered = object["data_edge_triggered"].GetBool();
+  }
+  if (object.HasMember("data_drain_budget")) {
+    if (!object["data_drain_budget"].IsUint() || object["data_drain_budget"].GetUint() == 0) {
+      LOG_ERROR("Parse io cfg failed, data_drain_budget is not a positive uint.");
+      return false;
+    }
+    sdk_framework_cfg.data_drain_budget = object["data_drain_budget"].GetUint();
+  }
+  if (object.HasMember("imu_io_thread")) {
+    if (!object["imu_io_thread"].IsBool()) {
+      LOG_ERROR("Parse io cfg failed, imu_io_thread is not a bool.");
+      return false;
+    }
+    sdk_framework_cfg.imu_io_thread = object["imu_io_thread"].GetBool();
+  }
+  if (object.HasMember("imu_io_thread_priority")) {
+    if (!object["imu_io_thread_priority"].IsUint() || object["imu_io_thread_priority"].GetUint() > kMaxThreadRtPriority) {
+      LOG_ERROR("Parse io cfg failed, imu_io_thread_priority should be in [0, {}].", kMaxThreadRtPriority);
+      return false;
+    }
+    ThreadSchedule& schedule = sdk_framework_cfg.thread_schedules[kThreadRoleImu];
+    schedule.priority = object["imu_io_thread_priority"].GetUint();
+    schedule.policy = schedule.priority > 0 ? kSchedPolicyFifo : kSchedPolicyOther;
+  }
+  if (object.HasMember("imu_io_thread_cpu")) {
+    if (!object["imu_io_thread_cpu"].IsInt() || object["imu_io_thread_cpu"].GetInt() < -1 ||
+        object["imu_io_thread_cpu"].GetInt() >= ThreadBase::MaxCpuNum()) {
+      LOG_ERROR("Parse io cfg failed, imu_io_thread_cpu should be -1 or a cpu index below {}.",
+                ThreadBase::MaxCpuNum());
+      return false;
+    }
+    sdk_framework_cfg.thread_schedules[kThreadRoleImu].cpus.clear();
+    if (object["imu_io_thread_cpu"].GetInt() >= 0) {
+      sdk_framework_cfg.thread_schedules[kThreadRoleImu].cpus.push_back(object["imu_io_thread_cpu"].GetInt());
+    }
+  }
+  if (object.HasMember("data_io_per_nic")) {
+    if (!object["data_io_per_nic"].IsBool()) {
+      LOG_ERROR("Parse io cfg failed, data_io_per_nic is not a bool.");
+      return false;
+    }
+    sdk_framework_cfg.data_io_per_nic = object["data_io_per_nic"].GetBool();
+  }
+  if (object.HasMember("embedded_mode")) {
+    if (!object["embedded_mode"].IsBool()) {
+      LOG_ERROR("Parse io cfg failed, embedded_mode is not a bool.");
+      return false;
+    }
+    sdk_framework_cfg.embedded_mode = object["embedded_mode"].GetBool();
+  }
+  LOG_INFO("Io cfg, data_recv_batch_size:{}, data_io_thread_num:{}, data_io_uring:{}, data_ingest:{}, "
+      "data_busy_poll_spin_us:{}, data_socket_busy_poll_us:{}, data_prefer_busy_poll:{}, data_latency_report:{}, "
+      "data_connected_sockets:{}, data_udp_gro:{}, data_rcvbuf_size:{}, data_rcvbuf_max_size:{}, control_rcvbuf_size:{}, "
+      "data_edge_triggered:{}, data_drain_budget:{}, imu_io_thread:{}, data_io_per_nic:{}, "
+      "embedded_mode:{}",
+      sdk_framework_cfg.data_recv_batch_size, sdk_framework_cfg.data_io_thread_num, sdk_framework_cfg.data_io_uring,
+      static_cast<int>(sdk_framework_cfg.data_ingest), sdk_framework_cfg.data_busy_poll_spin_us,
+      sdk_framework_cfg.data_socket_busy_poll_us, sdk_framework_cfg.data_prefer_busy_poll,
+      sdk_framework_cfg.data_latency_report, sdk_framework_cfg.data_connected_sockets, sdk_framework_cfg.data_udp_gro,
+      sdk_framework_cfg.data_rcvbuf_size, sdk_framework_cfg.data_rcvbuf_max_size, sdk_framework_cfg.control_rcvbuf_size,
+      sdk_framework_cfg.data_edge_triggered, sdk_framework_cfg.data_drain_budget, sdk_framework_cfg.imu_io_thread,
+      sdk_framework_cfg.data_io_per_nic, sdk_framework_cfg.embedded_mode);
+  return true;
+}
+
+bool ParseCfgFile::ParseRtCfg(const rapidjson::Value &object, LivoxLidarSdkFrameworkCfg& sdk_framework_cfg) {
+  if (object.HasMember("rt_mode")) {
+    if (!object["rt_mode"].IsBool()) {
+      LOG_ERROR("Parse rt cfg failed, rt_mode is not a bool.");
+      return false;
+    }
+    sdk_framework_cfg.rt_mode = object["rt_mode"].GetBool();
+  }
+  if (object.HasMember("rt_mlockall")) {
+    if (!object["rt_mlockall"].IsBool()) {
+      LOG_ERROR("Parse rt cfg failed, rt_mlockall is not a bool.");
+      return false;
+    }
+    sdk_framework_cfg.rt_mlockall = object["rt_mlockall"].GetBool();
+  }
+  if (object.HasMember("rt_warmup_ms")) {
+    if (!object["rt_warmup_ms"].IsUint()) {
+      LOG_ERROR("Parse rt cfg failed, rt_warmup_ms is not a uint.");
+      return false;
+    }
+    sdk_framework_cfg.rt_warmup_ms = object["rt_warmup_ms"].GetUint();
+  }
+  if (object.HasMember("rt_alloc_tripwire")) {
+    if (!object["rt_alloc_tripwire"].IsString()) {
+      LOG_ERROR("Parse rt cfg failed, rt_alloc_tripwire is not a string.");
+      return false;
+    }
+    std::string tripwire = object["rt_alloc_tripwire"].GetString();
+    if (tripwire == "off") {
+      sdk_framework_cfg.rt_alloc_tripwire = kRtAllocTripwireOff;
+    } else if (tripwire == "count") {
+      sdk_framework_cfg.rt_alloc_tripwire = kRtAllocTripwireCount;
+    } else if (tripwire == "abort") {
+      sdk_framework_cfg.rt_alloc_tripwire = kRtAllocTripwireAbort;
+    } else {
+      LOG_ERROR("Parse rt cfg failed, unknown rt_alloc_tripwire {}, expect off, count or abort.", tripwire.c_str());
+      return false;
+    }
+  }
+  LOG_INFO("Rt cfg, rt_mode:{}, rt_mlockall:{}, rt_warmup_ms:{}, rt_alloc_tripwire:{}", sdk_framework_cfg.rt_mode,
+           sdk_framework_cfg.rt_mlockall, sdk_framework_cfg.rt_warmup_ms,
+           static_cast<int>(sdk_framework_cfg.rt_alloc_tripwire));
+  return true;
+}
+
+bool ParseCfgFile::ParseThreadCfg(const rapidjson::Value &object, LivoxLidarSdkFrameworkCfg& sdk_framework_cfg) {
+  static const char* const kRoleKeys[kThreadRoleNum] = {
+    "detection", "command", "data", "imu", "logger", "debug_point_cloud", "log_cleanup",
+    "delivery"
+  };
+  if (!object.HasMember("thread_config")) {
+    return true;
+  }
+  const rapidjson::Value &thread_cfg = object["thread_config"];
+  if (!thread_cfg.IsObject()) {
+    LOG_ERROR("Parse thread cfg failed, thread_config is not an object.");
+    return false;
+  }
+  for (auto it = thread_cfg.MemberBegin(); it != thread_cfg.MemberEnd(); ++it) {
+    std::string role = it->name.GetString();
+    int index = 0;
+    while (index < kThreadRoleNum && role != kRoleKeys[index]) {
+      ++index;
+    }
+    if (index == kThreadRoleNum) {
+      LOG_ERROR("Parse thread cfg failed, unknown thread role {}.", role.c_str());
+      return false;
+    }
+    if (!ParseThreadSchedule(it->value, kRoleKeys[index], sdk_framework_cfg.thread_schedules[index])) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool ParseCfgFile::ParseThreadSchedule(const rapidjson::Value &object, const char* role, ThreadSchedule& schedule) {
+  if (!object.IsObject()) {
+    LOG_ERROR("Parse thread cfg failed, {} is not an object.", role);
+    return false;
+  }
+  if (object.HasMember("name")) {
+    if (!object["name"].IsString()) {
+      LOG_ERROR("Parse thread cfg failed, name of {} is not a string.", role);
+      return false;
+    }
+    schedule.name = object["name"].GetString();
+  }
+  if (object.HasMember("cpus")) {
+    if (!object["cpus"].IsArray()) {
+      LOG_ERROR("Parse thread cfg failed, cpus of {} is not an array.", role);
+      return false;
+    }
+    schedule.cpus.clear();
+    for (rapidjson::SizeType i = 0; i < object["cpus"].Size(); ++i) {
+      if (!object["cpus"][i].IsUint() ||
+          object["cpus"][i].GetUint() >= static_cast<unsigned>(ThreadBase::MaxCpuNum())) {
+        LOG_ERROR("Parse thread cfg failed, cpus of {} holds a value which is not a cpu index below {}.", role,
+                  ThreadBase::MaxCpuNum());
+        return false;
+      }
+      schedule.cpus.push_back(static_cast<int>(object["cpus"][i].GetUint()));
+    }
+  }
+  if (object.HasMember("policy")) {
+    if (!object["policy"].IsString()) {
+      LOG_ERROR("Parse thread cfg failed, policy of {} is not a string.", role);
+      return false;
+    }
+    std::string policy = object["policy"].GetString();
+    if (policy == "other") {
+      schedule.policy = kSchedPolicyOther;
+    } else if (policy == "fifo") {
+      schedule.policy = kSchedPolicyFifo;
+    } else if (policy == "rr") {
+      schedule.policy = kSchedPolicyRr;
+    } else {
+      LOG_ERROR("Parse thread cfg failed, unknown policy {} of {}, expect other, fifo or rr.", policy.c_str(), role);
+      return false;
+    }
+  }
+  if (object.HasMember("priority")) {
+    if (!object["priority"].IsUint() || object["priority"].GetUint() > kMaxThreadRtPriority) {
+      LOG_ERROR("Parse thread cfg failed, priority of {} should be in [0, {}].", role, kMaxThreadRtPriority);
+      return false;
+    }
+    schedule.priority = object["priority"].GetUint();
+  }
+  if (schedule.policy != kSchedPolicyOther && schedule.priority == 0) {
+    LOG_ERROR("Parse thread cfg failed, the fifo and rr policies of {} need a priority in [1, {}].", role,
+              kMaxThreadRtPriority);
+    return false;
+  }
+  LOG_INFO("Thread cfg, role:{}, name:{}, cpus:{}, policy:{}, priority:{}", role, schedule.name.c_str(),
+           schedule.cpus.size(), static_cast<int>(schedule.policy), schedule.priority);
+  return true;
+}
+
 bool ParseCfgFile::ParseGeneralCfgInfo(const rapidjson::Value &object, GeneralCfgInfo& general_cfg_info) {
   return true;
 }
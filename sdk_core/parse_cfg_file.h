@@ -65,6 +65,10 @@ class ParseCfgFile {
   bool ParseLidarNetInfo(const rapidjson::Value &object, LivoxLidarNetInfo& lidar_net_info);
   bool ParseHostNetInfo(const rapidjson::Value &host_net_info_object, HostNetInfo& host_net_info);
   bool ParseGeneralCfgInfo(const rapidjson::Value &object, GeneralCfgInfo& general_cfg_info);
+  bool ParseIoCfg(const rapidjson::Value &object, LivoxLidarSdkFrameworkCfg& sdk_framework_cfg);
+  bool ParseThreadCfg(const rapidjson::Value &object, LivoxLidarSdkFrameworkCfg& sdk_framework_cfg);
+  bool ParseRtCfg(const rapidjson::Value &object, LivoxLidarSdkFrameworkCfg& sdk_framework_cfg);
+  bool ParseThreadSchedule(const rapidjson::Value &object, const char* role, ThreadSchedule& schedule);
  private:
   const std::string path_;
 };
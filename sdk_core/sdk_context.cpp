@@ -0,0 +1,79 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2022 Livox. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#include "sdk_context.h"
+
+#include "base/thread_base.h"
+#include "command_handler/general_command_handler.h"
+#include "data_handler/data_handler.h"
+#include "debug_point_cloud_handler/debug_point_cloud_manager.h"
+#include "device_manager.h"
+#include "logger_handler/logger_manager.h"
+#include "upgrade_manager.h"
+
+namespace livox {
+namespace lidar {
+
+SdkContext::SdkContext()
+    : device_manager_(new DeviceManager()),
+      general_command_handler_(new GeneralCommandHandler()),
+      data_handler_(new DataHandler()),
+      logger_manager_(new LoggerManager()),
+      debug_point_cloud_manager_(new DebugPointCloudManager()),
+      upgrade_manager_(new UpgradeManager()),
+      is_initialized_(false) {
+}
+
+SdkContext::~SdkContext() {
+  // The managers reach each other through GetInstance while they shut down, keep them on this context
+  // and release them in the order of LivoxLidarSdkUninit.
+  SdkContextScope scope(this);
+  logger_manager_.reset();
+  device_manager_.reset();
+  data_handler_.reset();
+  general_command_handler_.reset();
+  debug_point_cloud_manager_.reset();
+  upgrade_manager_.reset();
+}
+
+SdkContext& SdkContext::Current() {
+  SdkContext* context = static_cast<SdkContext*>(ThreadBase::GetThreadContext());
+  return context != nullptr ? *context : Default();
+}
+
+SdkContext& SdkContext::Default() {
+  static SdkContext context;
+  return context;
+}
+
+SdkContextScope::SdkContextScope(SdkContext* context)
+    : previous_(ThreadBase::SetThreadContext(context)) {
+}
+
+SdkContextScope::~SdkContextScope() {
+  ThreadBase::SetThreadContext(previous_);
+}
+
+} // namespace lidar
+}  // namespace livox
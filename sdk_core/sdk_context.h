@@ -0,0 +1,91 @@
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2022 Livox. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifndef LIVOX_SDK_CONTEXT_H_
+#define LIVOX_SDK_CONTEXT_H_
+
+#include <atomic>
+#include <memory>
+#include "base/noncopyable.h"
+
+namespace livox {
+namespace lidar {
+
+class DeviceManager;
+class GeneralCommandHandler;
+class DataHandler;
+class LoggerManager;
+class DebugPointCloudManager;
+class UpgradeManager;
+
+/**
+ * One independent instance of the sdk: its managers, and through them its threads and sockets.
+ * The GetInstance of every manager resolves to the context of the calling thread. Every api call
+ * enters the context it is given, or the one owning its lidar, with SdkContextScope for its
+ * duration. Sdk threads inherit the context of the thread that starts them, see ThreadBase.
+ */
+class SdkContext : public noncopyable {
+ public:
+  SdkContext();
+  ~SdkContext();
+
+  /** Context of the calling thread, the default context if none was entered. */
+  static SdkContext& Current();
+  /** Context behind the LivoxLidarSdkInit api, it lives until the process exits. */
+  static SdkContext& Default();
+
+  DeviceManager& GetDeviceManager() { return *device_manager_; }
+  GeneralCommandHandler& GetGeneralCommandHandler() { return *general_command_handler_; }
+  DataHandler& GetDataHandler() { return *data_handler_; }
+  LoggerManager& GetLoggerManager() { return *logger_manager_; }
+  DebugPointCloudManager& GetDebugPointCloudManager() { return *debug_point_cloud_manager_; }
+  UpgradeManager& GetUpgradeManager() { return *upgrade_manager_; }
+
+  bool IsInitialized() const { return is_initialized_; }
+  void SetInitialized(bool initialized) { is_initialized_ = initialized; }
+
+ private:
+  std::unique_ptr<DeviceManager> device_manager_;
+  std::unique_ptr<GeneralCommandHandler> general_command_handler_;
+  std::unique_ptr<DataHandler> data_handler_;
+  std::unique_ptr<LoggerManager> logger_manager_;
+  std::unique_ptr<DebugPointCloudManager> debug_point_cloud_manager_;
+  std::unique_ptr<UpgradeManager> upgrade_manager_;
+  std::atomic<bool> is_initialized_;  /**< read by the lidar commands outside of the init lock. */
+};
+
+/** Make context the context of the calling thread for the lifetime of the scope. */
+class SdkContextScope : public noncopyable {
+ public:
+  explicit SdkContextScope(SdkContext* context);
+  ~SdkContextScope();
+
+ private:
+  void* previous_;
+};
+
+} // namespace lidar
+}  // namespace livox
+
+#endif  // LIVOX_SDK_CONTEXT_H_
@@ -24,6 +24,7 @@
 
 #include "livox_lidar_upgrader.h"
 #include "../command_handler/command_impl.h"
+#include "base/thread_base.h"
 
 #include <string.h>
 
@@ -85,7 +86,8 @@ void LivoxLidarUpgrader::AddUpgradeProgressObserver(UpgradeProgressCallback obse
 }
 
 bool LivoxLidarUpgrader::StartUpgradeLivoxLidar() {
-  upgrade_thread_ = std::make_shared<std::thread>([this](){
+  // The upgrade sends its commands through the sdk context of the caller.
+  upgrade_thread_ = ThreadBase::CreateThread([this](){
       this->FsmEventHandler(kLivoxLidarEventRequestUpgrade, 10);
   });
   return true;
@@ -23,14 +23,14 @@
 //
 
 #include "upgrade_manager.h"
+#include "sdk_context.h"
 #include <thread>
 
 namespace livox {
 namespace lidar {
 
 UpgradeManager& UpgradeManager::GetInstance() {
-  static UpgradeManager manager;
-  return manager;
+  return SdkContext::Current().GetUpgradeManager();
 }
 
 UpgradeManager::UpgradeManager()
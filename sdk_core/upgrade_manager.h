@@ -43,6 +43,7 @@ public:
       std::function<void(uint32_t handle, LivoxLidarUpgradeState state, void *client_data)>;
 
  private:
+  friend class SdkContext;
   UpgradeManager();
   UpgradeManager(const UpgradeManager& other) = delete;
   UpgradeManager& operator=(const UpgradeManager& other) = delete;